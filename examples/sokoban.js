@@ -139,17 +139,40 @@ function drawTile(sheet, size, tx, ty, dx, dy) {
                    dy, 1, 1);
 }
 
-function drawTileByType(type, dx, dy) {
+// Collects the tiles of a level, to draw all of them with a single drawAtlas
+// call instead of a drawImage call per tile.
+class TileBatch {
+  constructor(sheet, size) {
+    this.sheet = sheet;
+    this.size = size;
+    this.xforms = [];
+    this.rects = [];
+  }
+
+  add(tx, ty, dx, dy) {
+    const size = this.size;
+    // Each tile is scaled down to 1x1, at (dx, dy).
+    this.xforms.push(1 / (size - 2), 0, dx, dy);
+    this.rects.push(tx * size + 1, ty * size + 1, size - 2, size - 2);
+  }
+
+  draw() {
+    canvas.drawAtlas(this.sheet, new Float32Array(this.xforms),
+                     new Float32Array(this.rects));
+  }
+}
+
+function addTileByType(batch, type, dx, dy) {
   if (type == '#') {
-    drawTile(tilesheet, 128, 3, 4, dx, dy);
+    batch.add(3, 4, dx, dy);
   }
 
   if (type == 'b' || type == 'B') {
-    drawTile(tilesheet, 128, 7, 1, dx, dy);
+    batch.add(7, 1, dx, dy);
   }
 
   if (type == 'o' || type == 'B') {
-    drawTile(tilesheet, 128, 9, 0, dx, dy);
+    batch.add(9, 0, dx, dy);
   }
 }
 
@@ -182,11 +205,13 @@ function draw() {
     }
   }
 
+  const tiles = new TileBatch(tilesheet, 128);
   for (let y = 0; y < levelHeight; y++) {
     for (let x = 0; x < levelWidth; x++) {
-      drawTileByType(level[y][x], offX + x, offY + y);
+      addTileByType(tiles, level[y][x], offX + x, offY + y);
     }
   }
+  tiles.draw();
 
   if (state == SOLVED) {
     drawTile(character, 192, 3, 1, offX + levelState.playerX,
@@ -1,5 +1,6 @@
 #include "args.h"
 
+#include <cstdlib>
 #include <iostream>
 
 #include "config.h"
@@ -36,6 +37,60 @@ void InitArgs(int argc, char* argv[]) {
       args->headless = true;
       continue;
     }
+    if (strncmp(argv[i], "--task-budget=", 14) == 0) {
+      args->task_budget = atof(argv[i] + 14);
+      if (args->task_budget < 0) {
+        ErrorQuit("Invalid value for --task-budget: %s\n", argv[i] + 14);
+      }
+      continue;
+    }
+    if (strncmp(argv[i], "--io-threads=", 13) == 0) {
+      args->io_threads = atoi(argv[i] + 13);
+      if (args->io_threads <= 0) {
+        ErrorQuit("Invalid value for --io-threads: %s\n", argv[i] + 13);
+      }
+      continue;
+    }
+    if (strncmp(argv[i], "--cpu-threads=", 14) == 0) {
+      args->cpu_threads = atoi(argv[i] + 14);
+      if (args->cpu_threads <= 0) {
+        ErrorQuit("Invalid value for --cpu-threads: %s\n", argv[i] + 14);
+      }
+      continue;
+    }
+    if (strncmp(argv[i], "--trace=", 8) == 0) {
+      args->trace = argv[i] + 8;
+      if (args->trace.empty()) {
+        ErrorQuit("Missing file name for --trace\n");
+      }
+      continue;
+    }
+    if (strncmp(argv[i], "--cpu-profile=", 14) == 0) {
+      args->cpu_profile = argv[i] + 14;
+      if (args->cpu_profile.empty()) {
+        ErrorQuit("Missing file name for --cpu-profile\n");
+      }
+      continue;
+    }
+    if (strncmp(argv[i], "--code-cache=", 13) == 0) {
+      args->code_cache = argv[i] + 13;
+      if (args->code_cache.empty()) {
+        ErrorQuit("Missing directory for --code-cache\n");
+      }
+      continue;
+    }
+    if (strcmp(argv[i], "--no-code-cache") == 0) {
+      args->disable_code_cache = true;
+      continue;
+    }
+    if (strcmp(argv[i], "--no-snapshot") == 0) {
+      args->disable_snapshot = true;
+      continue;
+    }
+    if (strcmp(argv[i], "--no-lazy-api") == 0) {
+      args->disable_lazy_api = true;
+      continue;
+    }
     if (strcmp(argv[i], "--version") == 0) {
       args->version = true;
       continue;
@@ -15,6 +15,27 @@ struct CommandLineArgs {
   bool enable_crash_keys = false;
   bool version = false;
   bool headless = false;
+  // Time budget for lower priority tasks in each frame, in milliseconds.
+  double task_budget = 8;
+  // Number of threads for background I/O and CPU tasks. 0 picks a default
+  // based on the number of CPUs.
+  int io_threads = 0;
+  int cpu_threads = 0;
+  // If not empty, tasks and frames are traced from startup and written to
+  // this file at exit.
+  std::string trace;
+  // If not empty, the Javascript of the main window is profiled from startup
+  // and the CPU profile is written to this file at exit.
+  std::string cpu_profile;
+  // Directory for the code cache of Javascript modules. If empty, a directory
+  // in the system's temporary directory is used.
+  std::string code_cache;
+  bool disable_code_cache = false;
+  // Creates JS contexts from scratch instead of from the startup snapshot.
+  bool disable_snapshot = false;
+  // Installs all the Javascript APIs and constant strings at startup, instead
+  // of on first use.
+  bool disable_lazy_api = false;
   std::vector<std::string> args;
 };
 
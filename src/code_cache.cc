@@ -0,0 +1,193 @@
+#include "code_cache.h"
+
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <uv.h>
+
+#include "console.h"
+#include "file.h"
+
+namespace {
+
+constexpr char kMagic[4] = {'W', 'J', 'S', 'C'};
+
+// Entries beyond this budget are only kept on disk.
+constexpr size_t kMaxMemoryBytes = 32 * 1024 * 1024;
+
+struct EntryHeader {
+  char magic[4];
+  uint32_t version_tag;
+  uint64_t source_hash;
+};
+
+// Numbers the temporary files of the entries, since several threads of the
+// I/O queue may be writing the same entry at once.
+std::atomic<uint64_t> next_tmp_id{0};
+
+// 64-bit FNV-1a.
+uint64_t Hash(std::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// The CachedData deletes its buffer, so it gets a copy of the entry.
+std::unique_ptr<v8::ScriptCompiler::CachedData> MakeCachedData(
+    std::string_view data) {
+  int length = static_cast<int>(data.size());
+  uint8_t* copy = new uint8_t[length];
+  std::memcpy(copy, data.data(), length);
+  return std::make_unique<v8::ScriptCompiler::CachedData>(
+      copy, length, v8::ScriptCompiler::CachedData::BufferOwned);
+}
+
+}  // namespace
+
+CodeCache::CodeCache(std::filesystem::path dir, ThreadPoolTaskQueue* io_queue)
+    : dir_(std::move(dir)),
+      io_queue_(io_queue),
+      version_tag_(v8::ScriptCompiler::CachedDataVersionTag()),
+      memory_bytes_(0) {}
+
+CodeCache::~CodeCache() {}
+
+// static
+std::filesystem::path CodeCache::GetDefaultDir() {
+  std::string error;
+  std::string tmp = GetTmpDir(&error);
+  if (tmp.empty()) {
+    $(WARN) << "Code cache disabled, failed to get the temp dir: " << error;
+    return {};
+  }
+  return std::filesystem::path(tmp) / "windowjs-code-cache";
+}
+
+// static
+uint64_t CodeCache::HashSource(std::string_view source) {
+  return Hash(source);
+}
+
+std::unique_ptr<v8::ScriptCompiler::CachedData> CodeCache::Load(
+    const std::string& path, uint64_t source_hash) {
+  auto it = memory_.find(path);
+  if (it != memory_.end()) {
+    if (it->second.source_hash == source_hash) {
+      lru_.splice(lru_.begin(), lru_, it->second.lru);
+      return MakeCachedData(it->second.data);
+    }
+    // The module changed since this entry was stored.
+    Forget(it);
+  }
+
+  std::string content;
+  std::string error;
+  if (!ReadFile(GetEntryPath(path), &content, &error) ||
+      content.size() <= sizeof(EntryHeader)) {
+    counters_.misses++;
+    return {};
+  }
+
+  EntryHeader header;
+  std::memcpy(&header, content.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version_tag != version_tag_ ||
+      header.source_hash != source_hash) {
+    counters_.misses++;
+    return {};
+  }
+
+  content.erase(0, sizeof(header));
+  std::unique_ptr<v8::ScriptCompiler::CachedData> cached =
+      MakeCachedData(content);
+  Remember(path, source_hash, std::move(content));
+  return cached;
+}
+
+void CodeCache::OnConsumed(bool rejected) {
+  if (rejected) {
+    counters_.rejected++;
+  } else {
+    counters_.hits++;
+  }
+}
+
+void CodeCache::Store(const std::string& path, uint64_t source_hash,
+                      v8::Local<v8::UnboundModuleScript> script) {
+  std::unique_ptr<v8::ScriptCompiler::CachedData> data(
+      v8::ScriptCompiler::CreateCodeCache(script));
+  if (!data || data->length <= 0) {
+    return;
+  }
+
+  EntryHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version_tag = version_tag_;
+  header.source_hash = source_hash;
+
+  std::string content;
+  content.reserve(sizeof(header) + data->length);
+  content.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  content.append(reinterpret_cast<const char*>(data->data), data->length);
+
+  Remember(path, source_hash,
+           std::string(reinterpret_cast<const char*>(data->data),
+                       data->length));
+
+  std::filesystem::path entry = GetEntryPath(path);
+
+  io_queue_->Post([dir = dir_, entry = std::move(entry),
+                   content = std::move(content)] {
+    std::string error;
+    if (!IsDir(dir, &error)) {
+      // Another process may create it first; that's detected when writing.
+      MkDirs(dir, &error);
+    }
+    // Other processes and threads may be writing the same entry; write to a
+    // file of our own and then rename it, so that readers never see partial
+    // entries.
+    std::filesystem::path tmp = entry;
+    tmp += "." + std::to_string(uv_os_getpid()) + "." +
+           std::to_string(next_tmp_id.fetch_add(1)) + ".tmp";
+    if (!WriteFile(tmp, content, &error) || !Rename(tmp, entry, &error)) {
+      $(DEV) << "Failed to write the code cache entry " << entry.string()
+             << ": " << error;
+      Remove(tmp, &error);
+    }
+  });
+}
+
+std::filesystem::path CodeCache::GetEntryPath(const std::string& path) const {
+  std::stringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << Hash(path) << ".bin";
+  return dir_ / ss.str();
+}
+
+void CodeCache::Remember(const std::string& path, uint64_t source_hash,
+                         std::string data) {
+  auto it = memory_.find(path);
+  if (it != memory_.end()) {
+    Forget(it);
+  }
+  if (data.size() > kMaxMemoryBytes) {
+    return;
+  }
+  while (memory_bytes_ + data.size() > kMaxMemoryBytes) {
+    Forget(memory_.find(lru_.back()));
+  }
+  lru_.push_front(path);
+  memory_bytes_ += data.size();
+  memory_.emplace(path,
+                  MemoryEntry{source_hash, std::move(data), lru_.begin()});
+}
+
+void CodeCache::Forget(MemoryMap::iterator it) {
+  memory_bytes_ -= it->second.data.size();
+  lru_.erase(it->second.lru);
+  memory_.erase(it);
+}
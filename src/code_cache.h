@@ -0,0 +1,101 @@
+#ifndef WINDOWJS_CODE_CACHE_H
+#define WINDOWJS_CODE_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <v8/include/v8.h>
+
+#include "task_queue.h"
+
+// On-disk cache of the code that v8 compiles for ES modules.
+//
+// Each module has a single entry in "dir", named after a hash of its path.
+// Entries also record a hash of the module source and the v8 version tag,
+// and are only returned if both match; otherwise they are replaced when the
+// new code is stored.
+//
+// The most recently used entries are also kept in memory once loaded or
+// stored, so that reloads don't read them again.
+//
+// This is shared by all the Js instances, so that reloads reuse the cache
+// too. It must only be used while holding the isolate lock of a Js instance.
+class CodeCache final {
+ public:
+  struct Counters {
+    // Number of modules compiled from cached code.
+    uint64_t hits = 0;
+
+    // Number of modules without a valid cache entry.
+    uint64_t misses = 0;
+
+    // Number of cache entries that v8 rejected, e.g. due to different flags.
+    uint64_t rejected = 0;
+  };
+
+  // Entries are written in the background, in "io_queue".
+  CodeCache(std::filesystem::path dir, ThreadPoolTaskQueue* io_queue);
+  ~CodeCache();
+
+  CodeCache(const CodeCache&) = delete;
+  CodeCache& operator=(const CodeCache&) = delete;
+
+  // Returns the default cache directory, in the system's temporary directory.
+  static std::filesystem::path GetDefaultDir();
+
+  static uint64_t HashSource(std::string_view source);
+
+  // Returns the cached code for the module at "path", or null if there isn't
+  // a valid entry for "source_hash". Counts a miss when null is returned.
+  std::unique_ptr<v8::ScriptCompiler::CachedData> Load(
+      const std::string& path, uint64_t source_hash);
+
+  // Counts a hit or a rejection for cached code returned by Load().
+  void OnConsumed(bool rejected);
+
+  // Writes the code of "script" for the module at "path" in the background.
+  void Store(const std::string& path, uint64_t source_hash,
+             v8::Local<v8::UnboundModuleScript> script);
+
+  const Counters& counters() const { return counters_; }
+
+ private:
+  struct MemoryEntry {
+    uint64_t source_hash;
+    std::string data;
+    // Position in lru_.
+    std::list<std::string>::iterator lru;
+  };
+
+  using MemoryMap = std::unordered_map<std::string, MemoryEntry>;
+
+  std::filesystem::path GetEntryPath(const std::string& path) const;
+
+  // Keeps "data" in memory_ as the most recently used entry for "path",
+  // evicting the least recently used entries to stay within the budget.
+  void Remember(const std::string& path, uint64_t source_hash,
+                std::string data);
+  void Forget(MemoryMap::iterator it);
+
+  std::filesystem::path dir_;
+  ThreadPoolTaskQueue* io_queue_;
+  uint32_t version_tag_;
+  Counters counters_;
+
+  // The code of a module is usually a few times larger than its source, and
+  // lives as long as the CodeCache, across reloads. Its size is bounded by
+  // kMaxMemoryBytes in code_cache.cc; entries whose source changed are dropped
+  // as soon as they are looked up.
+  MemoryMap memory_;
+  // The keys of memory_, from the most to the least recently used.
+  std::list<std::string> lru_;
+  // Sum of the data sizes in memory_.
+  size_t memory_bytes_;
+};
+
+#endif  // WINDOWJS_CODE_CACHE_H
@@ -356,8 +356,11 @@ function requestEval(source) {
         'F3         Toggles frame profiling.\n' +
         'F4         Overlays console logs in the main window.\n' +
         'F5         Reloads the main application.\n' +
+        'Shift+F5   Reloads the main application in a new isolate.\n' +
         'F6         Toggles always on top.\n' +
+        'F7         Toggles CPU profiling.\n' +
         'F8         Saves a screenshot.\n' +
+        'F9         Saves a heap snapshot.\n' +
         'Escape     Closes the console.\n');
     return;
   }
@@ -392,11 +395,15 @@ function onKeyDown(event) {
   } else if (key == 'F4') {
     sendRequest('overlay-console');
   } else if (key == 'F5') {
-    sendRequest('reload');
+    sendRequest(event.shiftKey ? 'full-reload' : 'reload');
   } else if (key == 'F6') {
     sendRequest('always-on-top');
+  } else if (key == 'F7') {
+    sendRequest('cpu-profile');
   } else if (key == 'F8') {
     sendRequest('screenshot');
+  } else if (key == 'F9') {
+    sendRequest('heap-snapshot');
   } else if (key == 'PageUp') {
     updateScrollLines(10);
   } else if (key == 'PageDown') {
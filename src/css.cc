@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdlib>
+#include <cstring>
 #include <regex>
 #include <sstream>
 #include <string>
@@ -28,6 +29,16 @@ bool ValidHex(const std::string& color) {
   return true;
 }
 
+// Maximum number of entries of each cache of CSSCache.
+constexpr size_t kMaxCSSCacheSize = 256;
+
+template <typename Map>
+void ClearIfFull(Map* map) {
+  if (map->size() >= kMaxCSSCacheSize) {
+    map->clear();
+  }
+}
+
 int FromHex(char c) {
   if (isdigit(c)) {
     return c - '0';
@@ -447,3 +458,77 @@ std::string SkFontToCSSFont(const SkFont& font) {
 
   return css.str();
 }
+
+void CSSCache::Font::ApplyTo(SkFont* font) const {
+  if (valid) {
+    if (typeface) {
+      font->setTypeface(typeface);
+    }
+    font->setSize(size);
+  }
+}
+
+CSSCache::CSSCache() {}
+
+CSSCache::~CSSCache() {}
+
+CSSCache::Color CSSCache::GetColor(const std::string& color) {
+  auto it = colors_.find(color);
+  if (it != colors_.end()) {
+    return it->second;
+  }
+  Color result;
+  result.valid = CSSColorToSkColor(color, &result.color);
+  ClearIfFull(&colors_);
+  colors_.emplace(color, result);
+  return result;
+}
+
+CSSCache::Font CSSCache::GetFont(
+    const std::string& font,
+    const std::unordered_map<std::string, sk_sp<SkTypeface>>& fonts,
+    std::unordered_map<std::string, sk_sp<SkTypeface>>* cache) {
+  auto it = fonts_.find(font);
+  if (it != fonts_.end()) {
+    return it->second;
+  }
+  // A default SkFont has no typeface, so that a family that isn't found
+  // doesn't replace the current typeface in ApplyTo().
+  SkFont parsed;
+  Font result;
+  result.valid = CSSFontToSkFont(font, &parsed, fonts, cache);
+  result.typeface = parsed.refTypeface();
+  result.size = parsed.getSize();
+  ClearIfFull(&fonts_);
+  fonts_.emplace(font, result);
+  return result;
+}
+
+const std::string& CSSCache::GetColorString(SkColor color) {
+  auto it = color_strings_.find(color);
+  if (it != color_strings_.end()) {
+    return it->second;
+  }
+  ClearIfFull(&color_strings_);
+  return color_strings_.emplace(color, SkColorToCSSColor(color)).first->second;
+}
+
+const std::string& CSSCache::GetFontString(const SkFont& font) {
+  float size = font.getSize();
+  uint32_t size_bits;
+  std::memcpy(&size_bits, &size, sizeof(size_bits));
+  uint64_t key =
+      static_cast<uint64_t>(font.getTypefaceOrDefault()->uniqueID()) << 32 |
+      size_bits;
+  auto it = font_strings_.find(key);
+  if (it != font_strings_.end()) {
+    return it->second;
+  }
+  ClearIfFull(&font_strings_);
+  return font_strings_.emplace(key, SkFontToCSSFont(font)).first->second;
+}
+
+void CSSCache::ClearFonts() {
+  fonts_.clear();
+  font_strings_.clear();
+}
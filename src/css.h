@@ -1,6 +1,7 @@
 #ifndef WINDOWJS_CSS_H
 #define WINDOWJS_CSS_H
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 
@@ -19,4 +20,57 @@ bool CSSFontToSkFont(
 
 std::string SkFontToCSSFont(const SkFont& font);
 
+// Bounded caches of the results of the functions above. Canvas styles are
+// usually set from a few distinct strings, many times per frame; this parses
+// each of them once, and builds the string of each color and font once.
+//
+// Each cache is cleared when it gets too large, instead of tracking the use
+// of its entries.
+class CSSCache final {
+ public:
+  struct Color {
+    // False if the string isn't a valid CSS color.
+    bool valid = false;
+    SkColor color = SK_ColorBLACK;
+  };
+
+  struct Font {
+    // False if the string isn't a valid CSS font.
+    bool valid = false;
+    // Null if the font family wasn't found.
+    sk_sp<SkTypeface> typeface;
+    float size = 0;
+
+    // Same as CSSFontToSkFont() on "font", if valid.
+    void ApplyTo(SkFont* font) const;
+  };
+
+  CSSCache();
+  ~CSSCache();
+
+  CSSCache(const CSSCache&) = delete;
+  CSSCache& operator=(const CSSCache&) = delete;
+
+  Color GetColor(const std::string& color);
+
+  Font GetFont(const std::string& font,
+               const std::unordered_map<std::string, sk_sp<SkTypeface>>& fonts,
+               std::unordered_map<std::string, sk_sp<SkTypeface>>* cache);
+
+  // The references are valid until the next call.
+  const std::string& GetColorString(SkColor color);
+  const std::string& GetFontString(const SkFont& font);
+
+  // Drops the cached fonts, e.g. when a font is loaded and font names can
+  // match a different typeface.
+  void ClearFonts();
+
+ private:
+  std::unordered_map<std::string, Color> colors_;
+  std::unordered_map<std::string, Font> fonts_;
+  std::unordered_map<SkColor, std::string> color_strings_;
+  // Keyed by the ID of the typeface and the bits of the size.
+  std::unordered_map<uint64_t, std::string> font_strings_;
+};
+
 #endif  // WINDOWJS_CSS_H
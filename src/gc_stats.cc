@@ -0,0 +1,67 @@
+#include "gc_stats.h"
+
+#include <algorithm>
+
+#include "js.h"
+
+namespace {
+
+GcStats::Type GetType(v8::GCType type) {
+  return type == v8::kGCTypeScavenge ? GcStats::Type::MINOR
+                                     : GcStats::Type::MAJOR;
+}
+
+}  // namespace
+
+GcStats::GcStats(v8::Isolate* isolate)
+    : isolate_(isolate), depth_(0), pause_start_(0), frame_pause_{} {
+  isolate_->AddGCPrologueCallback(OnPrologue, this);
+  isolate_->AddGCEpilogueCallback(OnEpilogue, this);
+}
+
+GcStats::~GcStats() {
+  isolate_->RemoveGCPrologueCallback(OnPrologue, this);
+  isolate_->RemoveGCEpilogueCallback(OnEpilogue, this);
+}
+
+GcStats::Counters GcStats::counters(Type type) const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return counters_[static_cast<int>(type)];
+}
+
+void GcStats::OnFrameFinished() {
+  std::lock_guard<std::mutex> lock(lock_);
+  for (int i = 0; i < static_cast<int>(Type::LAST_TYPE); i++) {
+    counters_[i].last_frame_pause = frame_pause_[i];
+    frame_pause_[i] = 0;
+  }
+}
+
+// static
+void GcStats::OnPrologue(v8::Isolate* isolate, v8::GCType type,
+                         v8::GCCallbackFlags flags, void* data) {
+  GcStats* thiz = static_cast<GcStats*>(data);
+  if (thiz->depth_++ == 0) {
+    thiz->pause_start_ = Js::MonotonicallyIncreasingTime();
+  }
+}
+
+// static
+void GcStats::OnEpilogue(v8::Isolate* isolate, v8::GCType type,
+                         v8::GCCallbackFlags flags, void* data) {
+  GcStats* thiz = static_cast<GcStats*>(data);
+  if (thiz->depth_ == 0 || --thiz->depth_ > 0) {
+    // The epilogue of a GC that started before the callbacks were added, or
+    // of a nested GC.
+    return;
+  }
+  double pause = Js::MonotonicallyIncreasingTime() - thiz->pause_start_;
+  int index = static_cast<int>(GetType(type));
+
+  std::lock_guard<std::mutex> lock(thiz->lock_);
+  Counters& counters = thiz->counters_[index];
+  counters.count++;
+  counters.total_pause += pause;
+  counters.max_pause = std::max(counters.max_pause, pause);
+  thiz->frame_pause_[index] += pause;
+}
@@ -0,0 +1,68 @@
+#ifndef WINDOWJS_GC_STATS_H
+#define WINDOWJS_GC_STATS_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+#include <v8/include/v8.h>
+
+// Records the pauses of the garbage collector of an isolate, by type of GC.
+//
+// The GC callbacks run in the thread that collects, which is either a thread
+// running Javascript or the GC thread of Main. counters() and
+// OnFrameFinished() can be called from any thread.
+class GcStats final {
+ public:
+  enum class Type {
+    // Scavenges of the young generation.
+    MINOR,
+    // Full mark-compacts, and the incremental marking and weak callback
+    // processing steps of the old generation.
+    MAJOR,
+    LAST_TYPE,
+  };
+
+  struct Counters {
+    // Number of GC pauses.
+    uint64_t count = 0;
+
+    // Durations of the pauses, in seconds.
+    double total_pause = 0;
+    double max_pause = 0;
+
+    // Sum of the pauses between the two last calls to OnFrameFinished().
+    double last_frame_pause = 0;
+  };
+
+  // Adds GC callbacks to "isolate", which must outlive this.
+  explicit GcStats(v8::Isolate* isolate);
+  ~GcStats();
+
+  GcStats(const GcStats&) = delete;
+  GcStats& operator=(const GcStats&) = delete;
+
+  Counters counters(Type type) const;
+
+  // Starts counting the pauses of a new frame.
+  void OnFrameFinished();
+
+ private:
+  static void OnPrologue(v8::Isolate* isolate, v8::GCType type,
+                         v8::GCCallbackFlags flags, void* data);
+  static void OnEpilogue(v8::Isolate* isolate, v8::GCType type,
+                         v8::GCCallbackFlags flags, void* data);
+
+  v8::Isolate* isolate_;
+
+  // Only used in the thread that collects. Nested callbacks, e.g. for weak
+  // callbacks processed during a mark-compact, are part of the outer pause.
+  int depth_;
+  double pause_start_;
+
+  mutable std::mutex lock_;
+  std::array<Counters, static_cast<int>(Type::LAST_TYPE)> counters_;
+  std::array<double, static_cast<int>(Type::LAST_TYPE)> frame_pause_;
+};
+
+#endif  // WINDOWJS_GC_STATS_H
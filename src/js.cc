@@ -3,7 +3,6 @@
 #include <sstream>
 
 #include <GLFW/glfw3.h>
-#include <v8/include/libplatform/libplatform.h>
 
 #if defined(__clang__)
 #pragma clang diagnostic push
@@ -18,8 +17,11 @@
 
 #include "args.h"
 #include "file.h"
+#include "js_platform.h"
 #include "js_scope.h"
 #include "json.h"
+#include "signal.h"
+#include "thread.h"
 #include "util.h"
 #include "zip.h"
 
@@ -28,7 +30,10 @@ extern const std::string_view kEmbeddedDefaultSource;
 
 namespace {
 
-v8::Platform* platform = nullptr;
+JsPlatform* platform = nullptr;
+
+v8::StartupData startup_snapshot{nullptr, 0};
+const intptr_t* api_external_references = nullptr;
 
 void AppendModulePath(std::stringstream* ss,
                       const std::filesystem::path& base_path,
@@ -79,7 +84,7 @@ void Js::Init(const char* program) {
   // at shutdown.
   v8::V8::SetFlagsFromString("--expose_gc");
 #endif
-  platform = v8::platform::NewDefaultPlatform().release();
+  platform = new JsPlatform();
   ASSERT(v8::V8::InitializeICUDefaultLocation(program));
   v8::V8::InitializeExternalStartupData(program);
   v8::V8::InitializePlatform(platform);
@@ -93,28 +98,82 @@ void Js::Shutdown() {
   delete platform;
 }
 
+// static
+void Js::SetWorkerPool(ThreadPoolTaskQueue* pool) {
+  platform->SetWorkerPool(pool);
+}
+
 // static
 double Js::MonotonicallyIncreasingTime() {
   return platform->MonotonicallyIncreasingTime();
 }
 
+// static
+void Js::SetStartupSnapshot(std::string_view snapshot,
+                            const intptr_t* external_references) {
+  startup_snapshot.data = snapshot.data();
+  startup_snapshot.raw_size = static_cast<int>(snapshot.size());
+  api_external_references = external_references;
+}
+
 Js::Js(Delegate* delegate, std::filesystem::path base_path,
-       TaskQueue* task_queue)
-    : delegate_(delegate),
+       TaskQueue* task_queue, ThreadPoolTaskQueue* io_queue,
+       CodeCache* code_cache)
+    : weak_factory_(this),
+      delegate_(delegate),
       base_path_(std::move(base_path)),
       task_queue_(task_queue),
+      io_queue_(io_queue),
+      code_cache_(code_cache),
+      from_snapshot_(false),
       suppress_next_script_result_(false) {
-  if (Args().profile_startup) {
+  // Only the startup of the main thread is profiled.
+  bool profile_startup = Args().profile_startup && IsMainThread();
+  if (profile_startup) {
     $(DEV) << "[profile-startup] create JS context start: " << glfwGetTime();
   }
 
-  allocator_ = v8::ArrayBuffer::Allocator::NewDefaultAllocator();
-  console_delegate_ = MakeConsoleDelegate(this);
+  allocator_.reset(v8::ArrayBuffer::Allocator::NewDefaultAllocator());
 
   v8::Isolate::CreateParams params;
-  params.array_buffer_allocator = allocator_;
+  params.array_buffer_allocator_shared = allocator_;
+  params.external_references = api_external_references;
+  // The snapshot has the window APIs, which Workers don't get.
+  if (startup_snapshot.raw_size > 0 && !Args().disable_snapshot &&
+      IsMainThread()) {
+    params.snapshot_blob = &startup_snapshot;
+    from_snapshot_ = true;
+  }
 
   isolate_ = v8::Isolate::New(params);
+  InitIsolate();
+
+  if (profile_startup) {
+    $(DEV) << "[profile-startup] create JS context end: " << glfwGetTime()
+           << (from_snapshot_ ? " (from snapshot)" : "");
+  }
+}
+
+Js::Js(const intptr_t* external_references)
+    : weak_factory_(this),
+      delegate_(nullptr),
+      task_queue_(nullptr),
+      io_queue_(nullptr),
+      code_cache_(nullptr),
+      from_snapshot_(false),
+      suppress_next_script_result_(false) {
+  isolate_ = v8::Isolate::Allocate();
+  snapshot_creator_ =
+      std::make_unique<v8::SnapshotCreator>(isolate_, external_references);
+  for (const intptr_t* ref = external_references; *ref; ref++) {
+    external_references_.insert(*ref);
+  }
+  InitIsolate();
+}
+
+void Js::InitIsolate() {
+  console_delegate_ = MakeConsoleDelegate(this);
+
   // The number of data slots is a fixed constant in v8. Make sure
   // we have enough for our usage:
   // 0 is Js*.
@@ -126,31 +185,39 @@ Js::Js(Delegate* delegate, std::filesystem::path base_path,
   isolate_->SetPromiseRejectCallback(HandlePromiseRejectCallback);
 
   v8::debug::SetConsoleDelegate(isolate_, console_delegate_.get());
+  gc_stats_ = std::make_unique<GcStats>(isolate_);
+  profiler_ = std::make_unique<Profiler>(isolate_);
 
   v8::Locker locker(isolate_);
   v8::Isolate::Scope isolate_scope(isolate_);
   v8::HandleScope handle_scope(isolate_);
+  // If the isolate was created from the startup snapshot then this
+  // deserializes its default context.
   context_.Reset(isolate_, v8::Context::New(isolate_));
 
-  strings_ = std::make_unique<JsStrings>(isolate_);
-
-  if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] create JS context end: " << glfwGetTime();
-  }
+  strings_ = std::make_unique<JsStrings>(isolate_, from_snapshot_);
 }
 
 Js::~Js() {
   isolate_->SetData(0, nullptr);
   strings_.reset();
   dynamic_imports_.clear();
+  prefetched_sources_.clear();
   modules_.clear();
+  pending_code_cache_.clear();
   context_.Reset();
+  gc_stats_.reset();
+  profiler_.reset();
+  if (snapshot_creator_) {
+    // The isolate can't run anymore after CreateSnapshot().
+    snapshot_creator_.reset();
+  } else {
 #if !defined(WINDOWJS_RELEASE_BUILD)
-  isolate_->RequestGarbageCollectionForTesting(
-      v8::Isolate::kFullGarbageCollection);
+    isolate_->RequestGarbageCollectionForTesting(
+        v8::Isolate::kFullGarbageCollection);
 #endif
+  }
   isolate_->Dispose();
-  delete allocator_;
 }
 
 v8::Local<v8::String> Js::MakeString(std::string_view s) {
@@ -225,6 +292,12 @@ void Js::ThrowInvalidArgument() {
 }
 
 void Js::ReportException(v8::Local<v8::Message> message) {
+  if (message.IsEmpty()) {
+    // Terminated executions, e.g. of a Worker that is closing, don't have a
+    // message.
+    return;
+  }
+
   std::string str = ToString(message->Get());
 
   std::vector<std::string> trace;
@@ -245,6 +318,27 @@ void Js::ReportException(v8::Local<v8::Message> message) {
   delegate_->OnJavascriptException(std::move(str), std::move(trace));
 }
 
+void Js::CheckExternalReference(intptr_t address) const {
+  if (snapshot_creator_ && !external_references_.count(address)) {
+    Fail("Callback %p is missing from JsApi::GetExternalReferences()\n",
+         reinterpret_cast<void*>(address));
+  }
+}
+
+v8::StartupData Js::CreateSnapshot() {
+  ASSERT(snapshot_creator_);
+  {
+    v8::HandleScope handle_scope(isolate_);
+    strings_->AddToSnapshot(snapshot_creator_.get(), isolate_);
+    snapshot_creator_->SetDefaultContext(context());
+  }
+  // v8 requires that all the global handles are reset, or are part of the
+  // snapshot.
+  context_.Reset();
+  return snapshot_creator_->CreateBlob(
+      v8::SnapshotCreator::FunctionCodeHandling::kClear);
+}
+
 void Js::SuppressNextScriptResult() {
   suppress_next_script_result_ = true;
 }
@@ -294,6 +388,28 @@ std::unique_ptr<std::string> Js::ExecuteScript(std::string_view source) {
   return std::make_unique<std::string>(ToString(result.ToLocalChecked()));
 }
 
+void Js::ResetContext() {
+  // Pending tasks of the old context, like dynamic imports, are dropped.
+  weak_factory_.InvalidateWeakPtrs();
+
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope isolate_scope(isolate_);
+  v8::HandleScope handle_scope(isolate_);
+
+  dynamic_imports_.clear();
+  prefetched_sources_.clear();
+  modules_.clear();
+  module_path_by_id_.clear();
+  failed_promises_.clear();
+  pending_code_cache_.clear();
+  suppress_next_script_result_ = false;
+
+  // If the isolate was created from the startup snapshot then this
+  // deserializes its default context again.
+  context_.Reset(isolate_, v8::Context::New(isolate_));
+  isolate_->ContextDisposedNotification();
+}
+
 void Js::LoadMainModule(std::string_view name) {
   v8::Locker locker(isolate_);
   JsScope scope(this);
@@ -302,7 +418,9 @@ void Js::LoadMainModule(std::string_view name) {
   std::filesystem::path path =
       name.substr(0, 2) == "--" ? name : (base_path_ / name).lexically_normal();
 
+  PrefetchModuleGraph(path);
   LoadModuleByPath(std::move(path), {});
+  prefetched_sources_.clear();
 
   if (try_catch.HasCaught()) {
     ReportException(try_catch.Message());
@@ -310,6 +428,40 @@ void Js::LoadMainModule(std::string_view name) {
   }
 }
 
+std::unordered_set<std::string> Js::GetLoadedModulePaths() const {
+  std::unordered_set<std::string> paths;
+  for (const auto& it : modules_) {
+    paths.insert(it.first);
+  }
+  return paths;
+}
+
+void Js::PrefetchModuleGraph(const std::filesystem::path& path) {
+  // Embedded modules don't import files.
+  if (!io_queue_ || StartsWith(path.string(), "--")) {
+    return;
+  }
+
+  // The state is shared with the io_queue_, which may still be notifying
+  // "done" after Wait() returns.
+  struct State {
+    Signal done;
+    ModulePrefetcher::Sources sources;
+  };
+  auto state = std::make_shared<State>();
+
+  ModulePrefetcher::Prefetch(path, GetLoadedModulePaths(), io_queue_,
+                             [state](ModulePrefetcher::Sources sources) {
+                               state->sources = std::move(sources);
+                               state->done.SetAndNotify();
+                             });
+
+  // The reads run in parallel in the background; waiting for all of them is
+  // still faster than reading each module here when it's reached.
+  state->done.Wait();
+  prefetched_sources_ = std::move(state->sources);
+}
+
 // LoadModuleByPath is used in two flows:
 // 1. Loading the main module
 // 2. Loading a dynamically imported module.
@@ -343,7 +495,9 @@ bool Js::LoadModuleByPath(std::filesystem::path path,
   }
 
   v8::Local<v8::Value> result;
-  if (!module->Evaluate(context).ToLocal(&result)) {
+  bool evaluated = module->Evaluate(context).ToLocal(&result);
+  StoreCodeCache();
+  if (!evaluated) {
     return false;
   }
 
@@ -394,8 +548,8 @@ v8::Local<v8::Module> Js::LoadModuleTree(
     return it->second.Get(isolate_);
   }
 
-  v8::Local<v8::String> source = LoadModuleSource(path, *paths);
-  if (source.IsEmpty()) {
+  std::string source;
+  if (!LoadModuleSource(path, *paths, &source)) {
     return {};
   }
 
@@ -460,9 +614,9 @@ v8::MaybeLocal<v8::Module> Js::ResolveModule(
   return it2->second.Get(js->isolate_);
 }
 
-v8::Local<v8::String> Js::LoadModuleSource(
-    const std::filesystem::path& path,
-    const std::vector<std::filesystem::path>& paths) {
+bool Js::LoadModuleSource(const std::filesystem::path& path,
+                          const std::vector<std::filesystem::path>& paths,
+                          std::string* source) {
   std::string content;
   if (path == "--console") {
     content = GzipUncompress(kEmbeddedConsoleSource);
@@ -470,7 +624,11 @@ v8::Local<v8::String> Js::LoadModuleSource(
     content = GzipUncompress(kEmbeddedDefaultSource);
   } else if (path.string().substr(0, 2) == "--") {
     ThrowError("Invalid module name: " + path.string());
-    return {};
+    return false;
+  } else if (auto it = prefetched_sources_.find(path.string());
+             it != prefetched_sources_.end()) {
+    content = std::move(it->second);
+    prefetched_sources_.erase(it);
   } else {
     std::string error;
     if (!ReadFile(path, &content, &error)) {
@@ -478,17 +636,18 @@ v8::Local<v8::String> Js::LoadModuleSource(
       ss << error << "\n";
       AppendModulePath(&ss, base_path_, paths);
       ThrowError(ss.str());
-      return {};
+      return false;
     }
   }
 
-  return MakeString("const __filename = " + Json::EscapeString(path.string()) +
-                    ";const __dirname = " +
-                    Json::EscapeString(Dirname(path).string()) + ";" + content);
+  *source = "const __filename = " + Json::EscapeString(path.string()) +
+            ";const __dirname = " + Json::EscapeString(Dirname(path).string()) +
+            ";" + content;
+  return true;
 }
 
 v8::Local<v8::Module> Js::CompileModule(
-    v8::Local<v8::String> source, const std::filesystem::path& path,
+    const std::string& source, const std::filesystem::path& path,
     const std::vector<std::filesystem::path>& paths) {
   // This is the ResourceName used in ImportDynamic below.
   auto resource_name = MakeString(path.string());
@@ -505,12 +664,36 @@ v8::Local<v8::Module> Js::CompileModule(
                           is_shared_cross_origin, script_id, source_map_url,
                           is_opaque, is_warm, is_module, host_defined_options);
 
-  v8::ScriptCompiler::Source src(source, origin);
+  uint64_t source_hash = 0;
+  std::unique_ptr<v8::ScriptCompiler::CachedData> cached_data;
+  if (code_cache_) {
+    source_hash = CodeCache::HashSource(source);
+    cached_data = code_cache_->Load(path.string(), source_hash);
+  }
+
+  auto options = cached_data ? v8::ScriptCompiler::kConsumeCodeCache
+                             : v8::ScriptCompiler::kNoCompileOptions;
+  // "src" takes ownership of the cached data.
+  v8::ScriptCompiler::Source src(MakeString(source), origin,
+                                 cached_data.release());
 
   v8::TryCatch try_catch(isolate_);
   v8::Local<v8::Module> module;
 
-  if (v8::ScriptCompiler::CompileModule(isolate_, &src).ToLocal(&module)) {
+  if (v8::ScriptCompiler::CompileModule(isolate_, &src, options)
+          .ToLocal(&module)) {
+    bool store = code_cache_ != nullptr;
+    if (options == v8::ScriptCompiler::kConsumeCodeCache) {
+      bool rejected = src.GetCachedData()->rejected;
+      code_cache_->OnConsumed(rejected);
+      store = rejected;
+    }
+    if (store) {
+      pending_code_cache_.push_back(
+          {path.string(), source_hash,
+           v8::Global<v8::UnboundModuleScript>(
+               isolate_, module->GetUnboundModuleScript())});
+    }
     return module;
   }
 
@@ -524,6 +707,14 @@ v8::Local<v8::Module> Js::CompileModule(
   return {};
 }
 
+void Js::StoreCodeCache() {
+  for (const PendingCodeCache& pending : pending_code_cache_) {
+    code_cache_->Store(pending.path, pending.source_hash,
+                       pending.script.Get(isolate_));
+  }
+  pending_code_cache_.clear();
+}
+
 // static
 void Js::OnMainModuleResolve(const v8::FunctionCallbackInfo<v8::Value>& info) {
   Js::Get(info.GetIsolate())->delegate_->OnMainModuleLoaded();
@@ -609,9 +800,34 @@ v8::MaybeLocal<v8::Promise> Js::ImportDynamic(
 
   dynamic_imports_[path_str].Reset(isolate_, resolver);
 
-  task_queue_->Post([=]() {
-    ImportDynamic(path_str);
-  });
+  if (!io_queue_ || modules_.find(path_str) != modules_.end()) {
+    task_queue_->Post([=]() {
+      ImportDynamic(path_str);
+    });
+    return resolver->GetPromise();
+  }
+
+  // Read the new module graph in the background, and then load it from memory
+  // in the main thread.
+  WeakPtr<Js> weak_this = weak_factory_.MakeWeakPtr();
+  TaskQueue* task_queue = task_queue_;
+  ModulePrefetcher::Prefetch(
+      path, GetLoadedModulePaths(), io_queue_,
+      [weak_this, task_queue, path_str](ModulePrefetcher::Sources sources) {
+        // The task_queue outlives the io_queue, which joins its threads
+        // before being deleted.
+        task_queue->Post([weak_this, path_str,
+                          sources = std::move(sources)]() mutable {
+          Js* thiz = weak_this.Get();
+          if (!thiz) {
+            // This Js was deleted while reading the modules.
+            return;
+          }
+          thiz->prefetched_sources_ = std::move(sources);
+          thiz->ImportDynamic(path_str);
+          thiz->prefetched_sources_.clear();
+        });
+      });
 
   return resolver->GetPromise();
 }
@@ -1,20 +1,27 @@
 #ifndef WINDOWJS_JS_H
 #define WINDOWJS_JS_H
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include <v8/include/v8.h>
 
+#include "code_cache.h"
 #include "console.h"
 #include "fail.h"
+#include "gc_stats.h"
 #include "js_strings.h"
+#include "module_prefetcher.h"
+#include "profiler.h"
 #include "task_queue.h"
+#include "weak.h"
 
 // Wrapper around a v8 Isolate and Context.
 //
@@ -33,6 +40,17 @@ class Js final {
   static void Shutdown();
   static double MonotonicallyIncreasingTime();
 
+  // The worker tasks of v8 run in "pool" until this is called again with
+  // nullptr. See JsPlatform.
+  static void SetWorkerPool(ThreadPoolTaskQueue* pool);
+
+  // New isolates are created from "snapshot" if it's not empty, unless
+  // --no-snapshot was passed. Isolates of Worker threads never are, since the
+  // snapshot has the window APIs. "external_references" must list the C++
+  // callbacks that the snapshot references. Both must outlive all Js objects.
+  static void SetStartupSnapshot(std::string_view snapshot,
+                                 const intptr_t* external_references);
+
   class Delegate {
    public:
     virtual ~Delegate() = default;
@@ -45,9 +63,17 @@ class Js final {
 
   // All of these dependencies must outlive the Js object.
   // If the object is deleted, then TaskQueue must *not* run any pending tasks
-  // anymore.
+  // anymore. Modules are read in "io_queue" before they're compiled; it may be
+  // null, to read them in the main thread instead. "code_cache" may be null, to
+  // always compile modules from source.
   Js(Delegate* delegate, std::filesystem::path base_path,
-     TaskQueue* task_queue);
+     TaskQueue* task_queue, ThreadPoolTaskQueue* io_queue,
+     CodeCache* code_cache);
+
+  // Creates a Js that builds a startup snapshot from its context, with
+  // CreateSnapshot(). It can't load modules.
+  explicit Js(const intptr_t* external_references);
+
   ~Js();
 
   static Js* Get(v8::Isolate* isolate) {
@@ -60,6 +86,12 @@ class Js final {
   v8::Local<v8::Context> context() { return context_.Get(isolate_); }
   v8::Local<v8::Object> global() { return context()->Global(); }
   JsStrings* strings() { return strings_.get(); }
+  // Whether the context was deserialized from the startup snapshot, and
+  // already has the Javascript APIs.
+  bool from_snapshot() const { return from_snapshot_; }
+  CodeCache* code_cache() { return code_cache_; }
+  GcStats* gc_stats() { return gc_stats_.get(); }
+  Profiler* profiler() { return profiler_.get(); }
 
   v8::Local<v8::String> MakeString(std::string_view s);
   v8::Local<v8::String> GetConstantString(StringId id) const {
@@ -82,10 +114,34 @@ class Js final {
 
   void LoadMainModule(std::string_view name);
 
+  // Replaces the context with a new one in the same isolate, and forgets all
+  // the modules and tasks of the old context. Code compiled for the old
+  // context isn't reused directly, but the CodeCache keeps it in memory.
+  // The JsApi of the old context must be deleted before this.
+  void ResetContext();
+
   std::unique_ptr<std::string> ExecuteScript(std::string_view source);
   void SuppressNextScriptResult();
 
+  // Serializes the isolate and its context. This Js can't be used afterwards.
+  v8::StartupData CreateSnapshot();
+
+  // Fails if this Js creates a snapshot and "address" isn't one of its
+  // external references: the snapshot would have a callback that can't be
+  // restored. Does nothing otherwise.
+  void CheckExternalReference(intptr_t address) const;
+
  private:
+  // Sets up the isolate_ and creates the context.
+  void InitIsolate();
+
+  // Returns the paths of the modules that have been loaded already.
+  std::unordered_set<std::string> GetLoadedModulePaths() const;
+
+  // Reads the static module graph starting at "path" in the io_queue_ and
+  // blocks until it's in prefetched_sources_. Dynamic imports aren't followed.
+  void PrefetchModuleGraph(const std::filesystem::path& path);
+
   bool LoadModuleByPath(std::filesystem::path path,
                         v8::Local<v8::Promise::Resolver> resolver);
 
@@ -98,14 +154,19 @@ class Js final {
       v8::Local<v8::FixedArray> import_assertions,
       v8::Local<v8::Module> referrer);
 
-  v8::Local<v8::String> LoadModuleSource(
-      const std::filesystem::path& path,
-      const std::vector<std::filesystem::path>& paths);
+  bool LoadModuleSource(const std::filesystem::path& path,
+                        const std::vector<std::filesystem::path>& paths,
+                        std::string* source);
 
   v8::Local<v8::Module> CompileModule(
-      v8::Local<v8::String> source, const std::filesystem::path& path,
+      const std::string& source, const std::filesystem::path& path,
       const std::vector<std::filesystem::path>& paths);
 
+  // Stores the code of the modules that were compiled without a valid cache
+  // entry. This is called after they've been evaluated, so that the functions
+  // that ran on startup are included too.
+  void StoreCodeCache();
+
   static void OnMainModuleResolve(
       const v8::FunctionCallbackInfo<v8::Value>& info);
   static void OnMainModuleFailure(
@@ -131,22 +192,45 @@ class Js final {
   static void HandlePromiseRejectCallback(v8::PromiseRejectMessage message);
   void RemovePendingFailedPromise(v8::Local<v8::Promise> promise);
 
+  WeakPtrFactory<Js> weak_factory_;
+
   Delegate* delegate_;
   std::filesystem::path base_path_;
   TaskQueue* task_queue_;
+  ThreadPoolTaskQueue* io_queue_;
+  CodeCache* code_cache_;
 
-  v8::ArrayBuffer::Allocator* allocator_;
+  // Shared with the backing stores of ArrayBuffers, which may be transferred
+  // to the isolate of a Worker and outlive this one.
+  std::shared_ptr<v8::ArrayBuffer::Allocator> allocator_;
   std::unique_ptr<v8::debug::ConsoleDelegate> console_delegate_;
 
   v8::Isolate* isolate_;
+  std::unique_ptr<GcStats> gc_stats_;
+  std::unique_ptr<Profiler> profiler_;
+  std::unique_ptr<v8::SnapshotCreator> snapshot_creator_;
+  // The external references of the snapshot_creator_.
+  std::unordered_set<intptr_t> external_references_;
+  bool from_snapshot_;
   v8::Global<v8::Context> context_;
   std::unordered_map<std::string, v8::Global<v8::Module>> modules_;
   std::unordered_map<int, std::string> module_path_by_id_;
   std::unordered_map<std::string, v8::Global<v8::Promise::Resolver>>
       dynamic_imports_;
+  // Sources read by the ModulePrefetcher for the module graph that is being
+  // loaded. LoadModuleSource() takes them instead of reading the files again.
+  ModulePrefetcher::Sources prefetched_sources_;
   std::vector<std::pair<v8::Global<v8::Promise>, v8::Global<v8::Message>>>
       failed_promises_;
 
+  struct PendingCodeCache {
+    std::string path;
+    uint64_t source_hash;
+    // The module script must be retrieved before evaluating the module.
+    v8::Global<v8::UnboundModuleScript> script;
+  };
+  std::vector<PendingCodeCache> pending_code_cache_;
+
   std::unique_ptr<JsStrings> strings_;
 
   bool suppress_next_script_result_;
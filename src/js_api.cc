@@ -1,20 +1,30 @@
 #include "js_api.h"
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+
 #include <stdlib.h>
 
 #include <skia/include/core/SkFont.h>
 #include <skia/include/core/SkFontMgr.h>
 #include <skia/include/core/SkTypeface.h>
+#include <uv.h>
 
 #include "args.h"
 #include "console.h"
 #include "css.h"
 #include "file.h"
+#include "js_api_abort.h"
 #include "js_api_canvas.h"
 #include "js_api_codec.h"
 #include "js_api_file.h"
 #include "js_api_process.h"
+#include "js_api_worker.h"
 #include "platform.h"
+#include "profiler.h"
+#include "trace.h"
 #include "version.h"
 
 #if defined(WINDOWJS_WIN)
@@ -51,6 +61,96 @@ void UsedJsHeapSize(v8::Local<v8::Name> property,
   info.GetReturnValue().Set((double) stats.used_heap_size());
 }
 
+void ResidentSetSize(v8::Local<v8::Name> property,
+                     const v8::PropertyCallbackInfo<v8::Value>& info) {
+  // Of the whole process, including its Workers.
+  size_t rss = 0;
+  uv_resident_set_memory(&rss);
+  info.GetReturnValue().Set((double) rss);
+}
+
+template <GcStats::Type type>
+void GcCount(v8::Local<v8::Name> property,
+             const v8::PropertyCallbackInfo<v8::Value>& info) {
+  GcStats* gc_stats = Js::Get(info.GetIsolate())->gc_stats();
+  info.GetReturnValue().Set((double) gc_stats->counters(type).count);
+}
+
+// In milliseconds, like performance.now().
+template <GcStats::Type type, double GcStats::Counters::*pause>
+void GcPause(v8::Local<v8::Name> property,
+             const v8::PropertyCallbackInfo<v8::Value>& info) {
+  GcStats* gc_stats = Js::Get(info.GetIsolate())->gc_stats();
+  info.GetReturnValue().Set(gc_stats->counters(type).*pause * 1000);
+}
+
+template <GcStats::Type type>
+v8::Local<v8::Object> MakeGcCounters(const JsScope& scope) {
+  v8::Local<v8::Object> counters = v8::Object::New(scope.isolate);
+  scope.Set(counters, StringId::count, GcCount<type>);
+  scope.Set(counters, StringId::totalPause,
+            GcPause<type, &GcStats::Counters::total_pause>);
+  scope.Set(counters, StringId::maxPause,
+            GcPause<type, &GcStats::Counters::max_pause>);
+  scope.Set(counters, StringId::lastFramePause,
+            GcPause<type, &GcStats::Counters::last_frame_pause>);
+  return counters;
+}
+
+void AddGcExternalReferences(std::vector<intptr_t>* refs) {
+  using Counters = GcStats::Counters;
+  constexpr GcStats::Type kMinor = GcStats::Type::MINOR;
+  constexpr GcStats::Type kMajor = GcStats::Type::MAJOR;
+  AppendExternalReferences(
+      refs, {GcCount<kMinor>, GcPause<kMinor, &Counters::total_pause>,
+             GcPause<kMinor, &Counters::max_pause>,
+             GcPause<kMinor, &Counters::last_frame_pause>, GcCount<kMajor>,
+             GcPause<kMajor, &Counters::total_pause>,
+             GcPause<kMajor, &Counters::max_pause>,
+             GcPause<kMajor, &Counters::last_frame_pause>});
+}
+
+void TasksExecuted(v8::Local<v8::Name> property,
+                   const v8::PropertyCallbackInfo<v8::Value>& info) {
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  info.GetReturnValue().Set((double) api->task_queue()->counters().tasks_run);
+}
+
+void TasksDeferred(v8::Local<v8::Name> property,
+                   const v8::PropertyCallbackInfo<v8::Value>& info) {
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  info.GetReturnValue().Set(
+      (double) api->task_queue()->counters().tasks_deferred);
+}
+
+void FramesOverBudget(v8::Local<v8::Name> property,
+                      const v8::PropertyCallbackInfo<v8::Value>& info) {
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  info.GetReturnValue().Set(
+      (double) api->task_queue()->counters().frames_over_budget);
+}
+
+void CodeCacheHits(v8::Local<v8::Name> property,
+                   const v8::PropertyCallbackInfo<v8::Value>& info) {
+  CodeCache* code_cache = JsApi::Get(info.GetIsolate())->js()->code_cache();
+  info.GetReturnValue().Set(
+      code_cache ? (double) code_cache->counters().hits : 0.0);
+}
+
+void CodeCacheMisses(v8::Local<v8::Name> property,
+                     const v8::PropertyCallbackInfo<v8::Value>& info) {
+  CodeCache* code_cache = JsApi::Get(info.GetIsolate())->js()->code_cache();
+  info.GetReturnValue().Set(
+      code_cache ? (double) code_cache->counters().misses : 0.0);
+}
+
+void CodeCacheRejected(v8::Local<v8::Name> property,
+                       const v8::PropertyCallbackInfo<v8::Value>& info) {
+  CodeCache* code_cache = JsApi::Get(info.GetIsolate())->js()->code_cache();
+  info.GetReturnValue().Set(
+      code_cache ? (double) code_cache->counters().rejected : 0.0);
+}
+
 void Close(const v8::FunctionCallbackInfo<v8::Value>& args) {
   JsApi* api = JsApi::Get(args.GetIsolate());
   // window.close() doesn't trigger the 'close' event, and can be used
@@ -451,8 +551,8 @@ void GetOverlayConsoleTextColor(
     const v8::PropertyCallbackInfo<v8::Value>& info) {
   ASSERT(IsMainThread());
   JsApi* api = JsApi::Get(info.GetIsolate());
-  std::string color =
-      SkColorToCSSColor(api->window()->console_overlay()->text_color());
+  const std::string& color = api->css_cache()->GetColorString(
+      api->window()->console_overlay()->text_color());
   info.GetReturnValue().Set(api->js()->MakeString(color));
 }
 
@@ -462,10 +562,9 @@ void SetOverlayConsoleTextColor(v8::Local<v8::Name> property,
   ASSERT(IsMainThread());
   if (value->IsString()) {
     JsApi* api = JsApi::Get(info.GetIsolate());
-    std::string s = api->js()->ToString(value);
-    SkColor color;
-    if (CSSColorToSkColor(s, &color)) {
-      api->window()->console_overlay()->SetTextColor(color);
+    CSSCache::Color color = api->ParseCSSColor(value.As<v8::String>());
+    if (color.valid) {
+      api->window()->console_overlay()->SetTextColor(color.color);
     }
   }
 }
@@ -505,6 +604,81 @@ void SetProfileFrameTimes(v8::Local<v8::Name> property,
   }
 }
 
+void StartTracing(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  ASSERT(IsMainThread());
+  Trace::Start();
+}
+
+void StopTracing(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  ASSERT(IsMainThread());
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  // The events are copied now, and converted to JSON in the background.
+  auto snapshot = std::make_shared<Trace::Snapshot>(Trace::Stop());
+  args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::CPU,
+      [snapshot] { return JsApi::Resolve(Trace::ToJson(*snapshot)); }));
+}
+
+void StartProfiling(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  ASSERT(IsMainThread());
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  if (!api->js()->profiler()->StartCpuProfile()) {
+    api->js()->ThrowError("A CPU profile is already being recorded.");
+  }
+}
+
+void StopProfiling(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  ASSERT(IsMainThread());
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  if (args.Length() < 1 || !args[0]->IsString()) {
+    api->js()->ThrowError("String argument is required.");
+    return;
+  }
+  Profiler* profiler = api->js()->profiler();
+  if (!profiler->is_profiling()) {
+    api->js()->ThrowError("No CPU profile is being recorded.");
+    return;
+  }
+  std::string path = api->js()->ToString(args[0]);
+  // The profile is copied now, and converted to JSON and written in the
+  // background.
+  auto profile =
+      std::make_shared<Profiler::CpuProfile>(profiler->StopCpuProfile());
+  args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::IO,
+      [path = std::move(path), profile]() -> JsApi::ResolveFunction {
+        std::string error;
+        if (!WriteFile(path, Profiler::ToJson(*profile), &error)) {
+          return JsApi::Reject(std::move(error));
+        }
+        return JsApi::Resolve();
+      }));
+}
+
+void WriteHeapSnapshot(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  ASSERT(IsMainThread());
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  if (args.Length() < 1 || !args[0]->IsString()) {
+    api->js()->ThrowError("String argument is required.");
+    return;
+  }
+  std::string path = api->js()->ToString(args[0]);
+  // v8 serializes the snapshot now, and its chunks are written to the file in
+  // the background as they're produced. The Promise is settled once the last
+  // one is written.
+  Profiler::FinishWriting finish =
+      api->js()->profiler()->WriteHeapSnapshot(path, api->io_queue());
+  args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::IO,
+      [finish = std::move(finish)]() -> JsApi::ResolveFunction {
+        std::string error;
+        if (!finish(&error)) {
+          return JsApi::Reject(std::move(error));
+        }
+        return JsApi::Resolve();
+      }));
+}
+
 void Open(const v8::FunctionCallbackInfo<v8::Value>& args) {
   if (args.Length() >= 1 && args[0]->IsString()) {
     JsApi* api = JsApi::Get(args.GetIsolate());
@@ -576,52 +750,80 @@ void GetLazyCanvas(v8::Local<v8::Name> property,
   info.GetReturnValue().Set(canvas);
 }
 
-}  // namespace
-
-JsApi::JsApi(Window* win, Js* js, JsEvents* events, TaskQueue* task_queue,
-             ThreadPoolTaskQueue* background_queue)
-    : weak_factory_(this),
-      window_(win),
-      js_(js),
-      events_(events),
-      task_queue_(task_queue),
-      background_queue_(background_queue),
-      next_timeout_id_(0),
-      animation_frame_base_id_(0),
-      animation_frame_next_id_(0),
-      cursor_shape_(0),
-      cursor_image_(nullptr),
-      cursor_x_(0),
-      cursor_y_(0),
-      cursor_(nullptr),
-      parent_process_(nullptr) {
-  if (Args().profile_startup) {
-    $(DEV) << "[profile-startup] create JS APIs start: " << glfwGetTime();
-  }
-
-  v8::Locker locker(js->isolate());
-  JsScope scope(js);
-
-  js->isolate()->SetData(1, this);
-
-  v8::Local<v8::Object> global = js->global();
-
-  scope.Set(global, StringId::setTimeout, SetTimeout);
-  scope.Set(global, StringId::clearTimeout, ClearTimeout);
-  scope.Set(global, StringId::requestAnimationFrame, RequestAnimationFrame);
-  scope.Set(global, StringId::cancelAnimationFrame, CancelAnimationFrame);
-  scope.Set(global, StringId::devicePixelRatio, DevicePixelRatio);
-
+v8::Local<v8::Object> MakePerformance(const JsScope& scope) {
   v8::Local<v8::Object> memory = v8::Object::New(scope.isolate);
   scope.Set(memory, StringId::jsHeapSizeLimit, JsHeapSizeLimit);
   scope.Set(memory, StringId::totalJSHeapSize, TotalJsHeapSize);
   scope.Set(memory, StringId::usedJSHeapSize, UsedJsHeapSize);
+  scope.Set(memory, StringId::residentSetSize, ResidentSetSize);
+
+  v8::Local<v8::Object> gc = v8::Object::New(scope.isolate);
+  scope.SetValue(gc, StringId::minor,
+                 MakeGcCounters<GcStats::Type::MINOR>(scope));
+  scope.SetValue(gc, StringId::major,
+                 MakeGcCounters<GcStats::Type::MAJOR>(scope));
+
+  v8::Local<v8::Object> tasks = v8::Object::New(scope.isolate);
+  scope.Set(tasks, StringId::executed, TasksExecuted);
+  scope.Set(tasks, StringId::deferred, TasksDeferred);
+  scope.Set(tasks, StringId::framesOverBudget, FramesOverBudget);
+
+  v8::Local<v8::Object> code_cache = v8::Object::New(scope.isolate);
+  scope.Set(code_cache, StringId::hits, CodeCacheHits);
+  scope.Set(code_cache, StringId::misses, CodeCacheMisses);
+  scope.Set(code_cache, StringId::rejected, CodeCacheRejected);
 
   v8::Local<v8::Object> performance = v8::Object::New(scope.isolate);
   scope.Set(performance, StringId::now, Now);
   scope.SetValue(performance, StringId::memory, memory);
-  scope.SetValue(global, StringId::performance, performance);
+  scope.SetValue(performance, StringId::gc, gc);
+  scope.SetValue(performance, StringId::tasks, tasks);
+  scope.SetValue(performance, StringId::codeCache, code_cache);
+  return performance;
+}
+
+v8::Local<v8::Object> MakeWindowDebug(const JsScope& scope) {
+  v8::Local<v8::Object> debug = v8::Object::New(scope.isolate);
+  scope.Set(debug, StringId::showOverlayConsole, GetShowOverlayConsole,
+            SetShowOverlayConsole);
+  scope.Set(debug, StringId::showOverlayConsoleOnErrors,
+            GetShowOverlayConsoleOnErrors, SetShowOverlayConsoleOnErrors);
+  scope.Set(debug, StringId::overlayConsoleTextColor,
+            GetOverlayConsoleTextColor, SetOverlayConsoleTextColor);
+  scope.Set(debug, StringId::showOverlayStats, GetShowOverlayStats,
+            SetShowOverlayStats);
+  scope.Set(debug, StringId::profileFrameTimes, GetProfileFrameTimes,
+            SetProfileFrameTimes);
+  scope.Set(debug, StringId::startTracing, StartTracing);
+  scope.Set(debug, StringId::stopTracing, StopTracing);
+  scope.Set(debug, StringId::startProfiling, StartProfiling);
+  scope.Set(debug, StringId::stopProfiling, StopProfiling);
+  scope.Set(debug, StringId::writeHeapSnapshot, WriteHeapSnapshot);
+  return debug;
+}
 
+v8::Local<v8::Object> MakeWindowScreen(const JsScope& scope) {
+  v8::Local<v8::Object> screen = v8::Object::New(scope.isolate);
+  scope.Set(screen, StringId::availWidth, AvailWidth);
+  scope.Set(screen, StringId::availHeight, AvailHeight);
+  scope.Set(screen, StringId::width, ScreenWidth);
+  scope.Set(screen, StringId::height, ScreenHeight);
+  return screen;
+}
+
+void GetLazyWindowDebug(v8::Local<v8::Name> property,
+                        const v8::PropertyCallbackInfo<v8::Value>& info) {
+  JsScope scope(Js::Get(info.GetIsolate()));
+  info.GetReturnValue().Set(MakeWindowDebug(scope));
+}
+
+void GetLazyWindowScreen(v8::Local<v8::Name> property,
+                         const v8::PropertyCallbackInfo<v8::Value>& info) {
+  JsScope scope(Js::Get(info.GetIsolate()));
+  info.GetReturnValue().Set(MakeWindowScreen(scope));
+}
+
+v8::Local<v8::Object> MakeWindow(const JsScope& scope) {
   v8::Local<v8::Object> window = v8::Object::New(scope.isolate);
   scope.Set(window, StringId::close, Close);
   scope.Set(window, StringId::focus, Focus);
@@ -666,73 +868,321 @@ JsApi::JsApi(Window* win, Js* js, JsEvents* events, TaskQueue* task_queue,
   scope.Set(window, StringId::retinaScale, GetRetinaScale);
   scope.Set(window, StringId::version, GetVersion);
   scope.Set(window, StringId::platform, GetPlatform);
-  scope.Set(global, StringId::window, window);
+  scope.SetLazy(window, StringId::debug, GetLazyWindowDebug);
+  scope.SetLazy(window, StringId::screen, GetLazyWindowScreen);
+  scope.SetLazy(window, StringId::canvas, GetLazyCanvas);
+  return window;
+}
 
-  v8::Local<v8::Object> debug = v8::Object::New(scope.isolate);
-  scope.Set(debug, StringId::showOverlayConsole, GetShowOverlayConsole,
-            SetShowOverlayConsole);
-  scope.Set(debug, StringId::showOverlayConsoleOnErrors,
-            GetShowOverlayConsoleOnErrors, SetShowOverlayConsoleOnErrors);
-  scope.Set(debug, StringId::overlayConsoleTextColor,
-            GetOverlayConsoleTextColor, SetOverlayConsoleTextColor);
-  scope.Set(debug, StringId::showOverlayStats, GetShowOverlayStats,
-            SetShowOverlayStats);
-  scope.Set(debug, StringId::profileFrameTimes, GetProfileFrameTimes,
-            SetProfileFrameTimes);
-  scope.SetValue(window, StringId::debug, debug);
+void GetLazyPerformance(v8::Local<v8::Name> property,
+                        const v8::PropertyCallbackInfo<v8::Value>& info) {
+  JsScope scope(Js::Get(info.GetIsolate()));
+  info.GetReturnValue().Set(MakePerformance(scope));
+}
 
-  v8::Local<v8::Object> screen = v8::Object::New(scope.isolate);
-  scope.Set(screen, StringId::availWidth, AvailWidth);
-  scope.Set(screen, StringId::availHeight, AvailHeight);
-  scope.Set(screen, StringId::width, ScreenWidth);
-  scope.Set(screen, StringId::height, ScreenHeight);
-  scope.SetValue(window, StringId::screen, screen);
-
-  v8::Local<v8::Function> process = ProcessApi::GetConstructor(this, scope);
-  process_constructor_.Reset(scope.isolate, process);
-  scope.Set(global, StringId::Process, process);
-  parent_process_ = ProcessApi::MaybeAttachToParent(this, scope, process);
-
-  v8::Local<v8::Function> image_data =
-      ImageDataApi::GetConstructor(this, scope);
-  image_data_constructor_.Reset(scope.isolate, image_data);
-  scope.Set(global, StringId::ImageData, image_data);
-
-  v8::Local<v8::Function> image_bitmap =
-      ImageBitmapApi::GetConstructor(this, scope);
-  image_bitmap_constructor_.Reset(scope.isolate, image_bitmap);
-  scope.Set(global, StringId::ImageBitmap, image_bitmap);
-
-  v8::Local<v8::Function> canvas_gradient =
-      CanvasGradientApi::GetConstructor(this, scope);
-  canvas_gradient_constructor_.Reset(scope.isolate, canvas_gradient);
-  scope.Set(global, StringId::CanvasGradient, canvas_gradient);
-
-  v8::Local<v8::Function> canvas_pattern =
-      CanvasPatternApi::GetConstructor(this, scope);
-  canvas_pattern_constructor_.Reset(scope.isolate, canvas_pattern);
-  scope.Set(global, StringId::CanvasPattern, canvas_pattern);
-
-  v8::Local<v8::Function> canvas =
-      CanvasRenderingContext2DApi::GetConstructor(this, scope);
-  canvas_rendering_context_2d_constructor_.Reset(scope.isolate, canvas);
-  scope.Set(global, StringId::CanvasRenderingContext2D, canvas);
-
-  v8::Local<v8::Function> path2d = Path2DApi::GetConstructor(this, scope);
-  path2d_constructor_.Reset(scope.isolate, path2d);
-  scope.Set(global, StringId::Path2D, path2d);
+void GetLazyWindow(v8::Local<v8::Name> property,
+                   const v8::PropertyCallbackInfo<v8::Value>& info) {
+  JsScope scope(Js::Get(info.GetIsolate()));
+  info.GetReturnValue().Set(MakeWindow(scope));
+}
 
-  scope.SetLazy(window, StringId::canvas, GetLazyCanvas);
+void GetLazyCodec(v8::Local<v8::Name> property,
+                  const v8::PropertyCallbackInfo<v8::Value>& info) {
+  JsScope scope(Js::Get(info.GetIsolate()));
+  info.GetReturnValue().Set(MakeCodecApi(scope));
+}
+
+void GetLazyFile(v8::Local<v8::Name> property,
+                 const v8::PropertyCallbackInfo<v8::Value>& info) {
+  JsScope scope(Js::Get(info.GetIsolate()));
+  info.GetReturnValue().Set(MakeFileApi(scope));
+}
+
+// Indexed by JsApi::Constructor.
+constexpr StringId kConstructorNames[] = {
+    StringId::AbortController,
+    StringId::AbortSignal,
+    StringId::CanvasGradient,
+    StringId::CanvasPattern,
+    StringId::CanvasPicture,
+    StringId::CanvasRenderingContext2D,
+    StringId::ImageBitmap,
+    StringId::ImageData,
+    StringId::Path2D,
+    StringId::Process,
+    StringId::Worker,
+};
+
+static_assert(std::size(kConstructorNames) ==
+              static_cast<size_t>(JsApi::Constructor::LAST_CONSTRUCTOR));
+
+v8::Local<v8::Function> NewConstructor(JsApi::Constructor constructor,
+                                       const JsScope& scope) {
+  switch (constructor) {
+    case JsApi::Constructor::ABORT_CONTROLLER:
+      return AbortControllerApi::GetConstructor(scope);
+    case JsApi::Constructor::ABORT_SIGNAL:
+      return AbortSignalApi::GetConstructor(scope);
+    case JsApi::Constructor::CANVAS_GRADIENT:
+      return CanvasGradientApi::GetConstructor(scope);
+    case JsApi::Constructor::CANVAS_PATTERN:
+      return CanvasPatternApi::GetConstructor(scope);
+    case JsApi::Constructor::CANVAS_PICTURE:
+      return CanvasPictureApi::GetConstructor(scope);
+    case JsApi::Constructor::CANVAS_RENDERING_CONTEXT_2D:
+      return CanvasRenderingContext2DApi::GetConstructor(scope);
+    case JsApi::Constructor::IMAGE_BITMAP:
+      return ImageBitmapApi::GetConstructor(scope);
+    case JsApi::Constructor::IMAGE_DATA:
+      return ImageDataApi::GetConstructor(scope);
+    case JsApi::Constructor::PATH2D:
+      return Path2DApi::GetConstructor(scope);
+    case JsApi::Constructor::PROCESS:
+      return ProcessApi::GetConstructor(scope);
+    case JsApi::Constructor::WORKER:
+      return WorkerApi::GetConstructor(scope);
+    case JsApi::Constructor::LAST_CONSTRUCTOR:
+      break;
+  }
+  ASSERT(false);
+  return {};
+}
+
+// The Data() is the JsApi::Constructor to return.
+void GetLazyConstructor(v8::Local<v8::Name> property,
+                        const v8::PropertyCallbackInfo<v8::Value>& info) {
+  auto constructor =
+      static_cast<JsApi::Constructor>(info.Data().As<v8::Int32>()->Value());
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  if (api) {
+    // Scripts get the same constructor that JsApi uses internally.
+    info.GetReturnValue().Set(api->GetApiConstructor(constructor));
+  } else {
+    // There is no JsApi while the startup snapshot is created.
+    JsScope scope(Js::Get(info.GetIsolate()));
+    info.GetReturnValue().Set(NewConstructor(constructor, scope));
+  }
+}
+
+v8::Local<v8::Function> GetGlobalFunction(const JsScope& scope, StringId id) {
+  return scope.context->Global()
+      ->Get(scope.context, scope.GetConstantString(id))
+      .ToLocalChecked()
+      .As<v8::Function>();
+}
+
+}  // namespace
+
+JsApi::JsApi(Window* win, Js* js, JsEvents* events, TaskQueue* task_queue,
+             ThreadPoolTaskQueue* io_queue, ThreadPoolTaskQueue* cpu_queue)
+    : weak_factory_(this),
+      window_(win),
+      js_(js),
+      events_(events),
+      task_queue_(task_queue),
+      io_queue_(io_queue),
+      cpu_queue_(cpu_queue),
+      next_timeout_id_(0),
+      animation_frame_base_id_(0),
+      animation_frame_next_id_(0),
+      next_idle_callback_id_(1),
+      background_completions_(std::make_shared<BackgroundCompletions>()),
+      cursor_shape_(0),
+      cursor_image_(nullptr),
+      cursor_x_(0),
+      cursor_y_(0),
+      cursor_(nullptr),
+      parent_process_(nullptr) {
+  bool profile_startup = Args().profile_startup && window_;
+  if (profile_startup) {
+    $(DEV) << "[profile-startup] create JS APIs start: " << glfwGetTime();
+  }
+
+  v8::Locker locker(js->isolate());
+  JsScope scope(js);
 
-  scope.Set(global, StringId::Codec, MakeCodecApi(this, scope));
-  scope.Set(global, StringId::File, MakeFileApi(this, scope));
+  js->isolate()->SetData(1, this);
+
+  if (!window_) {
+    InstallWorkerGlobals(scope);
+    return;
+  }
+
+  if (js->from_snapshot()) {
+    // The snapshot has the constructors already, and they must be the same
+    // that JsApi uses.
+    for (int i = 0; i < static_cast<int>(Constructor::LAST_CONSTRUCTOR); i++) {
+      constructors_[i].Reset(scope.isolate,
+                             GetGlobalFunction(scope, kConstructorNames[i]));
+    }
+  } else {
+    InstallGlobals(scope);
+    if (Args().disable_lazy_api) {
+      MaterializeGlobals(scope);
+      js->strings()->MaterializeAll(scope.isolate);
+    }
+  }
 
-  if (Args().profile_startup) {
+  parent_process_ = ProcessApi::MaybeAttachToParent(this, scope);
+
+  if (profile_startup) {
     $(DEV) << "[profile-startup] create JS APIs end: " << glfwGetTime();
   }
 }
 
+// static
+void JsApi::InstallGlobals(const JsScope& scope) {
+  v8::Local<v8::Object> global = scope.context->Global();
+
+  scope.Set(global, StringId::setTimeout, SetTimeout);
+  scope.Set(global, StringId::clearTimeout, ClearTimeout);
+  scope.Set(global, StringId::setInterval, SetInterval);
+  scope.Set(global, StringId::clearInterval, ClearInterval);
+  scope.Set(global, StringId::requestAnimationFrame, RequestAnimationFrame);
+  scope.Set(global, StringId::cancelAnimationFrame, CancelAnimationFrame);
+  scope.Set(global, StringId::requestIdleCallback, RequestIdleCallback);
+  scope.Set(global, StringId::cancelIdleCallback, CancelIdleCallback);
+  scope.Set(global, StringId::devicePixelRatio, DevicePixelRatio);
+
+  // The other APIs are only built when scripts use them.
+  scope.SetLazy(global, StringId::performance, GetLazyPerformance);
+  scope.SetLazy(global, StringId::window, GetLazyWindow);
+  scope.SetLazy(global, StringId::Codec, GetLazyCodec);
+  scope.SetLazy(global, StringId::File, GetLazyFile);
+
+  for (int i = 0; i < static_cast<int>(Constructor::LAST_CONSTRUCTOR); i++) {
+    scope.SetLazy(global, kConstructorNames[i], GetLazyConstructor,
+                  v8::Integer::New(scope.isolate, i));
+  }
+}
+
+// static
+void JsApi::InstallWorkerGlobals(const JsScope& scope) {
+  v8::Local<v8::Object> global = scope.context->Global();
+
+  scope.Set(global, StringId::setTimeout, SetTimeout);
+  scope.Set(global, StringId::clearTimeout, ClearTimeout);
+  scope.Set(global, StringId::setInterval, SetInterval);
+  scope.Set(global, StringId::clearInterval, ClearInterval);
+
+  scope.SetLazy(global, StringId::performance, GetLazyPerformance);
+  scope.SetLazy(global, StringId::Codec, GetLazyCodec);
+  scope.SetLazy(global, StringId::File, GetLazyFile);
+
+  // Only the constructors that don't need the window.
+  for (Constructor constructor :
+       {Constructor::ABORT_CONTROLLER, Constructor::ABORT_SIGNAL,
+        Constructor::IMAGE_DATA, Constructor::WORKER}) {
+    int i = static_cast<int>(constructor);
+    scope.SetLazy(global, kConstructorNames[i], GetLazyConstructor,
+                  v8::Integer::New(scope.isolate, i));
+  }
+}
+
+// static
+void JsApi::MaterializeGlobals(const JsScope& scope) {
+  v8::Local<v8::Object> global = scope.context->Global();
+
+  auto get = [&scope](v8::Local<v8::Object> object, StringId id) {
+    return object->Get(scope.context, scope.GetConstantString(id))
+        .ToLocalChecked();
+  };
+
+  get(global, StringId::performance);
+  get(global, StringId::Codec);
+  get(global, StringId::File);
+  for (StringId id : kConstructorNames) {
+    get(global, id);
+  }
+
+  // window.canvas is left lazy, since it needs the native window.
+  v8::Local<v8::Object> window = get(global, StringId::window).As<v8::Object>();
+  get(window, StringId::debug);
+  get(window, StringId::screen);
+}
+
+// static
+const intptr_t* JsApi::GetExternalReferences() {
+  static const std::vector<intptr_t>* refs = [] {
+    auto* refs = new std::vector<intptr_t>;
+    AppendExternalReferences(refs, {SetTimeout, ClearTimeout, SetInterval,
+                                    ClearInterval, RequestAnimationFrame,
+                                    CancelAnimationFrame, RequestIdleCallback,
+                                    CancelIdleCallback, DevicePixelRatio,
+                                    JsHeapSizeLimit, TotalJsHeapSize,
+                                    UsedJsHeapSize, ResidentSetSize,
+                                    TasksExecuted,
+                                    TasksDeferred, FramesOverBudget,
+                                    CodeCacheHits, CodeCacheMisses,
+                                    CodeCacheRejected, Now, Close, Focus,
+                                    RequestAttention, Minimize, Maximize,
+                                    Restore, GetTitle, SetTitle, GetWidth,
+                                    SetWidth, GetHeight, SetHeight,
+                                    GetFrameLeft, GetFrameRight, GetFrameTop,
+                                    GetFrameBottom, GetX, SetX, GetY, SetY,
+                                    GetVisible, SetVisible, GetDecorated,
+                                    SetDecorated, GetResizable, SetResizable,
+                                    GetAlwaysOnTop, SetAlwaysOnTop,
+                                    GetKeepAspectRatio, SetKeepAspectRatio,
+                                    GetFocused, GetMaximized, GetMinimized,
+                                    GetFullscreen, SetFullscreen, GetVsync,
+                                    SetVsync, AddEventListener,
+                                    RemoveEventListener, GetFonts, GetJs,
+                                    GetIcon, SetIcon, GetCursor, SetCursor,
+                                    GetCursorOffsetX, SetCursorOffsetX,
+                                    GetCursorOffsetY, SetCursorOffsetY,
+                                    GetClipboardText, SetClipboardText,
+                                    LoadFont, Open, GetRetinaScale, GetVersion,
+                                    GetPlatform, GetShowOverlayConsole,
+                                    SetShowOverlayConsole,
+                                    GetShowOverlayConsoleOnErrors,
+                                    SetShowOverlayConsoleOnErrors,
+                                    GetOverlayConsoleTextColor,
+                                    SetOverlayConsoleTextColor,
+                                    GetShowOverlayStats, SetShowOverlayStats,
+                                    GetProfileFrameTimes, SetProfileFrameTimes,
+                                    StartTracing, StopTracing, StartProfiling,
+                                    StopProfiling, WriteHeapSnapshot,
+                                    AvailWidth, AvailHeight, ScreenWidth,
+                                    ScreenHeight, GetLazyCanvas,
+                                    GetLazyWindowDebug, GetLazyWindowScreen,
+                                    GetLazyPerformance, GetLazyWindow,
+                                    GetLazyCodec, GetLazyFile,
+                                    GetLazyConstructor});
+    AbortControllerApi::AddExternalReferences(refs);
+    AbortSignalApi::AddExternalReferences(refs);
+    CanvasGradientApi::AddExternalReferences(refs);
+    CanvasPatternApi::AddExternalReferences(refs);
+    CanvasPictureApi::AddExternalReferences(refs);
+    CanvasRenderingContext2DApi::AddExternalReferences(refs);
+    ImageBitmapApi::AddExternalReferences(refs);
+    ImageDataApi::AddExternalReferences(refs);
+    Path2DApi::AddExternalReferences(refs);
+    ProcessApi::AddExternalReferences(refs);
+    WorkerApi::AddExternalReferences(refs);
+    AddGcExternalReferences(refs);
+    AddCodecApiExternalReferences(refs);
+    AddFileApiExternalReferences(refs);
+    refs->push_back(0);
+    return refs;
+  }();
+  return refs->data();
+}
+
+void JsApi::MakeConstructor(Constructor constructor) {
+  JsScope scope(js_);
+  constructors_[static_cast<int>(constructor)].Reset(
+      scope.isolate, NewConstructor(constructor, scope));
+}
+
 JsApi::~JsApi() {
+  // Terminate() removes each worker from workers_.
+  std::unordered_set<WorkerApi*> workers;
+  workers.swap(workers_);
+  for (WorkerApi* worker : workers) {
+    worker->Terminate();
+  }
+
   js_->isolate()->SetData(1, nullptr);
   if (cursor_) {
     glfwDestroyCursor(cursor_);
@@ -753,10 +1203,23 @@ void* JsApi::GetWrappedInstanceOrThrow(v8::Local<v8::Value> thiz,
 
 // static
 void JsApi::SetTimeout(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  StartTimeout(args, false);
+}
+
+// static
+void JsApi::SetInterval(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  StartTimeout(args, true);
+}
+
+// static
+void JsApi::StartTimeout(const v8::FunctionCallbackInfo<v8::Value>& args,
+                         bool repeating) {
   JsApi* api = JsApi::Get(args.GetIsolate());
 
   if (args.Length() < 1 || !args[0]->IsFunction()) {
-    api->js()->ThrowError("setTimeout requires a function argument.");
+    api->js()->ThrowError(repeating
+                              ? "setInterval requires a function argument."
+                              : "setTimeout requires a function argument.");
     return;
   }
 
@@ -775,10 +1238,15 @@ void JsApi::SetTimeout(const v8::FunctionCallbackInfo<v8::Value>& args) {
   uint32_t id = api->next_timeout_id_++;
   args.GetReturnValue().Set(id);
 
-  api->timeouts_[id] = std::move(f);
-  api->task_queue()->Post(timeout, [=] {
-    api->CallTimeout(id);
-  });
+  // Intervals repeat every millisecond at most.
+  double interval = repeating ? std::max(timeout, 0.001) : 0;
+  TaskQueue::TimerId timer_id = api->task_queue()->StartTimer(
+      timeout, interval, [=] { api->CallTimeout(id); });
+
+  Timeout& t = api->timeouts_[id];
+  t.callback = std::move(f);
+  t.timer_id = timer_id;
+  t.repeating = repeating;
 }
 
 // static
@@ -790,8 +1258,27 @@ void JsApi::ClearTimeout(const v8::FunctionCallbackInfo<v8::Value>& args) {
     return;
   }
 
-  uint32_t id = args[0].As<v8::Uint32>()->Value();
-  api->timeouts_.erase(id);
+  api->CancelTimeout(args[0].As<v8::Uint32>()->Value());
+}
+
+// static
+void JsApi::ClearInterval(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+
+  if (args.Length() < 1 || !args[0]->IsUint32()) {
+    api->js()->ThrowError("clearInterval requires an int argument.");
+    return;
+  }
+
+  api->CancelTimeout(args[0].As<v8::Uint32>()->Value());
+}
+
+void JsApi::CancelTimeout(uint32_t id) {
+  auto it = timeouts_.find(id);
+  if (it != timeouts_.end()) {
+    task_queue_->CancelTimer(it->second.timer_id);
+    timeouts_.erase(it);
+  }
 }
 
 void JsApi::CallTimeout(uint32_t id) {
@@ -804,8 +1291,10 @@ void JsApi::CallTimeout(uint32_t id) {
   JsScope scope(js_);
   v8::TryCatch try_catch(scope.isolate);
 
-  v8::Local<v8::Function> callback = it->second.Get(scope.isolate);
-  timeouts_.erase(it);
+  v8::Local<v8::Function> callback = it->second.callback.Get(scope.isolate);
+  if (!it->second.repeating) {
+    timeouts_.erase(it);
+  }
 
   IGNORE_RESULT(callback->Call(scope.context, js_->global(), 0, {}));
 
@@ -889,56 +1378,275 @@ void JsApi::CallAnimationFrameCallbacks(const JsScope& scope) {
   }
 }
 
+// static
+void JsApi::RequestIdleCallback(
+    const v8::FunctionCallbackInfo<v8::Value>& args) {
+  JsApi* api = JsApi::Get(args.GetIsolate());
+
+  if (args.Length() < 1 || !args[0]->IsFunction()) {
+    api->js()->ThrowError("requestIdleCallback requires a function argument.");
+    return;
+  }
+
+  uint32_t id = api->next_idle_callback_id_++;
+  args.GetReturnValue().Set(id);
+
+  IdleCallback& idle = api->idle_callbacks_[id];
+  idle.callback.Reset(args.GetIsolate(), args[0].As<v8::Function>());
+  idle.timer_id = 0;
+  idle.timeout = std::numeric_limits<double>::infinity();
+
+  if (args.Length() >= 2 && args[1]->IsObject()) {
+    v8::Local<v8::Object> options = args[1].As<v8::Object>();
+    v8::Local<v8::Value> timeout;
+    if (options
+            ->Get(args.GetIsolate()->GetCurrentContext(),
+                  api->js()->GetConstantString(StringId::timeout))
+            .ToLocal(&timeout) &&
+        timeout->IsNumber()) {
+      double t = timeout.As<v8::Number>()->Value();
+      if (t > 0) {
+        // From milliseconds to seconds.
+        idle.timeout = glfwGetTime() + t / 1000.0;
+        idle.timer_id = api->task_queue()->StartTimer(
+            t / 1000.0, 0, [=] { api->CallIdleCallbackTimeout(id); });
+      }
+    }
+  }
+}
+
+// static
+void JsApi::CancelIdleCallback(
+    const v8::FunctionCallbackInfo<v8::Value>& args) {
+  if (args.Length() < 1 || !args[0]->IsUint32()) {
+    return;
+  }
+  JsApi* api = JsApi::Get(args.GetIsolate());
+  auto it = api->idle_callbacks_.find(args[0].As<v8::Uint32>()->Value());
+  if (it != api->idle_callbacks_.end()) {
+    if (it->second.timer_id) {
+      api->task_queue()->CancelTimer(it->second.timer_id);
+    }
+    api->idle_callbacks_.erase(it);
+  }
+}
+
+// static
+void JsApi::TimeRemaining(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  double deadline = args.Data().As<v8::Number>()->Value();
+  double remaining = std::max(0.0, deadline - glfwGetTime());
+  // From seconds to milliseconds.
+  args.GetReturnValue().Set(remaining * 1000);
+}
+
+v8::Local<v8::Object> JsApi::MakeIdleDeadline(const JsScope& scope,
+                                              double deadline,
+                                              bool did_timeout) {
+  v8::Local<v8::Object> object = v8::Object::New(scope.isolate);
+  scope.Set(object, StringId::timeRemaining, TimeRemaining,
+            v8::Number::New(scope.isolate, deadline));
+  scope.Set(object, StringId::didTimeout, did_timeout);
+  return object;
+}
+
+void JsApi::CallIdleCallbacks(const JsScope& scope, double deadline) {
+  if (idle_callbacks_.empty()) {
+    return;
+  }
+
+  uint32_t end_id = next_idle_callback_id_;
+
+  v8::TryCatch try_catch(scope.isolate);
+
+  // Callbacks can request and cancel other idle callbacks, so the next one is
+  // looked up again after each call.
+  uint32_t next_id = 0;
+  while (glfwGetTime() < deadline) {
+    auto it = idle_callbacks_.lower_bound(next_id);
+    if (it == idle_callbacks_.end() || it->first >= end_id) {
+      break;
+    }
+    next_id = it->first + 1;
+
+    // The timer of an expired timeout is a pending task, and idle periods
+    // only start once there are no pending tasks. The timer runs the callback
+    // with didTimeout set in the next frame instead.
+    if (glfwGetTime() >= it->second.timeout) {
+      continue;
+    }
+
+    v8::Local<v8::Function> callback = it->second.callback.Get(scope.isolate);
+    if (it->second.timer_id) {
+      task_queue_->CancelTimer(it->second.timer_id);
+    }
+    idle_callbacks_.erase(it);
+
+    v8::Local<v8::Value> args[] = {MakeIdleDeadline(scope, deadline, false)};
+    IGNORE_RESULT(callback->Call(scope.context, scope.context->Global(), 1,
+                                 args));
+
+    if (try_catch.HasCaught()) {
+      js_->ReportException(try_catch.Message());
+      if (!try_catch.CanContinue()) {
+        return;
+      }
+      try_catch.Reset();
+    }
+  }
+}
+
+void JsApi::CallIdleCallbackTimeout(uint32_t id) {
+  auto it = idle_callbacks_.find(id);
+  if (it == idle_callbacks_.end()) {
+    // Already ran, or removed by cancelIdleCallback.
+    return;
+  }
+
+  JsScope scope(js_);
+  v8::TryCatch try_catch(scope.isolate);
+
+  v8::Local<v8::Function> callback = it->second.callback.Get(scope.isolate);
+  idle_callbacks_.erase(it);
+
+  // The callback is overdue, so there is no idle time left.
+  v8::Local<v8::Value> args[] = {MakeIdleDeadline(scope, 0, true)};
+  IGNORE_RESULT(callback->Call(scope.context, js_->global(), 1, args));
+
+  if (try_catch.HasCaught()) {
+    js_->ReportException(try_catch.Message());
+  }
+}
+
 v8::Local<v8::Promise> JsApi::PostToBackgroundAndResolve(
-    BackgroundFunction background_task) {
-  ASSERT(IsMainThread());
+    BackgroundTaskType type, BackgroundFunction background_task,
+    const TraceLocation& from) {
+  return PostToBackgroundAndResolve(
+      type, nullptr,
+      [b = std::move(background_task)](const CancelFlag& cancelled) {
+        return b();
+      },
+      from);
+}
+
+v8::Local<v8::Promise> JsApi::PostToBackgroundAndResolve(
+    BackgroundTaskType type, AbortSignalApi* signal,
+    CancellableBackgroundFunction background_task,
+    const TraceLocation& from) {
+  ASSERT(IsJsThread());
 
   v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
   v8::Local<v8::Promise::Resolver> resolver =
-      v8::Promise::Resolver::New(isolate->GetCurrentContext()).ToLocalChecked();
+      v8::Promise::Resolver::New(context).ToLocalChecked();
+
+  if (signal && signal->aborted()) {
+    IGNORE_RESULT(resolver->Reject(context, signal->reason()));
+    return resolver->GetPromise();
+  }
+
   size_t index = StorePendingPromise(isolate, resolver);
 
   WeakPtr<JsApi> weak_this = weak_factory_.MakeWeakPtr();
   TaskQueue* task_queue = task_queue_;
+  std::shared_ptr<BackgroundCompletions> completions = background_completions_;
 
-  background_queue_->Post(
-      [weak_this, task_queue, index, b = std::move(background_task)] {
-        ASSERT(!IsMainThread());
+  std::shared_ptr<CancelFlag> cancelled;
+  if (signal) {
+    cancelled = signal->AddAbortAlgorithm(
+        [weak_this, index](v8::Local<v8::Value> reason, const JsScope& scope) {
+          JsApi* thiz = weak_this.Get();
+          if (thiz) {
+            IGNORE_RESULT(thiz->ReleasePendingPromise(scope.isolate, index)
+                              ->Reject(scope.context, reason));
+          }
+        });
+  } else {
+    cancelled = std::make_shared<CancelFlag>();
+  }
 
-        ResolveFunction resolve_task = b();
+  ThreadPoolTaskQueue* background_queue =
+      type == BackgroundTaskType::IO ? io_queue_ : cpu_queue_;
 
-        // Subtle: this is safe because the task_queue_ is deleted *after* the
-        // background_queue_, and the background_queue_ joins its threads at
-        // shutdown. So as long as the background task is executing, the
-        // TaskQueue* instance is still valid.
-        task_queue->Post([weak_this, index, r = std::move(resolve_task)] {
-          ASSERT(IsMainThread());
+  background_queue->Post(
+      [weak_this, task_queue, completions, index, cancelled, from,
+       b = std::move(background_task)] {
+        ASSERT(!IsJsThread());
 
-          JsApi* thiz = weak_this.Get();
-          if (!thiz) {
-            // The original JsApi instance was deleted while the background task
-            // was executing.
-            return;
-          }
+        // Tasks that were aborted while queued don't run at all.
+        if (cancelled->IsCancelled()) {
+          return;
+        }
 
-          JsScope scope(thiz->js_);
-          v8::TryCatch try_catch(scope.isolate);
-          v8::Local<v8::Promise::Resolver> resolver =
-              thiz->ReleasePendingPromise(scope.isolate, index);
-          r(thiz, scope, *resolver);
-          if (try_catch.HasCaught()) {
-            if (resolver->GetPromise()->State() == v8::Promise::kPending) {
-              IGNORE_RESULT(
-                  resolver->Reject(scope.context, try_catch.Message()->Get()));
-            }
-          }
-          ASSERT(resolver->GetPromise()->State() != v8::Promise::kPending);
-        });
-      });
+        ResolveFunction resolve = b(*cancelled);
+        if (cancelled->IsCancelled()) {
+          return;
+        }
+
+        completions->queue.Push(
+            BackgroundCompletion{index, std::move(resolve), cancelled});
+
+        // Only the first completion since the last batch posts a task.
+        if (!completions->resolve_posted.exchange(true,
+                                                  std::memory_order_acq_rel)) {
+          PostResolveBackgroundCompletions(weak_this, task_queue, from);
+        }
+      },
+      from);
 
   return resolver->GetPromise();
 }
 
+bool JsApi::GetAbortSignalOption(v8::Local<v8::Value> options,
+                                 AbortSignalApi** signal) {
+  *signal = nullptr;
+  if (options.IsEmpty() || options->IsUndefined()) {
+    return true;
+  }
+  if (!options->IsObject()) {
+    js_->ThrowInvalidArgument();
+    return false;
+  }
+  v8::Local<v8::Context> context = js_->context();
+  v8::Local<v8::Value> value;
+  if (!options.As<v8::Object>()
+           ->Get(context, js_->GetConstantString(StringId::signal))
+           .ToLocal(&value)) {
+    return false;
+  }
+  if (value->IsUndefined()) {
+    return true;
+  }
+  if (!IsInstanceOf(value, GetAbortSignalConstructor())) {
+    js_->ThrowTypeError("signal must be an AbortSignal");
+    return false;
+  }
+  *signal = GetAbortSignalApi(value);
+  return true;
+}
+
+CSSCache::Color JsApi::ParseCSSColor(v8::Local<v8::String> color) {
+  InternedCSSString<CSSCache::Color>& interned =
+      interned_css_colors_[static_cast<unsigned>(color->GetIdentityHash()) %
+                           kInternedCSSStrings];
+  if (interned.string != color) {
+    interned.value = css_cache_.GetColor(js_->ToString(color));
+    interned.string.Reset(isolate(), color);
+  }
+  return interned.value;
+}
+
+CSSCache::Font JsApi::ParseCSSFont(v8::Local<v8::String> font) {
+  InternedCSSString<CSSCache::Font>& interned =
+      interned_css_fonts_[static_cast<unsigned>(font->GetIdentityHash()) %
+                          kInternedCSSStrings];
+  if (interned.string != font) {
+    interned.value =
+        css_cache_.GetFont(js_->ToString(font), fonts_, fonts_cache());
+    interned.string.Reset(isolate(), font);
+  }
+  return interned.value;
+}
+
 // static
 JsApi::ResolveFunction JsApi::Reject(std::string reason) {
   return [s = std::move(reason)](JsApi* api, const JsScope& scope,
@@ -984,6 +1692,82 @@ JsApi::ResolveFunction JsApi::Resolve(std::string value) {
   };
 }
 
+// static
+void JsApi::PostResolveBackgroundCompletions(WeakPtr<JsApi> weak_this,
+                                             TaskQueue* task_queue,
+                                             const TraceLocation& from) {
+  // Subtle: this is safe when called from a background task because the
+  // task_queue_ is deleted *after* the background queues, and the background
+  // queues join their threads at shutdown. So as long as the background task
+  // is executing, the TaskQueue* instance is still valid.
+  task_queue->Post(
+      [weak_this] {
+        ASSERT(IsJsThread());
+
+        JsApi* thiz = weak_this.Get();
+        if (!thiz) {
+          // The original JsApi instance was deleted while the background
+          // task was executing.
+          return;
+        }
+        thiz->ResolveBackgroundCompletions();
+      },
+      from);
+}
+
+void JsApi::ResolveBackgroundCompletions() {
+  ASSERT(IsJsThread());
+
+  // Limits how long a single task can take when many background tasks finish
+  // at once. The remaining completions are resolved in another task, which
+  // is subject to the TaskQueue time budget.
+  constexpr int kMaxCompletionsPerBatch = 64;
+
+  BackgroundCompletions* completions = background_completions_.get();
+
+  // Completions pushed after this point post another task, unless this one
+  // picks them up first.
+  completions->resolve_posted.store(false, std::memory_order_release);
+
+  JsScope scope(js_);
+  {
+    // The promise reactions run once for the whole batch, below.
+    v8::Isolate::SuppressMicrotaskExecutionScope suppress(scope.isolate);
+
+    BackgroundCompletion completion;
+    int count = 0;
+    while (count < kMaxCompletionsPerBatch &&
+           completions->queue.Pop(&completion)) {
+      count++;
+      if (completion.cancelled->IsCancelled()) {
+        // Aborted after the background task finished.
+        continue;
+      }
+      // The promise gets settled now, so a later abort() has no effect.
+      completion.cancelled->Cancel();
+
+      v8::TryCatch try_catch(scope.isolate);
+      v8::Local<v8::Promise::Resolver> resolver =
+          ReleasePendingPromise(scope.isolate, completion.index);
+      completion.resolve(this, scope, *resolver);
+      if (try_catch.HasCaught()) {
+        if (resolver->GetPromise()->State() == v8::Promise::kPending) {
+          IGNORE_RESULT(
+              resolver->Reject(scope.context, try_catch.Message()->Get()));
+        }
+      }
+      ASSERT(resolver->GetPromise()->State() != v8::Promise::kPending);
+    }
+  }
+  scope.isolate->PerformMicrotaskCheckpoint();
+
+  if (!completions->queue.empty() &&
+      !completions->resolve_posted.exchange(true, std::memory_order_acq_rel)) {
+    PostResolveBackgroundCompletions(weak_factory_.MakeWeakPtr(), task_queue_,
+                                     TraceLocation::Current());
+  }
+}
+
 size_t JsApi::StorePendingPromise(v8::Isolate* isolate,
                                   v8::Local<v8::Promise::Resolver> resolver) {
   for (size_t index = 0; index < pending_promises_.size(); index++) {
@@ -998,7 +1782,7 @@ size_t JsApi::StorePendingPromise(v8::Isolate* isolate,
 
 v8::Local<v8::Promise::Resolver> JsApi::ReleasePendingPromise(
     v8::Isolate* isolate, size_t index) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   ASSERT(index < pending_promises_.size());
   ASSERT(!pending_promises_[index].IsEmpty());
   v8::Local<v8::Promise::Resolver> resolver =
@@ -1201,6 +1985,7 @@ void JsApi::LoadFont(const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string name = api->js()->ToString(args[1]);
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::IO,
       [path = std::move(path),
        name = std::move(name)]() -> JsApi::ResolveFunction {
         std::string content;
@@ -1220,6 +2005,11 @@ void JsApi::LoadFont(const v8::FunctionCallbackInfo<v8::Value>& args) {
                                                 path + ": failed to decode")));
           }
           api->fonts_[name] = font;
+          // Font names may match the new font now.
+          api->css_cache_.ClearFonts();
+          for (auto& interned : api->interned_css_fonts_) {
+            interned.string.Reset();
+          }
           IGNORE_RESULT(
               resolver->Resolve(scope.context, v8::Undefined(scope.isolate)));
         };
@@ -1,45 +1,132 @@
 #ifndef WINDOWJS_JS_API_H
 #define WINDOWJS_JS_API_H
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
+#include <map>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <skia/include/core/SkRefCnt.h>
+#include <v8/include/v8-fast-api-calls.h>
 
+#include "css.h"
 #include "fail.h"
 #include "js.h"
 #include "js_events.h"
+#include "mpsc_queue.h"
 #include "task_queue.h"
 #include "thread.h"
+#include "trace.h"
 #include "weak.h"
 #include "window.h"
 
+class AbortControllerApi;
+class AbortSignalApi;
 class CanvasGradientApi;
 class CanvasPatternApi;
+class CanvasPictureApi;
 class CanvasRenderingContext2DApi;
 class ImageBitmapApi;
 class ImageDataApi;
 class Path2DApi;
 class ProcessApi;
 class SkTypeface;
+class WorkerApi;
+
+// The address of a C++ callback of the Javascript APIs. v8 needs all of them
+// to serialize and deserialize the startup snapshot.
+struct ExternalReference {
+  ExternalReference(v8::FunctionCallback f)
+      : address(reinterpret_cast<intptr_t>(f)) {}
+  ExternalReference(v8::AccessorGetterCallback f)
+      : address(reinterpret_cast<intptr_t>(f)) {}
+  ExternalReference(v8::AccessorSetterCallback f)
+      : address(reinterpret_cast<intptr_t>(f)) {}
+  ExternalReference(v8::AccessorNameGetterCallback f)
+      : address(reinterpret_cast<intptr_t>(f)) {}
+  ExternalReference(v8::AccessorNameSetterCallback f)
+      : address(reinterpret_cast<intptr_t>(f)) {}
+
+  intptr_t address;
+};
+
+inline void AppendExternalReferences(
+    std::vector<intptr_t>* refs,
+    std::initializer_list<ExternalReference> list) {
+  for (const ExternalReference& ref : list) {
+    refs->push_back(ref.address);
+  }
+}
+
+// v8 Fast API functions need both their address and their type information
+// in the external references.
+inline void AppendExternalReferences(
+    std::vector<intptr_t>* refs, std::initializer_list<v8::CFunction> list) {
+  for (const v8::CFunction& function : list) {
+    refs->push_back(reinterpret_cast<intptr_t>(function.GetAddress()));
+    refs->push_back(reinterpret_cast<intptr_t>(function.GetTypeInfo()));
+  }
+}
 
 // Custom APIs added to v8 by Window.js.
 class JsApi final {
  public:
   // All of these dependencies must outlive JsApi.
+  // "window" is null in Workers, which only get the APIs installed by
+  // InstallWorkerGlobals().
   // If the JsApi is deleted, then TaskQueue must *not* run any pending tasks
   // anymore.
   JsApi(Window* window, Js* js, JsEvents* events, TaskQueue* task_queue,
-        ThreadPoolTaskQueue* background_queue);
+        ThreadPoolTaskQueue* io_queue, ThreadPoolTaskQueue* cpu_queue);
   ~JsApi();
 
+  // The constructors of the Javascript classes, which are created on first
+  // use.
+  enum class Constructor {
+    ABORT_CONTROLLER,
+    ABORT_SIGNAL,
+    CANVAS_GRADIENT,
+    CANVAS_PATTERN,
+    CANVAS_PICTURE,
+    CANVAS_RENDERING_CONTEXT_2D,
+    IMAGE_BITMAP,
+    IMAGE_DATA,
+    PATH2D,
+    PROCESS,
+    WORKER,
+    LAST_CONSTRUCTOR,
+  };
+
+  // Installs the Javascript APIs in the global object of the current context.
+  // Most of them are lazy data properties, that build their API on first
+  // access. This doesn't depend on a JsApi instance, so that the startup
+  // snapshot can include the APIs; see tools/make_snapshot.cc.
+  static void InstallGlobals(const JsScope& scope);
+
+  // Installs the subset of the APIs that Workers get, without the window.
+  static void InstallWorkerGlobals(const JsScope& scope);
+
+  // Builds all the lazy APIs installed by InstallGlobals(), except for
+  // window.canvas.
+  static void MaterializeGlobals(const JsScope& scope);
+
+  // Returns the C++ callbacks of the APIs installed by InstallGlobals(), as a
+  // null-terminated array.
+  static const intptr_t* GetExternalReferences();
+
   Window* window() const { return window_; }
   GLFWwindow* glfw_window() const { return window_->window(); }
   Js* js() const { return js_; }
   v8::Isolate* isolate() const { return js_->isolate(); }
   TaskQueue* task_queue() const { return task_queue_; }
-  ThreadPoolTaskQueue* background_queue() const { return background_queue_; }
+  ThreadPoolTaskQueue* io_queue() const { return io_queue_; }
+  ThreadPoolTaskQueue* cpu_queue() const { return cpu_queue_; }
   ProcessApi* parent_process() const { return parent_process_; }
   Canvas* window_canvas() const { return window_->canvas(); }
   CanvasSharedContext* canvas_shared_context() const {
@@ -51,25 +138,53 @@ class JsApi final {
   }
 
   std::unordered_map<std::string, sk_sp<SkTypeface>>* fonts_cache() {
-    return &fonts_cache_;
+    return window_->fonts_cache();
   }
 
+  // Parse CSS colors and fonts, e.g. of canvas styles. Strings that were
+  // parsed recently are found by identity, without reading them again; the
+  // others are looked up in css_cache().
+  CSSCache::Color ParseCSSColor(v8::Local<v8::String> color);
+  CSSCache::Font ParseCSSFont(v8::Local<v8::String> font);
+
+  CSSCache* css_cache() { return &css_cache_; }
+
   bool has_animation_frame_callbacks() const {
     return !animation_frame_callbacks_.empty();
   }
 
   void CallAnimationFrameCallbacks(const JsScope& scope);
 
+  bool has_idle_callbacks() const { return !idle_callbacks_.empty(); }
+
+  // Runs the pending idle callbacks until "deadline", which is in seconds
+  // since glfwInit(). Callbacks requested meanwhile run in the next idle
+  // period.
+  void CallIdleCallbacks(const JsScope& scope, double deadline);
+
   using ResolveFunction =
       std::function<void(JsApi*, const JsScope&, v8::Promise::Resolver*)>;
   using BackgroundFunction = std::function<ResolveFunction()>;
-
-  // Posts a "background_task" that gets executed in a background thread. Its
-  // return value is a "foreground_task", that gets executed in the main thread
-  // and is passed a v8::Promise::Resolver to resolve the promise returned by
-  // PostToBackgroundAndResolve. Example usage:
+  using CancellableBackgroundFunction =
+      std::function<ResolveFunction(const CancelFlag& cancelled)>;
+
+  // Background tasks run in separate thread pools depending on their type, so
+  // that slow disk reads don't stall CPU-bound work like image decoding, and
+  // vice versa.
+  enum class BackgroundTaskType {
+    // Tasks that mostly block on I/O, like reading and writing files.
+    IO,
+    // Tasks that mostly use the CPU, like decoding and encoding images.
+    CPU,
+  };
+
+  // Posts a "background_task" that gets executed in a background thread of
+  // the pool for its "type". Its return value is a "foreground_task", that
+  // gets executed in the main thread and is passed a v8::Promise::Resolver to
+  // resolve the promise returned by PostToBackgroundAndResolve. Example usage:
   //
-  // args.GetReturnValue().Set(api->PostToBackgroundAndResolve([] {
+  // args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+  //     JsApi::BackgroundTaskType::IO, [] {
   //   // Runs on a background thread.
   //   std::string content;
   //   ReadFile(some_path_from_args, &content);
@@ -80,9 +195,31 @@ class JsApi final {
   //   };
   // }));
   //
+  // The foreground tasks of background tasks that finish around the same time
+  // are run in a single main thread task, and their promise reactions run in
+  // a single microtask checkpoint afterwards.
+  //
   // Either task gets dropped if the Js object that owns us gets deleted.
   v8::Local<v8::Promise> PostToBackgroundAndResolve(
-      BackgroundFunction background_task);
+      BackgroundTaskType type, BackgroundFunction background_task,
+      const TraceLocation& from = TraceLocation::Current());
+
+  // Like the above, but the promise gets rejected with the signal's reason as
+  // soon as "signal" is aborted. Aborted tasks that haven't started yet don't
+  // run at all, and tasks that are running can check "cancelled" between
+  // their stages and return early; their ResolveFunction is dropped, and may
+  // be empty. "signal" may be null.
+  v8::Local<v8::Promise> PostToBackgroundAndResolve(
+      BackgroundTaskType type, AbortSignalApi* signal,
+      CancellableBackgroundFunction background_task,
+      const TraceLocation& from = TraceLocation::Current());
+
+  // Gets the "signal" property of an options object passed to an API that
+  // supports cancellation. "options" and its "signal" may be undefined, in
+  // which case "signal" is set to null. Returns false and throws if "signal"
+  // isn't an AbortSignal.
+  bool GetAbortSignalOption(v8::Local<v8::Value> options,
+                            AbortSignalApi** signal);
 
   // Helper to return a failure from PostToBackgroundAndResolve.
   static ResolveFunction Reject(std::string reason);
@@ -97,14 +234,41 @@ class JsApi final {
     return static_cast<JsApi*>(isolate->GetData(1));
   }
 
+  v8::Local<v8::Function> GetApiConstructor(Constructor constructor) {
+    v8::Global<v8::Function>& function =
+        constructors_[static_cast<int>(constructor)];
+    if (function.IsEmpty()) {
+      MakeConstructor(constructor);
+    }
+    return function.Get(js_->isolate());
+  }
+
   bool IsInstanceOf(v8::Local<v8::Value> object,
                     v8::Local<v8::Function> constructor) {
     return object->InstanceOf(isolate()->GetCurrentContext(), constructor)
         .FromMaybe(false);
   }
 
+  v8::Local<v8::Function> GetAbortControllerConstructor() {
+    return GetApiConstructor(Constructor::ABORT_CONTROLLER);
+  }
+
+  AbortControllerApi* GetAbortControllerApi(v8::Local<v8::Value> thiz) {
+    return GetWrappedInstanceOrThrow<AbortControllerApi>(
+        thiz, GetAbortControllerConstructor());
+  }
+
+  v8::Local<v8::Function> GetAbortSignalConstructor() {
+    return GetApiConstructor(Constructor::ABORT_SIGNAL);
+  }
+
+  AbortSignalApi* GetAbortSignalApi(v8::Local<v8::Value> thiz) {
+    return GetWrappedInstanceOrThrow<AbortSignalApi>(
+        thiz, GetAbortSignalConstructor());
+  }
+
   v8::Local<v8::Function> GetCanvasRenderingContext2DConstructor() {
-    return canvas_rendering_context_2d_constructor_.Get(js_->isolate());
+    return GetApiConstructor(Constructor::CANVAS_RENDERING_CONTEXT_2D);
   }
 
   CanvasRenderingContext2DApi* GetCanvasRenderingContext2DApi(
@@ -114,7 +278,7 @@ class JsApi final {
   }
 
   v8::Local<v8::Function> GetCanvasGradientConstructor() {
-    return canvas_gradient_constructor_.Get(js_->isolate());
+    return GetApiConstructor(Constructor::CANVAS_GRADIENT);
   }
 
   CanvasGradientApi* GetCanvasGradientApi(v8::Local<v8::Value> thiz) {
@@ -123,7 +287,7 @@ class JsApi final {
   }
 
   v8::Local<v8::Function> GetCanvasPatternConstructor() {
-    return canvas_pattern_constructor_.Get(js_->isolate());
+    return GetApiConstructor(Constructor::CANVAS_PATTERN);
   }
 
   CanvasPatternApi* GetCanvasPatternApi(v8::Local<v8::Value> thiz) {
@@ -131,8 +295,17 @@ class JsApi final {
         thiz, GetCanvasPatternConstructor());
   }
 
+  v8::Local<v8::Function> GetCanvasPictureConstructor() {
+    return GetApiConstructor(Constructor::CANVAS_PICTURE);
+  }
+
+  CanvasPictureApi* GetCanvasPictureApi(v8::Local<v8::Value> thiz) {
+    return GetWrappedInstanceOrThrow<CanvasPictureApi>(
+        thiz, GetCanvasPictureConstructor());
+  }
+
   v8::Local<v8::Function> GetImageDataConstructor() {
-    return image_data_constructor_.Get(js_->isolate());
+    return GetApiConstructor(Constructor::IMAGE_DATA);
   }
 
   ImageDataApi* GetImageDataApi(v8::Local<v8::Value> thiz) {
@@ -141,7 +314,7 @@ class JsApi final {
   }
 
   v8::Local<v8::Function> GetImageBitmapConstructor() {
-    return image_bitmap_constructor_.Get(js_->isolate());
+    return GetApiConstructor(Constructor::IMAGE_BITMAP);
   }
 
   ImageBitmapApi* GetImageBitmapApi(v8::Local<v8::Value> thiz) {
@@ -150,7 +323,7 @@ class JsApi final {
   }
 
   v8::Local<v8::Function> GetPath2DConstructor() {
-    return path2d_constructor_.Get(js_->isolate());
+    return GetApiConstructor(Constructor::PATH2D);
   }
 
   Path2DApi* GetPath2DApi(v8::Local<v8::Value> thiz) {
@@ -158,14 +331,28 @@ class JsApi final {
   }
 
   v8::Local<v8::Function> GetProcessConstructor() {
-    return process_constructor_.Get(js_->isolate());
+    return GetApiConstructor(Constructor::PROCESS);
   }
 
   ProcessApi* GetProcessApi(v8::Local<v8::Value> thiz) {
     return GetWrappedInstanceOrThrow<ProcessApi>(thiz, GetProcessConstructor());
   }
 
+  v8::Local<v8::Function> GetWorkerConstructor() {
+    return GetApiConstructor(Constructor::WORKER);
+  }
+
+  WorkerApi* GetWorkerApi(v8::Local<v8::Value> thiz) {
+    return GetWrappedInstanceOrThrow<WorkerApi>(thiz, GetWorkerConstructor());
+  }
+
+  // Workers started by this JsApi are terminated when it's deleted.
+  void AddWorker(WorkerApi* worker) { workers_.insert(worker); }
+  void RemoveWorker(WorkerApi* worker) { workers_.erase(worker); }
+
  private:
+  void MakeConstructor(Constructor constructor);
+
   template <typename T>
   T* GetWrappedInstanceOrThrow(v8::Local<v8::Value> thiz,
                                v8::Local<v8::Function> constructor) {
@@ -176,7 +363,12 @@ class JsApi final {
                                   v8::Local<v8::Function> constructor);
 
   static void SetTimeout(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetInterval(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void StartTimeout(const v8::FunctionCallbackInfo<v8::Value>& args,
+                           bool repeating);
   static void ClearTimeout(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ClearInterval(const v8::FunctionCallbackInfo<v8::Value>& args);
+  void CancelTimeout(uint32_t id);
   void CallTimeout(uint32_t id);
 
   static void RequestAnimationFrame(
@@ -184,6 +376,15 @@ class JsApi final {
   static void CancelAnimationFrame(
       const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  static void RequestIdleCallback(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void CancelIdleCallback(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void TimeRemaining(const v8::FunctionCallbackInfo<v8::Value>& args);
+  void CallIdleCallbackTimeout(uint32_t id);
+  v8::Local<v8::Object> MakeIdleDeadline(const JsScope& scope, double deadline,
+                                         bool did_timeout);
+
   static void GetIcon(v8::Local<v8::Name> property,
                       const v8::PropertyCallbackInfo<v8::Value>& info);
   static void SetIcon(v8::Local<v8::Name> property, v8::Local<v8::Value> value,
@@ -218,29 +419,69 @@ class JsApi final {
   v8::Local<v8::Promise::Resolver> ReleasePendingPromise(v8::Isolate* isolate,
                                                          size_t index);
 
+  struct BackgroundCompletion {
+    size_t index;
+    ResolveFunction resolve;
+    // Cancelled once the promise is settled, either by an abort or by this
+    // completion.
+    std::shared_ptr<CancelFlag> cancelled;
+  };
+
+  // Shared with the background tasks, which may outlive this JsApi.
+  struct BackgroundCompletions {
+    MpscQueue<BackgroundCompletion> queue;
+    // Whether a task to run ResolveBackgroundCompletions() has been posted
+    // and hasn't started yet.
+    std::atomic<bool> resolve_posted{false};
+  };
+
+  static void PostResolveBackgroundCompletions(WeakPtr<JsApi> weak_this,
+                                               TaskQueue* task_queue,
+                                               const TraceLocation& from);
+
+  // Resolves the promises of the background tasks that have finished, up to
+  // kMaxCompletionsPerBatch at a time.
+  void ResolveBackgroundCompletions();
+
   WeakPtrFactory<JsApi> weak_factory_;
   Window* window_;
   Js* js_;
   JsEvents* events_;
   TaskQueue* task_queue_;
-  ThreadPoolTaskQueue* background_queue_;
+  ThreadPoolTaskQueue* io_queue_;
+  ThreadPoolTaskQueue* cpu_queue_;
+
+  struct Timeout {
+    v8::Global<v8::Function> callback;
+    TaskQueue::TimerId timer_id;
+    bool repeating;
+  };
 
-  std::unordered_map<uint32_t, v8::Global<v8::Function>> timeouts_;
+  std::unordered_map<uint32_t, Timeout> timeouts_;
   uint32_t next_timeout_id_;
 
   std::vector<v8::Global<v8::Function>> animation_frame_callbacks_;
   uint32_t animation_frame_base_id_;
   uint32_t animation_frame_next_id_;
 
+  struct IdleCallback {
+    v8::Global<v8::Function> callback;
+    // The timer for the "timeout" option, or 0.
+    TaskQueue::TimerId timer_id;
+    // When the timer expires, in the time base of glfwGetTime(), or infinity.
+    double timeout;
+  };
+
+  // Ordered by id, which is the order of the requests.
+  std::map<uint32_t, IdleCallback> idle_callbacks_;
+  uint32_t next_idle_callback_id_;
+
   std::vector<v8::Global<v8::Promise::Resolver>> pending_promises_;
+  std::shared_ptr<BackgroundCompletions> background_completions_;
 
-  v8::Global<v8::Function> canvas_rendering_context_2d_constructor_;
-  v8::Global<v8::Function> canvas_gradient_constructor_;
-  v8::Global<v8::Function> canvas_pattern_constructor_;
-  v8::Global<v8::Function> image_data_constructor_;
-  v8::Global<v8::Function> image_bitmap_constructor_;
-  v8::Global<v8::Function> path2d_constructor_;
-  v8::Global<v8::Function> process_constructor_;
+  std::array<v8::Global<v8::Function>,
+             static_cast<int>(Constructor::LAST_CONSTRUCTOR)>
+      constructors_;
 
   v8::Global<v8::Array> window_icon_;
   v8::Global<v8::Value> window_cursor_;
@@ -251,9 +492,24 @@ class JsApi final {
   GLFWcursor* cursor_;
 
   std::unordered_map<std::string, sk_sp<SkTypeface>> fonts_;
-  std::unordered_map<std::string, sk_sp<SkTypeface>> fonts_cache_;
+
+  // The last strings passed to ParseCSSColor() and ParseCSSFont(), indexed by
+  // their hash. String literals are the same v8::String on every call.
+  template <typename T>
+  struct InternedCSSString {
+    v8::Global<v8::String> string;
+    T value;
+  };
+  static constexpr size_t kInternedCSSStrings = 64;
+  std::array<InternedCSSString<CSSCache::Color>, kInternedCSSStrings>
+      interned_css_colors_;
+  std::array<InternedCSSString<CSSCache::Font>, kInternedCSSStrings>
+      interned_css_fonts_;
+  CSSCache css_cache_;
 
   ProcessApi* parent_process_;
+
+  std::unordered_set<WorkerApi*> workers_;
 };
 
 // All API objects that wrap a C++ native object must extend this class,
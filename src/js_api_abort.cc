@@ -0,0 +1,284 @@
+#include "js_api_abort.h"
+
+#include <algorithm>
+
+#include "fail.h"
+
+namespace {
+
+void AbortSignal(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  if (!info.IsConstructCall()) {
+    info.GetIsolate()->ThrowError("AbortSignal is a constructor");
+    return;
+  }
+
+  JsApi* api = JsApi::Get(info.GetIsolate());
+
+  // AbortSignals are only created internally, which passes an External.
+  if (info.Length() != 1 || !info[0]->IsExternal()) {
+    api->js()->ThrowIllegalConstructor();
+    return;
+  }
+
+  v8::Local<v8::Object> thiz = info.This();
+  new AbortSignalApi(api, thiz);
+}
+
+void AbortController(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  if (!info.IsConstructCall()) {
+    info.GetIsolate()->ThrowError("AbortController is a constructor");
+    return;
+  }
+
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  JsScope scope(api->js());
+  v8::Local<v8::Object> signal = AbortSignalApi::Create(api, scope);
+  v8::Local<v8::Object> thiz = info.This();
+  new AbortControllerApi(api, thiz, signal);
+}
+
+}  // namespace
+
+AbortSignalApi::AbortSignalApi(JsApi* api, v8::Local<v8::Object> thiz)
+    : JsApiWrapper(api->isolate(), thiz), aborted_(false) {}
+
+AbortSignalApi::~AbortSignalApi() {}
+
+void AbortSignalApi::Abort(v8::Local<v8::Value> reason,
+                           const JsScope& scope) {
+  ASSERT(IsJsThread());
+  if (aborted_) {
+    return;
+  }
+
+  aborted_ = true;
+  if (reason->IsUndefined()) {
+    reason = MakeAbortError(scope);
+  }
+  reason_.Reset(scope.isolate, reason);
+
+  std::vector<PendingAlgorithm> algorithms;
+  algorithms.swap(algorithms_);
+  for (PendingAlgorithm& pending : algorithms) {
+    if (!pending.cancelled->IsCancelled()) {
+      pending.cancelled->Cancel();
+      pending.algorithm(reason, scope);
+    }
+  }
+
+  if (events_.HasListeners(JsEventType::ABORT)) {
+    v8::TryCatch try_catch(scope.isolate);
+    events_.Dispatch(JsEventType::ABORT, MakeEvent(StringId::abort, scope),
+                     scope);
+    if (try_catch.HasCaught()) {
+      js()->ReportException(try_catch.Message());
+    }
+  }
+}
+
+std::shared_ptr<CancelFlag> AbortSignalApi::AddAbortAlgorithm(
+    AbortAlgorithm algorithm) {
+  ASSERT(IsJsThread());
+  ASSERT(!aborted_);
+
+  // Drop the algorithms whose work has already finished, so that signals
+  // that are reused for many requests don't keep growing.
+  algorithms_.erase(
+      std::remove_if(algorithms_.begin(), algorithms_.end(),
+                     [](const PendingAlgorithm& pending) {
+                       return pending.cancelled->IsCancelled();
+                     }),
+      algorithms_.end());
+
+  auto cancelled = std::make_shared<CancelFlag>();
+  algorithms_.push_back({cancelled, std::move(algorithm)});
+  return cancelled;
+}
+
+// static
+v8::Local<v8::Function> AbortSignalApi::GetConstructor(
+    const JsScope& scope) {
+  v8::Local<v8::FunctionTemplate> signal =
+      scope.NewFunctionTemplate(AbortSignal);
+  signal->SetClassName(scope.GetConstantString(StringId::AbortSignal));
+
+  v8::Local<v8::ObjectTemplate> instance = signal->InstanceTemplate();
+  // Used in JsApiWrapper to track this.
+  instance->SetInternalFieldCount(1);
+
+  scope.Set(signal, StringId::abort, StaticAbort);
+
+  v8::Local<v8::ObjectTemplate> prototype = signal->PrototypeTemplate();
+
+  scope.Set(prototype, StringId::aborted, GetAborted);
+  scope.Set(prototype, StringId::reason, GetReason);
+  scope.Set(prototype, StringId::throwIfAborted, ThrowIfAborted);
+  scope.Set(prototype, StringId::addEventListener, AddEventListener);
+  scope.Set(prototype, StringId::removeEventListener, RemoveEventListener);
+
+  return signal->GetFunction(scope.context).ToLocalChecked();
+}
+
+// static
+void AbortSignalApi::AddExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {AbortSignal, StaticAbort, GetAborted,
+                                   GetReason, ThrowIfAborted, AddEventListener,
+                                   RemoveEventListener});
+}
+
+// static
+v8::Local<v8::Object> AbortSignalApi::Create(JsApi* api,
+                                             const JsScope& scope) {
+  v8::Local<v8::Value> args[] = {
+      v8::External::New(scope.isolate, nullptr),
+  };
+  return api->GetAbortSignalConstructor()
+      ->NewInstance(scope.context, 1, args)
+      .ToLocalChecked();
+}
+
+// static
+v8::Local<v8::Value> AbortSignalApi::MakeAbortError(const JsScope& scope) {
+  v8::Local<v8::Object> error =
+      v8::Exception::Error(scope.MakeString("The operation was aborted."))
+          .As<v8::Object>();
+  scope.Set(error, StringId::name, StringId::AbortError);
+  return error;
+}
+
+// static
+void AbortSignalApi::GetAborted(
+    v8::Local<v8::String> property,
+    const v8::PropertyCallbackInfo<v8::Value>& info) {
+  AbortSignalApi* signal =
+      JsApi::Get(info.GetIsolate())->GetAbortSignalApi(info.This());
+  if (signal) {
+    info.GetReturnValue().Set(signal->aborted());
+  }
+}
+
+// static
+void AbortSignalApi::GetReason(
+    v8::Local<v8::String> property,
+    const v8::PropertyCallbackInfo<v8::Value>& info) {
+  AbortSignalApi* signal =
+      JsApi::Get(info.GetIsolate())->GetAbortSignalApi(info.This());
+  if (signal && signal->aborted()) {
+    info.GetReturnValue().Set(signal->reason());
+  }
+}
+
+// static
+void AbortSignalApi::ThrowIfAborted(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  AbortSignalApi* signal =
+      JsApi::Get(info.GetIsolate())->GetAbortSignalApi(info.This());
+  if (signal && signal->aborted()) {
+    info.GetIsolate()->ThrowException(signal->reason());
+  }
+}
+
+// static
+void AbortSignalApi::AddEventListener(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* api = JsApi::Get(info.GetIsolate());
+
+  if (info.Length() < 2 || !info[0]->IsString() || !info[1]->IsFunction()) {
+    api->js()->ThrowError(
+        "addEventListener requires an event type and a callback function");
+    return;
+  }
+
+  std::string type = api->js()->ToString(info[0]);
+  v8::Local<v8::Function> f = info[1].As<v8::Function>();
+
+  AbortSignalApi* signal = api->GetAbortSignalApi(info.This());
+  if (signal) {
+    signal->events_.AddEventListener(type, f, info.GetIsolate());
+  }
+}
+
+// static
+void AbortSignalApi::RemoveEventListener(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* api = JsApi::Get(info.GetIsolate());
+
+  if (info.Length() < 2 || !info[0]->IsString() || !info[1]->IsFunction()) {
+    api->js()->ThrowError(
+        "removeEventListener requires an event type and a callback function");
+    return;
+  }
+
+  std::string type = api->js()->ToString(info[0]);
+  v8::Local<v8::Function> f = info[1].As<v8::Function>();
+
+  AbortSignalApi* signal = api->GetAbortSignalApi(info.This());
+  if (signal) {
+    signal->events_.RemoveEventListener(type, f);
+  }
+}
+
+// static
+void AbortSignalApi::StaticAbort(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  JsScope scope(api->js());
+  v8::Local<v8::Object> object = Create(api, scope);
+  AbortSignalApi* signal = api->GetAbortSignalApi(object);
+  signal->Abort(info[0], scope);
+  info.GetReturnValue().Set(object);
+}
+
+AbortControllerApi::AbortControllerApi(JsApi* api, v8::Local<v8::Object> thiz,
+                                       v8::Local<v8::Object> signal)
+    : JsApiWrapper(api->isolate(), thiz), signal_(api->isolate(), signal) {}
+
+AbortControllerApi::~AbortControllerApi() {}
+
+// static
+v8::Local<v8::Function> AbortControllerApi::GetConstructor(
+    const JsScope& scope) {
+  v8::Local<v8::FunctionTemplate> controller =
+      scope.NewFunctionTemplate(AbortController);
+  controller->SetClassName(scope.GetConstantString(StringId::AbortController));
+
+  v8::Local<v8::ObjectTemplate> instance = controller->InstanceTemplate();
+  // Used in JsApiWrapper to track this.
+  instance->SetInternalFieldCount(1);
+
+  v8::Local<v8::ObjectTemplate> prototype = controller->PrototypeTemplate();
+
+  scope.Set(prototype, StringId::signal, GetSignal);
+  scope.Set(prototype, StringId::abort, Abort);
+
+  return controller->GetFunction(scope.context).ToLocalChecked();
+}
+
+// static
+void AbortControllerApi::AddExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {AbortController, GetSignal, Abort});
+}
+
+// static
+void AbortControllerApi::GetSignal(
+    v8::Local<v8::String> property,
+    const v8::PropertyCallbackInfo<v8::Value>& info) {
+  AbortControllerApi* controller =
+      JsApi::Get(info.GetIsolate())->GetAbortControllerApi(info.This());
+  if (controller) {
+    info.GetReturnValue().Set(controller->signal_.Get(info.GetIsolate()));
+  }
+}
+
+// static
+void AbortControllerApi::Abort(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  AbortControllerApi* controller = api->GetAbortControllerApi(info.This());
+  if (controller) {
+    JsScope scope(api->js());
+    AbortSignalApi* signal =
+        api->GetAbortSignalApi(controller->signal_.Get(scope.isolate));
+    signal->Abort(info[0], scope);
+  }
+}
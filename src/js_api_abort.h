@@ -0,0 +1,83 @@
+#ifndef WINDOWJS_JS_API_ABORT_H
+#define WINDOWJS_JS_API_ABORT_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <v8/include/v8.h>
+
+#include "js_api.h"
+#include "js_events.h"
+#include "js_scope.h"
+#include "thread.h"
+
+class AbortSignalApi final : public JsApiWrapper {
+ public:
+  using AbortAlgorithm =
+      std::function<void(v8::Local<v8::Value> reason, const JsScope& scope)>;
+
+  AbortSignalApi(JsApi* api, v8::Local<v8::Object> thiz);
+  ~AbortSignalApi() override;
+
+  bool aborted() const { return aborted_; }
+  v8::Local<v8::Value> reason() const { return reason_.Get(isolate()); }
+
+  // Aborts this signal, if it isn't aborted yet. An undefined "reason"
+  // becomes an AbortError.
+  void Abort(v8::Local<v8::Value> reason, const JsScope& scope);
+
+  // Returns a flag that gets cancelled when this signal is aborted, right
+  // before "algorithm" gets called in the main thread. "algorithm" is dropped
+  // if the flag gets cancelled by someone else first.
+  std::shared_ptr<CancelFlag> AddAbortAlgorithm(AbortAlgorithm algorithm);
+
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
+
+  // Returns a new AbortSignal. Scripts can't call the constructor directly.
+  static v8::Local<v8::Object> Create(JsApi* api, const JsScope& scope);
+
+  // Returns an Error whose name is "AbortError".
+  static v8::Local<v8::Value> MakeAbortError(const JsScope& scope);
+
+ private:
+  static void GetAborted(v8::Local<v8::String> property,
+                         const v8::PropertyCallbackInfo<v8::Value>& info);
+  static void GetReason(v8::Local<v8::String> property,
+                        const v8::PropertyCallbackInfo<v8::Value>& info);
+  static void ThrowIfAborted(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void AddEventListener(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void RemoveEventListener(
+      const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void StaticAbort(const v8::FunctionCallbackInfo<v8::Value>& info);
+
+  struct PendingAlgorithm {
+    std::shared_ptr<CancelFlag> cancelled;
+    AbortAlgorithm algorithm;
+  };
+
+  bool aborted_;
+  v8::Global<v8::Value> reason_;
+  std::vector<PendingAlgorithm> algorithms_;
+  JsEvents events_;
+};
+
+class AbortControllerApi final : public JsApiWrapper {
+ public:
+  AbortControllerApi(JsApi* api, v8::Local<v8::Object> thiz,
+                     v8::Local<v8::Object> signal);
+  ~AbortControllerApi() override;
+
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
+
+ private:
+  static void GetSignal(v8::Local<v8::String> property,
+                        const v8::PropertyCallbackInfo<v8::Value>& info);
+  static void Abort(const v8::FunctionCallbackInfo<v8::Value>& info);
+
+  v8::Global<v8::Object> signal_;
+};
+
+#endif  // WINDOWJS_JS_API_ABORT_H
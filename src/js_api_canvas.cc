@@ -1,5 +1,7 @@
 #include "js_api_canvas.h"
 
+#include <algorithm>
+#include <limits>
 #include <unordered_map>
 
 #include <skia/include/core/SkEncodedImageFormat.h>
@@ -7,6 +9,9 @@
 #include <skia/include/core/SkFontMgr.h>
 #include <skia/include/core/SkPathEffect.h>
 #include <skia/include/core/SkPathUtils.h>
+#include <skia/include/core/SkRSXform.h>
+#include <skia/include/core/SkSurface.h>
+#include <skia/include/core/SkVertices.h>
 #include <skia/include/effects/SkDashPathEffect.h>
 #include <skia/include/effects/SkGradientShader.h>
 #include <skia/include/effects/SkImageFilters.h>
@@ -15,6 +20,7 @@
 #include "console.h"
 #include "css.h"
 #include "fail.h"
+#include "js_api_abort.h"
 #include "js_strings.h"
 #include "thread.h"
 
@@ -56,6 +62,24 @@ void CanvasPattern(const v8::FunctionCallbackInfo<v8::Value>& info) {
   new CanvasPatternApi(api, thiz, info);
 }
 
+// CanvasPictures are only made by endRecording(), which passes the picture.
+void CanvasPicture(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  if (!info.IsConstructCall()) {
+    info.GetIsolate()->ThrowError("CanvasPicture is a constructor");
+    return;
+  }
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  if (info.Length() < 1 || !info[0]->IsExternal()) {
+    api->js()->ThrowError(
+        "CanvasPictures are made by CanvasRenderingContext2D.endRecording");
+    return;
+  }
+  sk_sp<SkPicture> picture(
+      static_cast<SkPicture*>(info[0].As<v8::External>()->Value()));
+  v8::Local<v8::Object> thiz = info.This();
+  new CanvasPictureApi(api, thiz, std::move(picture));
+}
+
 void ImageData(const v8::FunctionCallbackInfo<v8::Value>& info) {
   if (!info.IsConstructCall()) {
     info.GetIsolate()->ThrowError("ImageData is a constructor");
@@ -235,6 +259,42 @@ void Path2D(const v8::FunctionCallbackInfo<v8::Value>& info) {
   new Path2DApi(api, thiz, path);
 }
 
+// The sources of drawImage() keep one of these tags in their second internal
+// field, so that its fast path can check their type without handles.
+struct ImageSourceTag {
+  const char* name;
+};
+
+ImageSourceTag kImageBitmapTag = {"ImageBitmap"};
+ImageSourceTag kCanvasTag = {"CanvasRenderingContext2D"};
+
+// Returns the image to draw for a drawImage() source, or null if "value" isn't
+// an ImageBitmap nor a CanvasRenderingContext2D.
+sk_sp<SkImage> GetImageSource(v8::Local<v8::Value> value) {
+  if (!value->IsObject()) {
+    return nullptr;
+  }
+  v8::Local<v8::Object> object = value.As<v8::Object>();
+  if (object->InternalFieldCount() != 2) {
+    return nullptr;
+  }
+  // The wrapper is set in JsApiWrapper::JsApiWrapper.
+  void* tag = object->GetAlignedPointerFromInternalField(1);
+  JsApiWrapper* wrapper = static_cast<JsApiWrapper*>(
+      object->GetAlignedPointerFromInternalField(0));
+  if (tag == &kImageBitmapTag) {
+    return static_cast<ImageBitmapApi*>(wrapper)->texture();
+  } else if (tag == &kCanvasTag) {
+    sk_sp<SkImage> image = static_cast<CanvasRenderingContext2DApi*>(wrapper)
+                               ->canvas()
+                               ->MakeImageSnapshot();
+    ASSERT(image->isTextureBacked());
+    return image;
+  } else {
+    return nullptr;
+  }
+}
+
 void UnrefData(void* ptr, size_t length, void* data) {
   static_cast<SkData*>(data)->unref();
 }
@@ -256,12 +316,21 @@ v8::Local<v8::Promise> EncodeInBackground(
     }
   }
 
-  return api->PostToBackgroundAndResolve([=]() {
-    sk_sp<SkData> data = image->encodeToData(format, quality);
-    ASSERT(data);
-    data->ref();
-    return
-        [=](JsApi* api, const JsScope& scope, v8::Promise::Resolver* resolver) {
+  AbortSignalApi* signal;
+  if (!api->GetAbortSignalOption(info[2], &signal)) {
+    return {};
+  }
+
+  return api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::CPU, signal,
+      [=](const CancelFlag&) -> JsApi::ResolveFunction {
+        sk_sp<SkData> data = image->encodeToData(format, quality);
+        ASSERT(data);
+        return [=](JsApi* api, const JsScope& scope,
+                   v8::Promise::Resolver* resolver) {
+          // Released by UnrefData. This is only done here so that the data
+          // doesn't leak if the resolve function gets dropped.
+          data->ref();
           std::unique_ptr<v8::BackingStore> store =
               v8::ArrayBuffer::NewBackingStore(
                   (void*) data->data(), data->size(), UnrefData, data.get());
@@ -269,7 +338,7 @@ v8::Local<v8::Promise> EncodeInBackground(
               v8::ArrayBuffer::New(api->isolate(), std::move(store));
           IGNORE_RESULT(resolver->Resolve(scope.context, buffer));
         };
-  });
+      });
 }
 
 sk_sp<SkData> PrepareToDecode(JsApi* api,
@@ -327,19 +396,112 @@ bool ParseDOMMatrix(const v8::FunctionCallbackInfo<v8::Value>& info,
   return true;
 }
 
+// The arguments of fillRects(), strokeRects(), fillCircles() and drawAtlas().
+struct BulkArguments {
+  const float* geometry = nullptr;
+  // Optional. One 0xRRGGBBAA color per item, like the CSS #rrggbbaa notation.
+  const uint32_t* colors = nullptr;
+  size_t count = 0;
+};
+
+template <typename T>
+const T* GetTypedArrayData(v8::Local<v8::TypedArray> array) {
+  const char* data =
+      static_cast<const char*>(array->Buffer()->GetBackingStore()->Data());
+  return reinterpret_cast<const T*>(data + array->ByteOffset());
+}
+
+// Reads the Float32Array at "geometry_index", with "components" numbers per
+// item, and the optional Uint32Array at "colors_index" with a color per item.
+// Throws if they are invalid.
+bool GetBulkArguments(const v8::FunctionCallbackInfo<v8::Value>& info,
+                      JsApi* api, int geometry_index, int colors_index,
+                      size_t components, BulkArguments* args) {
+  if (info.Length() <= geometry_index ||
+      !info[geometry_index]->IsFloat32Array()) {
+    api->js()->ThrowInvalidArgument();
+    return false;
+  }
+  v8::Local<v8::Float32Array> geometry =
+      info[geometry_index].As<v8::Float32Array>();
+  args->count = geometry->Length() / components;
+  if (args->count > static_cast<size_t>(std::numeric_limits<int>::max()) / 6) {
+    api->js()->ThrowError("Too many items");
+    return false;
+  }
+  args->geometry = GetTypedArrayData<float>(geometry);
+
+  if (info.Length() > colors_index && !info[colors_index]->IsUndefined()) {
+    if (!info[colors_index]->IsUint32Array()) {
+      api->js()->ThrowInvalidArgument();
+      return false;
+    }
+    v8::Local<v8::Uint32Array> colors =
+        info[colors_index].As<v8::Uint32Array>();
+    if (colors->Length() < args->count) {
+      api->js()->ThrowError("Not enough colors");
+      return false;
+    }
+    args->colors = GetTypedArrayData<uint32_t>(colors);
+  }
+  return true;
+}
+
+SkColor ApplyGlobalAlpha(SkColor color, float global_alpha) {
+  float alpha = SkColorGetA(color) * std::clamp(global_alpha, 0.0f, 1.0f);
+  return SkColorSetA(color, static_cast<U8CPU>(alpha + 0.5f));
+}
+
+SkColor RGBAToSkColor(uint32_t rgba, float global_alpha) {
+  return ApplyGlobalAlpha(SkColorSetARGB(rgba & 0xff, rgba >> 24,
+                                         (rgba >> 16) & 0xff,
+                                         (rgba >> 8) & 0xff),
+                          global_alpha);
+}
+
+// Number of distinct texts and fonts drawn with fillText() and strokeText()
+// that each canvas keeps ready to draw.
+constexpr size_t kTextBlobCacheSize = 256;
+
+// fillCircles() draws scaled copies of this sprite, for circles that aren't
+// larger than it on the screen.
+constexpr int kCircleSpriteSize = 256;
+constexpr float kCircleSpriteRadius = 126;
+
+SkImage* GetCircleSprite() {
+  // Raster images are uploaded once and then cached by the GPU context.
+  static SkImage* sprite = [] {
+    sk_sp<SkSurface> surface =
+        SkSurface::MakeRasterN32Premul(kCircleSpriteSize, kCircleSpriteSize);
+    ASSERT(surface);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(SK_ColorWHITE);
+    surface->getCanvas()->drawCircle(kCircleSpriteSize / 2.0f,
+                                     kCircleSpriteSize / 2.0f,
+                                     kCircleSpriteRadius, paint);
+    return surface->makeImageSnapshot()->withDefaultMipmaps().release();
+  }();
+  return sprite;
+}
+
 }  // namespace
 
 CanvasRenderingContext2DApi::CanvasRenderingContext2DApi(
     JsApi* api, v8::Local<v8::Object> thiz, int width, int height)
     : JsApiWrapper(api->isolate(), thiz),
       canvas_(new Canvas(api->canvas_shared_context(), width, height,
-                         Canvas::TEXTURE)) {
+                         Canvas::TEXTURE)),
+      recording_saves_(0),
+      text_cache_(kTextBlobCacheSize) {
   // Each Canvas has an offscreen texture with 4 bytes per pixel.
   // Tell v8 about the external size used to inform GC.
   // Note that this class ignores resizes to the Canvas.
   allocated_in_bytes_ = 4 * canvas_->width() * canvas_->height();
   api->isolate()->AdjustAmountOfExternalAllocatedMemory(allocated_in_bytes_);
 
+  thiz->SetAlignedPointerInInternalField(1, &kCanvasTag);
+
   state_.fill_paint.setStyle(SkPaint::kFill_Style);
   state_.fill_paint.setAntiAlias(true);
   state_.fill_color = SK_ColorBLACK;
@@ -378,16 +540,21 @@ CanvasRenderingContext2DApi::~CanvasRenderingContext2DApi() {
 
 // static
 v8::Local<v8::Function> CanvasRenderingContext2DApi::GetConstructor(
-    JsApi* api, const JsScope& scope) {
+    const JsScope& scope) {
   v8::Local<v8::FunctionTemplate> canvas_rendering_context_2d =
-      v8::FunctionTemplate::New(scope.isolate, CanvasRenderingContext2D);
+      scope.NewFunctionTemplate(CanvasRenderingContext2D);
   canvas_rendering_context_2d->SetClassName(
       scope.GetConstantString(StringId::CanvasRenderingContext2D));
 
   v8::Local<v8::ObjectTemplate> instance =
       canvas_rendering_context_2d->InstanceTemplate();
-  // Used in JsApiWrapper to track this.
-  instance->SetInternalFieldCount(1);
+  // Used in JsApiWrapper to track this, and for the tag of drawImage()
+  // sources.
+  instance->SetInternalFieldCount(2);
+
+  // The Fast API methods require a receiver made from this template.
+  v8::Local<v8::Signature> signature =
+      v8::Signature::New(scope.isolate, canvas_rendering_context_2d);
 
   v8::Local<v8::ObjectTemplate> prototype =
       canvas_rendering_context_2d->PrototypeTemplate();
@@ -422,9 +589,12 @@ v8::Local<v8::Function> CanvasRenderingContext2DApi::GetConstructor(
             SetImageSmoothingQuality);
 
   // Functions.
-  scope.Set(prototype, StringId::clearRect, ClearRect);
-  scope.Set(prototype, StringId::fillRect, FillRect);
-  scope.Set(prototype, StringId::strokeRect, StrokeRect);
+  scope.Set(prototype, StringId::clearRect, signature, ClearRect,
+            {v8::CFunction::Make(FastClearRect)});
+  scope.Set(prototype, StringId::fillRect, signature, FillRect,
+            {v8::CFunction::Make(FastFillRect)});
+  scope.Set(prototype, StringId::strokeRect, signature, StrokeRect,
+            {v8::CFunction::Make(FastStrokeRect)});
   scope.Set(prototype, StringId::fillText, FillText);
   scope.Set(prototype, StringId::strokeText, StrokeText);
   scope.Set(prototype, StringId::measureText, MeasureText);
@@ -432,11 +602,14 @@ v8::Local<v8::Function> CanvasRenderingContext2DApi::GetConstructor(
   scope.Set(prototype, StringId::setLineDash, SetLineDash);
   scope.Set(prototype, StringId::beginPath, BeginPath);
   scope.Set(prototype, StringId::closePath, ClosePath);
-  scope.Set(prototype, StringId::moveTo, MoveTo);
-  scope.Set(prototype, StringId::lineTo, LineTo);
+  scope.Set(prototype, StringId::moveTo, signature, MoveTo,
+            {v8::CFunction::Make(FastMoveTo)});
+  scope.Set(prototype, StringId::lineTo, signature, LineTo,
+            {v8::CFunction::Make(FastLineTo)});
   scope.Set(prototype, StringId::bezierCurveTo, BezierCurveTo);
   scope.Set(prototype, StringId::quadraticCurveTo, QuadraticCurveTo);
-  scope.Set(prototype, StringId::arc, Arc);
+  scope.Set(prototype, StringId::arc, signature, Arc,
+            {v8::CFunction::Make(FastArc)});
   scope.Set(prototype, StringId::arcTo, ArcTo);
   scope.Set(prototype, StringId::ellipse, Ellipse);
   scope.Set(prototype, StringId::rect, Rect);
@@ -447,13 +620,23 @@ v8::Local<v8::Function> CanvasRenderingContext2DApi::GetConstructor(
   scope.Set(prototype, StringId::isPointInStroke, IsPointInStroke);
   scope.Set(prototype, StringId::rotate, Rotate);
   scope.Set(prototype, StringId::scale, Scale);
-  scope.Set(prototype, StringId::translate, Translate);
+  scope.Set(prototype, StringId::translate, signature, Translate,
+            {v8::CFunction::Make(FastTranslate)});
   scope.Set(prototype, StringId::transform, Transform);
   scope.Set(prototype, StringId::getTransform, GetTransform);
   scope.Set(prototype, StringId::setTransform, SetTransform);
   scope.Set(prototype, StringId::resetTransform, ResetTransform);
-  scope.Set(prototype, StringId::save, Save);
-  scope.Set(prototype, StringId::restore, Restore);
+  scope.Set(prototype, StringId::save, signature, Save,
+            {v8::CFunction::Make(FastSave)});
+  scope.Set(prototype, StringId::restore, signature, Restore,
+            {v8::CFunction::Make(FastRestore)});
+  scope.Set(prototype, StringId::beginRecording, BeginRecording);
+  scope.Set(prototype, StringId::endRecording, EndRecording);
+  scope.Set(prototype, StringId::drawPicture, DrawPicture);
+  scope.Set(prototype, StringId::fillRects, FillRects);
+  scope.Set(prototype, StringId::strokeRects, StrokeRects);
+  scope.Set(prototype, StringId::fillCircles, FillCircles);
+  scope.Set(prototype, StringId::drawAtlas, DrawAtlas);
   scope.Set(prototype, StringId::createLinearGradient, CreateLinearGradient);
   scope.Set(prototype, StringId::createRadialGradient, CreateRadialGradient);
   scope.Set(prototype, StringId::createPattern, CreatePattern);
@@ -461,12 +644,72 @@ v8::Local<v8::Function> CanvasRenderingContext2DApi::GetConstructor(
   scope.Set(prototype, StringId::getImageData, GetImageData);
   scope.Set(prototype, StringId::putImageData, PutImageData);
   scope.Set(prototype, StringId::encode, Encode);
-  scope.Set(prototype, StringId::drawImage, DrawImage);
+  scope.Set(prototype, StringId::drawImage, signature, DrawImage,
+            {v8::CFunction::Make(FastDrawImage),
+             v8::CFunction::Make(FastDrawImageScaled),
+             v8::CFunction::Make(FastDrawImageRect)});
 
   return canvas_rendering_context_2d->GetFunction(scope.context)
       .ToLocalChecked();
 }
 
+// static
+void CanvasRenderingContext2DApi::AddExternalReferences(
+    std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {CanvasRenderingContext2D, GetWidth, SetWidth,
+                                   GetHeight, SetHeight, GetFillStyle,
+                                   SetFillStyle, GetStrokeStyle, SetStrokeStyle,
+                                   GetFont, SetFont, GetLineWidth, SetLineWidth,
+                                   GetLineCap, SetLineCap, GetLineJoin,
+                                   SetLineJoin, GetMiterLimit, SetMiterLimit,
+                                   GetLineDashOffset, SetLineDashOffset,
+                                   GetTextAlign, SetTextAlign, GetTextBaseline,
+                                   SetTextBaseline, GetGlobalAlpha,
+                                   SetGlobalAlpha, GetGlobalCompositeOperation,
+                                   SetGlobalCompositeOperation, GetShadowBlur,
+                                   SetShadowBlur, GetShadowColor,
+                                   SetShadowColor, GetShadowOffsetX,
+                                   SetShadowOffsetX, GetShadowOffsetY,
+                                   SetShadowOffsetY, GetAntiAlias, SetAntiAlias,
+                                   GetImageSmoothingEnabled,
+                                   SetImageSmoothingEnabled,
+                                   GetImageSmoothingQuality,
+                                   SetImageSmoothingQuality, ClearRect,
+                                   FillRect, StrokeRect, FillText, StrokeText,
+                                   MeasureText, GetLineDash, SetLineDash,
+                                   BeginPath, ClosePath, MoveTo, LineTo,
+                                   BezierCurveTo, QuadraticCurveTo, Arc, ArcTo,
+                                   Ellipse, Rect, Fill, Stroke, Clip,
+                                   IsPointInPath, IsPointInStroke, Rotate,
+                                   Scale, Translate, Transform, GetTransform,
+                                   SetTransform, ResetTransform, Save, Restore,
+                                   BeginRecording, EndRecording, DrawPicture,
+                                   FillRects, StrokeRects, FillCircles,
+                                   DrawAtlas,
+                                   CreateLinearGradient, CreateRadialGradient,
+                                   CreatePattern, CreateImageData, GetImageData,
+                                   PutImageData, Encode, DrawImage});
+  AppendExternalReferences(
+      refs, {v8::CFunction::Make(FastClearRect),
+             v8::CFunction::Make(FastFillRect),
+             v8::CFunction::Make(FastStrokeRect),
+             v8::CFunction::Make(FastMoveTo), v8::CFunction::Make(FastLineTo),
+             v8::CFunction::Make(FastArc), v8::CFunction::Make(FastTranslate),
+             v8::CFunction::Make(FastSave), v8::CFunction::Make(FastRestore),
+             v8::CFunction::Make(FastDrawImage),
+             v8::CFunction::Make(FastDrawImageScaled),
+             v8::CFunction::Make(FastDrawImageRect)});
+}
+
+// static
+CanvasRenderingContext2DApi* CanvasRenderingContext2DApi::FromReceiver(
+    v8::Local<v8::Object> receiver) {
+  // v8 checks the receiver against the signature before calling the fast
+  // methods. The wrapper is set in JsApiWrapper::JsApiWrapper.
+  return static_cast<CanvasRenderingContext2DApi*>(static_cast<JsApiWrapper*>(
+      receiver->GetAlignedPointerFromInternalField(0)));
+}
+
 // static
 void CanvasRenderingContext2DApi::GetWidth(
     v8::Local<v8::String> property,
@@ -547,7 +790,8 @@ void CanvasRenderingContext2DApi::GetFillStyle(
       JsApi::Get(info.GetIsolate())
           ->GetCanvasRenderingContext2DApi(info.This());
   if (api) {
-    std::string color = SkColorToCSSColor(api->state_.fill_color);
+    const std::string& color =
+        api->api()->css_cache()->GetColorString(api->state_.fill_color);
     info.GetReturnValue().Set(api->js()->MakeString(color));
   }
 }
@@ -564,9 +808,9 @@ void CanvasRenderingContext2DApi::SetFillStyle(
   }
 
   if (value->IsString()) {
-    std::string s = api->js()->ToString(value);
-    SkColor color;
-    if (CSSColorToSkColor(s, &color)) {
+    CSSCache::Color css = api->api()->ParseCSSColor(value.As<v8::String>());
+    if (css.valid) {
+      SkColor color = css.color;
       State& state = api->state_;
       state.ResetFillStyle();
       state.fill_color = color;
@@ -605,7 +849,8 @@ void CanvasRenderingContext2DApi::GetStrokeStyle(
   if (!api) {
     return;
   }
-  std::string color = SkColorToCSSColor(api->state_.stroke_color);
+  const std::string& color =
+      api->api()->css_cache()->GetColorString(api->state_.stroke_color);
   info.GetReturnValue().Set(api->js()->MakeString(color));
 }
 
@@ -620,9 +865,9 @@ void CanvasRenderingContext2DApi::SetStrokeStyle(
     return;
   }
   if (value->IsString()) {
-    std::string s = api->js()->ToString(value);
-    SkColor color;
-    if (CSSColorToSkColor(s, &color)) {
+    CSSCache::Color css = api->api()->ParseCSSColor(value.As<v8::String>());
+    if (css.valid) {
+      SkColor color = css.color;
       State& state = api->state_;
       state.ResetStrokeStyle();
       state.stroke_color = color;
@@ -693,6 +938,34 @@ void CanvasRenderingContext2DApi::StrokeRect(
   DrawRect(info, api->state_.stroke_paint, api);
 }
 
+// static
+void CanvasRenderingContext2DApi::FastClearRect(v8::Local<v8::Object> receiver,
+                                                double x, double y, double w,
+                                                double h) {
+  SkPaint paint;
+  paint.setColor(SK_ColorTRANSPARENT);
+  paint.setBlendMode(SkBlendMode::kSrc);
+  FromReceiver(receiver)->skia_canvas()->drawRect(
+      SkRect::MakeXYWH(x, y, w, h), paint);
+}
+
+// static
+void CanvasRenderingContext2DApi::FastFillRect(v8::Local<v8::Object> receiver,
+                                               double x, double y, double w,
+                                               double h) {
+  CanvasRenderingContext2DApi* api = FromReceiver(receiver);
+  api->skia_canvas()->drawRect(SkRect::MakeXYWH(x, y, w, h),
+                               api->state_.fill_paint);
+}
+
+// static
+void CanvasRenderingContext2DApi::FastStrokeRect(
+    v8::Local<v8::Object> receiver, double x, double y, double w, double h) {
+  CanvasRenderingContext2DApi* api = FromReceiver(receiver);
+  api->skia_canvas()->drawRect(SkRect::MakeXYWH(x, y, w, h),
+                               api->state_.stroke_paint);
+}
+
 // static
 void CanvasRenderingContext2DApi::GetFont(
     v8::Local<v8::String> property,
@@ -701,7 +974,8 @@ void CanvasRenderingContext2DApi::GetFont(
       JsApi::Get(info.GetIsolate())
           ->GetCanvasRenderingContext2DApi(info.This());
   if (api) {
-    std::string font = SkFontToCSSFont(api->state_.font);
+    const std::string& font =
+        api->api()->css_cache()->GetFontString(api->state_.font);
     info.GetReturnValue().Set(api->js()->MakeString(font));
   }
 }
@@ -717,9 +991,7 @@ void CanvasRenderingContext2DApi::SetFont(
       JsApi::Get(info.GetIsolate())
           ->GetCanvasRenderingContext2DApi(info.This());
   if (api) {
-    std::string font = api->js()->ToString(value);
-    CSSFontToSkFont(font, &api->state_.font, api->api()->fonts(),
-                    api->api()->fonts_cache());
+    api->api()->ParseCSSFont(value.As<v8::String>()).ApplyTo(&api->state_.font);
   }
 }
 
@@ -1210,7 +1482,8 @@ void CanvasRenderingContext2DApi::GetShadowColor(
       JsApi::Get(info.GetIsolate())
           ->GetCanvasRenderingContext2DApi(info.This());
   if (api) {
-    std::string color = SkColorToCSSColor(api->state_.shadow_color);
+    const std::string& color =
+        api->api()->css_cache()->GetColorString(api->state_.shadow_color);
     info.GetReturnValue().Set(api->js()->MakeString(color));
   }
 }
@@ -1225,14 +1498,13 @@ void CanvasRenderingContext2DApi::SetShadowColor(
   if (!api || !value->IsString()) {
     return;
   }
-  std::string css = api->js()->ToString(value);
-  SkColor color;
-  if (!CSSColorToSkColor(css, &color)) {
+  CSSCache::Color css = api->api()->ParseCSSColor(value.As<v8::String>());
+  if (!css.valid) {
     return;
   }
   State& state = api->state_;
-  if (color != state.shadow_color) {
-    state.shadow_color = color;
+  if (css.color != state.shadow_color) {
+    state.shadow_color = css.color;
     api->UpdateShadow();
   }
 }
@@ -1434,27 +1706,33 @@ void CanvasRenderingContext2DApi::DrawText(
     return;
   }
 
-  std::string text = api->js()->ToString(info[0]);
   double x = info[1].As<v8::Number>()->Value();
   double y = info[2].As<v8::Number>()->Value();
 
   State& state = api->state_;
-  if (state.text_align == StringId::center ||
-      state.text_align == StringId::right ||
-      state.text_align == StringId::end) {
-    SkRect bounds = SkRect::MakeEmpty();
-    float advance = state.font.measureText(
-        text.c_str(), text.size(), SkTextEncoding::kUTF8, &bounds, &paint);
-    if (state.text_align == StringId::center) {
-      x -= advance / 2;
-    } else {
-      x -= advance;
-    }
+  v8::Local<v8::String> string = info[0].As<v8::String>();
+  InternedText& interned =
+      api->interned_texts_[static_cast<unsigned>(string->GetIdentityHash()) %
+                           kInternedTexts];
+  if (interned.string != string || interned.font != state.font) {
+    interned.text =
+        api->text_cache_.GetText(api->js()->ToString(string), state.font);
+    interned.font = state.font;
+    interned.string.Reset(info.GetIsolate(), string);
+  } else {
+    TextBlobCache::CountHit();
+  }
+  const TextBlobCache::Text& text = interned.text;
+
+  if (state.text_align == StringId::center) {
+    x -= text.advance / 2;
+  } else if (state.text_align == StringId::right ||
+             state.text_align == StringId::end) {
+    x -= text.advance;
   }
 
   if (state.text_baseline != StringId::alphabetic) {
-    SkFontMetrics metrics;
-    state.font.getMetrics(&metrics);
+    const SkFontMetrics& metrics = api->text_cache_.GetMetrics(state.font);
     if (state.text_baseline == StringId::top ||
         state.text_baseline == StringId::hanging) {
       y += fabs(metrics.fCapHeight);
@@ -1466,9 +1744,9 @@ void CanvasRenderingContext2DApi::DrawText(
     }
   }
 
-  api->skia_canvas()->drawSimpleText(text.c_str(), text.size(),
-                                     SkTextEncoding::kUTF8, x, y, state.font,
-                                     paint);
+  if (text.blob) {
+    api->skia_canvas()->drawTextBlob(text.blob, x, y, paint);
+  }
 }
 
 // static
@@ -1562,6 +1840,20 @@ void CanvasRenderingContext2DApi::MoveTo(
   }
 }
 
+// static
+void CanvasRenderingContext2DApi::FastMoveTo(v8::Local<v8::Object> receiver,
+                                             double x, double y) {
+  FromReceiver(receiver)->path_.moveTo(x, y);
+}
+
+static void LineTo(SkPath* path, float x, float y) {
+  if (path->isEmpty() || path->isLastContourClosed()) {
+    path->moveTo(x, y);
+  } else {
+    path->lineTo(x, y);
+  }
+}
+
 static void LineTo(const v8::FunctionCallbackInfo<v8::Value>& info,
                    SkPath* path) {
   if (info.Length() < 2 || !info[0]->IsNumber() || !info[1]->IsNumber()) {
@@ -1570,11 +1862,7 @@ static void LineTo(const v8::FunctionCallbackInfo<v8::Value>& info,
   }
   float x = info[0].As<v8::Number>()->Value();
   float y = info[1].As<v8::Number>()->Value();
-  if (path->isEmpty() || path->isLastContourClosed()) {
-    path->moveTo(x, y);
-  } else {
-    path->lineTo(x, y);
-  }
+  LineTo(path, x, y);
 }
 
 // static
@@ -1588,6 +1876,12 @@ void CanvasRenderingContext2DApi::LineTo(
   }
 }
 
+// static
+void CanvasRenderingContext2DApi::FastLineTo(v8::Local<v8::Object> receiver,
+                                             double x, double y) {
+  ::LineTo(&FromReceiver(receiver)->path_, x, y);
+}
+
 static void BezierCurveTo(const v8::FunctionCallbackInfo<v8::Value>& info,
                           SkPath* path) {
   if (info.Length() < 6 || !info[0]->IsNumber() || !info[1]->IsNumber() ||
@@ -1661,6 +1955,14 @@ static float AdjustEndAngle(float start, float end, bool ccw) {
   }
 }
 
+static void Arc(SkPath* path, float x, float y, float r, float start,
+                float end, bool ccw) {
+  end = AdjustEndAngle(start, end, ccw);
+  float sweep = end - start;
+  SkRect oval = SkRect::MakeLTRB(x - r, y - r, x + r, y + r);
+  path->addArc(oval, RadiansToDegrees(start), RadiansToDegrees(sweep));
+}
+
 static void Arc(const v8::FunctionCallbackInfo<v8::Value>& info, SkPath* path) {
   if (info.Length() < 5 || !info[0]->IsNumber() || !info[1]->IsNumber() ||
       !info[2]->IsNumber() || !info[3]->IsNumber() || !info[4]->IsNumber()) {
@@ -1674,10 +1976,7 @@ static void Arc(const v8::FunctionCallbackInfo<v8::Value>& info, SkPath* path) {
   float end = info[4].As<v8::Number>()->Value();
   bool ccw = info.Length() >= 6 && info[5]->IsBoolean() &&
              info[5].As<v8::Boolean>()->Value();
-  end = AdjustEndAngle(start, end, ccw);
-  float sweep = end - start;
-  SkRect oval = SkRect::MakeLTRB(x - r, y - r, x + r, y + r);
-  path->addArc(oval, RadiansToDegrees(start), RadiansToDegrees(sweep));
+  Arc(path, x, y, r, start, end, ccw);
 }
 
 // static
@@ -1691,6 +1990,14 @@ void CanvasRenderingContext2DApi::Arc(
   }
 }
 
+// static
+void CanvasRenderingContext2DApi::FastArc(v8::Local<v8::Object> receiver,
+                                          double x, double y, double r,
+                                          double start, double end) {
+  // Calls with the "counterclockwise" argument take the slow path.
+  ::Arc(&FromReceiver(receiver)->path_, x, y, r, start, end, false);
+}
+
 static void ArcTo(const v8::FunctionCallbackInfo<v8::Value>& info,
                   SkPath* path) {
   if (info.Length() < 5 || !info[0]->IsNumber() || !info[1]->IsNumber() ||
@@ -1960,6 +2267,12 @@ void CanvasRenderingContext2DApi::Translate(
   api->skia_canvas()->translate(x, y);
 }
 
+// static
+void CanvasRenderingContext2DApi::FastTranslate(v8::Local<v8::Object> receiver,
+                                                double x, double y) {
+  FromReceiver(receiver)->skia_canvas()->translate(x, y);
+}
+
 // static
 void CanvasRenderingContext2DApi::Transform(
     const v8::FunctionCallbackInfo<v8::Value>& info) {
@@ -2058,13 +2371,376 @@ void CanvasRenderingContext2DApi::Restore(
   CanvasRenderingContext2DApi* api =
       JsApi::Get(info.GetIsolate())
           ->GetCanvasRenderingContext2DApi(info.This());
-  if (api && !api->saved_state_.empty()) {
+  if (api && api->saved_state_.size() > api->recording_saves_) {
     api->skia_canvas()->restore();
     api->state_ = api->saved_state_.back();
     api->saved_state_.pop_back();
   }
 }
 
+// static
+void CanvasRenderingContext2DApi::FastSave(v8::Local<v8::Object> receiver) {
+  CanvasRenderingContext2DApi* api = FromReceiver(receiver);
+  api->skia_canvas()->save();
+  api->saved_state_.emplace_back(api->state_);
+}
+
+// static
+void CanvasRenderingContext2DApi::FastRestore(v8::Local<v8::Object> receiver) {
+  CanvasRenderingContext2DApi* api = FromReceiver(receiver);
+  if (api->saved_state_.size() > api->recording_saves_) {
+    api->skia_canvas()->restore();
+    api->state_ = api->saved_state_.back();
+    api->saved_state_.pop_back();
+  }
+}
+
+// static
+void CanvasRenderingContext2DApi::BeginRecording(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  CanvasRenderingContext2DApi* api =
+      JsApi::Get(info.GetIsolate())
+          ->GetCanvasRenderingContext2DApi(info.This());
+  if (!api) {
+    return;
+  }
+  if (api->recorder_) {
+    api->js()->ThrowError("beginRecording was already called");
+    return;
+  }
+
+  float width = api->canvas()->width();
+  float height = api->canvas()->height();
+  if (info.Length() >= 2) {
+    if (!info[0]->IsNumber() || !info[1]->IsNumber()) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    width = info[0].As<v8::Number>()->Value();
+    height = info[1].As<v8::Number>()->Value();
+  }
+
+  // The recording starts with an identity transform and no clip, so that
+  // the picture doesn't depend on where it's drawn. The styles carry over.
+  api->recorder_ = std::make_unique<SkPictureRecorder>();
+  api->recorder_->beginRecording(SkRect::MakeWH(width, height));
+  api->recording_saves_ = api->saved_state_.size();
+}
+
+// static
+void CanvasRenderingContext2DApi::EndRecording(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* js_api = JsApi::Get(info.GetIsolate());
+  CanvasRenderingContext2DApi* api =
+      js_api->GetCanvasRenderingContext2DApi(info.This());
+  if (!api) {
+    return;
+  }
+  if (!api->recorder_) {
+    api->js()->ThrowError("beginRecording wasn't called");
+    return;
+  }
+
+  // Drop the states saved during the recording without a matching restore().
+  while (api->saved_state_.size() > api->recording_saves_) {
+    api->state_ = api->saved_state_.back();
+    api->saved_state_.pop_back();
+  }
+  sk_sp<SkPicture> picture = api->recorder_->finishRecordingAsPicture();
+  api->recorder_.reset();
+  api->recording_saves_ = 0;
+  ASSERT(picture);
+
+  v8::Local<v8::Value> args[] = {
+      v8::External::New(info.GetIsolate(), picture.release()),
+  };
+  v8::Local<v8::Object> object =
+      js_api->GetCanvasPictureConstructor()
+          ->NewInstance(info.GetIsolate()->GetCurrentContext(), 1, args)
+          .ToLocalChecked();
+  info.GetReturnValue().Set(object);
+}
+
+// static
+void CanvasRenderingContext2DApi::DrawPicture(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* js_api = JsApi::Get(info.GetIsolate());
+  CanvasRenderingContext2DApi* api =
+      js_api->GetCanvasRenderingContext2DApi(info.This());
+  if (!api) {
+    return;
+  }
+  if (info.Length() < 1 ||
+      !js_api->IsInstanceOf(info[0], js_api->GetCanvasPictureConstructor())) {
+    api->js()->ThrowInvalidArgument();
+    return;
+  }
+  SkPicture* picture = js_api->GetCanvasPictureApi(info[0])->picture();
+
+  float x = 0;
+  float y = 0;
+  if (info.Length() >= 3) {
+    if (!info[1]->IsNumber() || !info[2]->IsNumber()) {
+      api->js()->ThrowInvalidArgument();
+      return;
+    }
+    x = info[1].As<v8::Number>()->Value();
+    y = info[2].As<v8::Number>()->Value();
+  }
+
+  // Skia plays back the recorded operations directly, without going through
+  // Javascript again.
+  if (x == 0 && y == 0) {
+    api->skia_canvas()->drawPicture(picture);
+  } else {
+    SkMatrix matrix = SkMatrix::Translate(x, y);
+    api->skia_canvas()->drawPicture(picture, &matrix, nullptr);
+  }
+}
+
+// static
+void CanvasRenderingContext2DApi::FillRects(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* js_api = JsApi::Get(info.GetIsolate());
+  CanvasRenderingContext2DApi* api =
+      js_api->GetCanvasRenderingContext2DApi(info.This());
+  BulkArguments args;
+  if (!api || !GetBulkArguments(info, js_api, 0, 1, 4, &args) ||
+      args.count == 0) {
+    return;
+  }
+
+  // Meshes aren't antialiased, so the rectangles only go to Skia as a single
+  // mesh of triangles when all their edges are on pixel boundaries, where
+  // fillRect() isn't antialiased either.
+  SkCanvas* canvas = api->skia_canvas();
+  const SkMatrix& matrix = canvas->getTotalMatrix();
+  bool pixel_aligned = matrix.isScaleTranslate();
+  for (size_t i = 0; pixel_aligned && i < args.count; i++) {
+    const float* xywh = args.geometry + i * 4;
+    SkRect rect = matrix.mapRect(
+        SkRect::MakeXYWH(xywh[0], xywh[1], xywh[2], xywh[3]));
+    pixel_aligned = rect == SkRect::Make(rect.round());
+  }
+
+  if (!pixel_aligned) {
+    // The GPU backend batches consecutive drawRect() calls into one draw,
+    // like in strokeRects().
+    SkPaint paint = api->state_.fill_paint;
+    if (args.colors) {
+      paint.setShader(nullptr);
+    }
+    for (size_t i = 0; i < args.count; i++) {
+      const float* xywh = args.geometry + i * 4;
+      if (args.colors) {
+        paint.setColor(
+            RGBAToSkColor(args.colors[i], api->state_.global_alpha));
+      }
+      canvas->drawRect(SkRect::MakeXYWH(xywh[0], xywh[1], xywh[2], xywh[3]),
+                       paint);
+    }
+    return;
+  }
+
+  int vertex_count = static_cast<int>(args.count) * 6;
+  SkVertices::Builder builder(SkVertices::kTriangles_VertexMode, vertex_count,
+                              0,
+                              args.colors ? SkVertices::kHasColors_BuilderFlag
+                                          : 0);
+  SkPoint* positions = builder.positions();
+  SkColor* colors = builder.colors();
+  for (size_t i = 0; i < args.count; i++) {
+    const float* xywh = args.geometry + i * 4;
+    float left = xywh[0];
+    float top = xywh[1];
+    float right = left + xywh[2];
+    float bottom = top + xywh[3];
+    positions[0] = {left, top};
+    positions[1] = {right, top};
+    positions[2] = {right, bottom};
+    positions[3] = {left, top};
+    positions[4] = {right, bottom};
+    positions[5] = {left, bottom};
+    positions += 6;
+    if (args.colors) {
+      SkColor color = RGBAToSkColor(args.colors[i], api->state_.global_alpha);
+      std::fill(colors, colors + 6, color);
+      colors += 6;
+    }
+  }
+
+  if (args.colors) {
+    // The colors replace the fillStyle, and already include the globalAlpha.
+    SkPaint paint = api->state_.fill_paint;
+    paint.setShader(nullptr);
+    paint.setColor(SK_ColorWHITE);
+    canvas->drawVertices(builder.detach(), SkBlendMode::kDst, paint);
+  } else {
+    // Without colors, the fillStyle paints the mesh. Gradients and patterns
+    // are sampled at the canvas coordinates, like in fillRect().
+    canvas->drawVertices(builder.detach(), SkBlendMode::kModulate,
+                         api->state_.fill_paint);
+  }
+}
+
+// static
+void CanvasRenderingContext2DApi::StrokeRects(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* js_api = JsApi::Get(info.GetIsolate());
+  CanvasRenderingContext2DApi* api =
+      js_api->GetCanvasRenderingContext2DApi(info.This());
+  BulkArguments args;
+  if (!api || !GetBulkArguments(info, js_api, 0, 1, 4, &args)) {
+    return;
+  }
+
+  // Skia has no single call that strokes many rectangles with different
+  // colors, but the GPU backend batches consecutive drawRect() calls into one
+  // draw. This still saves a call from Javascript per rectangle.
+  SkCanvas* canvas = api->skia_canvas();
+  SkPaint paint = api->state_.stroke_paint;
+  if (args.colors) {
+    paint.setShader(nullptr);
+  }
+  for (size_t i = 0; i < args.count; i++) {
+    const float* xywh = args.geometry + i * 4;
+    if (args.colors) {
+      paint.setColor(RGBAToSkColor(args.colors[i], api->state_.global_alpha));
+    }
+    canvas->drawRect(SkRect::MakeXYWH(xywh[0], xywh[1], xywh[2], xywh[3]),
+                     paint);
+  }
+}
+
+// static
+void CanvasRenderingContext2DApi::FillCircles(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* js_api = JsApi::Get(info.GetIsolate());
+  CanvasRenderingContext2DApi* api =
+      js_api->GetCanvasRenderingContext2DApi(info.This());
+  BulkArguments args;
+  if (!api || !GetBulkArguments(info, js_api, 0, 1, 3, &args) ||
+      args.count == 0) {
+    return;
+  }
+
+  // Each circle is a scaled copy of a white sprite, tinted with its color,
+  // and runs of them are drawn with a single drawAtlas() call. Circles that
+  // are larger than the sprite on the screen would be blurry, and are drawn
+  // with drawCircle() instead, in order with the others.
+  SkCanvas* canvas = api->skia_canvas();
+  SkScalar matrix_scale = canvas->getTotalMatrix().getMaxScale();
+  float max_sprite_radius =
+      matrix_scale > 0 ? kCircleSpriteRadius / matrix_scale : 0;
+  SkColor fill_color =
+      ApplyGlobalAlpha(api->state_.fill_color, api->state_.global_alpha);
+
+  // The colors already include the globalAlpha. The paint still brings the
+  // composite operation and the shadow.
+  SkPaint paint = api->state_.fill_paint;
+  paint.setShader(nullptr);
+  paint.setColor(SK_ColorWHITE);
+
+  std::vector<SkRSXform> transforms;
+  std::vector<SkColor> colors;
+  transforms.reserve(args.count);
+  colors.reserve(args.count);
+  auto draw_sprites = [&] {
+    if (transforms.empty()) {
+      return;
+    }
+    std::vector<SkRect> sprites(
+        transforms.size(),
+        SkRect::MakeWH(kCircleSpriteSize, kCircleSpriteSize));
+    canvas->drawAtlas(
+        GetCircleSprite(), transforms.data(), sprites.data(), colors.data(),
+        static_cast<int>(transforms.size()), SkBlendMode::kModulate,
+        SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kLinear),
+        nullptr, &paint);
+    transforms.clear();
+    colors.clear();
+  };
+
+  for (size_t i = 0; i < args.count; i++) {
+    const float* xyr = args.geometry + i * 3;
+    float radius = fabs(xyr[2]);
+    SkColor color =
+        args.colors ? RGBAToSkColor(args.colors[i], api->state_.global_alpha)
+                    : fill_color;
+    if (radius > max_sprite_radius) {
+      draw_sprites();
+      SkPaint circle_paint = paint;
+      circle_paint.setColor(color);
+      canvas->drawCircle(xyr[0], xyr[1], radius, circle_paint);
+      continue;
+    }
+    float scale = radius / kCircleSpriteRadius;
+    float offset = scale * kCircleSpriteSize / 2.0f;
+    transforms.push_back(
+        SkRSXform::Make(scale, 0, xyr[0] - offset, xyr[1] - offset));
+    colors.push_back(color);
+  }
+  draw_sprites();
+}
+
+// static
+void CanvasRenderingContext2DApi::DrawAtlas(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  ASSERT(IsMainThread());
+  JsApi* js_api = JsApi::Get(info.GetIsolate());
+  CanvasRenderingContext2DApi* api =
+      js_api->GetCanvasRenderingContext2DApi(info.This());
+  if (!api) {
+    return;
+  }
+
+  sk_sp<SkImage> atlas =
+      info.Length() >= 1 ? GetImageSource(info[0]) : nullptr;
+  if (!atlas || info.Length() < 3 || !info[2]->IsFloat32Array()) {
+    js_api->js()->ThrowInvalidArgument();
+    return;
+  }
+  BulkArguments args;
+  if (!GetBulkArguments(info, js_api, 1, 3, 4, &args)) {
+    return;
+  }
+  v8::Local<v8::Float32Array> rects = info[2].As<v8::Float32Array>();
+  if (rects->Length() < args.count * 4) {
+    js_api->js()->ThrowError("Not enough rects");
+    return;
+  }
+  if (args.count == 0) {
+    return;
+  }
+
+  // The transforms have the same layout as SkRSXform, so they are passed
+  // as they are. The rects are x, y, width and height, like in drawImage().
+  static_assert(sizeof(SkRSXform) == 4 * sizeof(float));
+  const SkRSXform* transforms =
+      reinterpret_cast<const SkRSXform*>(args.geometry);
+  const float* xywh = GetTypedArrayData<float>(rects);
+  std::vector<SkRect> sprites(args.count);
+  for (size_t i = 0; i < args.count; i++) {
+    sprites[i] = SkRect::MakeXYWH(xywh[i * 4], xywh[i * 4 + 1],
+                                  xywh[i * 4 + 2], xywh[i * 4 + 3]);
+  }
+  std::vector<SkColor> colors;
+  if (args.colors) {
+    colors.resize(args.count);
+    for (size_t i = 0; i < args.count; i++) {
+      colors[i] = RGBAToSkColor(args.colors[i], 1.0f);
+    }
+  }
+
+  SkPaint paint;
+  paint.setAlphaf(std::clamp(api->state_.global_alpha, 0.0f, 1.0f));
+  paint.setBlendMode(api->state_.global_composite_op);
+  api->skia_canvas()->drawAtlas(
+      atlas.get(), transforms, sprites.data(),
+      colors.empty() ? nullptr : colors.data(), static_cast<int>(args.count),
+      SkBlendMode::kModulate, api->state_.sampling_options, nullptr, &paint);
+}
+
 // static
 void CanvasRenderingContext2DApi::CreateGradient(
     const v8::FunctionCallbackInfo<v8::Value>& info, int size,
@@ -2363,33 +3039,20 @@ void CanvasRenderingContext2DApi::DrawImage(
 
   // Length must be 3, 4 or 5 (image, dx, dy, [dw, dh]),
   // or 7, 8 or 9 (image sx, sy, sw, sh, dx, dy, [dw, dh]).
-  if (info.Length() < 3 || info.Length() == 6 ||
-      !(api->IsInstanceOf(info[0], api->GetImageBitmapConstructor()) ||
-        api->IsInstanceOf(info[0],
-                          api->GetCanvasRenderingContext2DConstructor()))) {
+  if (info.Length() < 3 || info.Length() == 6) {
     api->js()->ThrowInvalidArgument();
     return;
   }
 
-  sk_sp<SkImage> source_image;
-  float source_width = 0;
-  float source_height = 0;
-
-  if (api->IsInstanceOf(info[0], api->GetImageBitmapConstructor())) {
-    ImageBitmapApi* source_bitmap = api->GetImageBitmapApi(info[0]);
-    source_width = source_bitmap->width();
-    source_height = source_bitmap->height();
-    source_image = source_bitmap->texture();
-  } else {
-    CanvasRenderingContext2DApi* source_canvas =
-        api->GetCanvasRenderingContext2DApi(info[0]);
-    ASSERT(source_canvas);
-    source_width = source_canvas->canvas()->width();
-    source_height = source_canvas->canvas()->height();
-    source_image = source_canvas->canvas()->MakeImageSnapshot();
-    ASSERT(source_image->isTextureBacked());
+  sk_sp<SkImage> source_image = GetImageSource(info[0]);
+  if (!source_image) {
+    api->js()->ThrowInvalidArgument();
+    return;
   }
 
+  float source_width = source_image->width();
+  float source_height = source_image->height();
+
   float sx = 0;
   float sy = 0;
   float sw = source_width;
@@ -2433,16 +3096,65 @@ void CanvasRenderingContext2DApi::DrawImage(
     }
   }
 
-  if (sx == 0 && sy == 0 && sw == source_width && sh == source_height &&
-      dw == source_width && dh == source_height) {
-    canvas->skia_canvas()->drawImage(source_image.get(), dx, dy);
+  canvas->DrawImageRect(source_image.get(), sx, sy, sw, sh, dx, dy, dw, dh);
+}
+
+void CanvasRenderingContext2DApi::DrawImageRect(SkImage* image, float sx,
+                                                float sy, float sw, float sh,
+                                                float dx, float dy, float dw,
+                                                float dh) {
+  if (sx == 0 && sy == 0 && sw == image->width() && sh == image->height() &&
+      dw == image->width() && dh == image->height()) {
+    skia_canvas()->drawImage(image, dx, dy);
   } else {
     SkRect src = SkRect::MakeXYWH(sx, sy, sw, sh);
     SkRect dst = SkRect::MakeXYWH(dx, dy, dw, dh);
-    canvas->skia_canvas()->drawImageRect(
-        source_image.get(), src, dst, canvas->state_.sampling_options, nullptr,
-        SkCanvas::kFast_SrcRectConstraint);
+    skia_canvas()->drawImageRect(image, src, dst, state_.sampling_options,
+                                 nullptr, SkCanvas::kFast_SrcRectConstraint);
+  }
+}
+
+// static
+void CanvasRenderingContext2DApi::FastDrawImage(
+    v8::Local<v8::Object> receiver, v8::Local<v8::Value> image, double dx,
+    double dy, v8::FastApiCallbackOptions& options) {
+  sk_sp<SkImage> source = GetImageSource(image);
+  if (!source) {
+    // The slow path throws.
+    options.fallback = true;
+    return;
+  }
+  float width = source->width();
+  float height = source->height();
+  FromReceiver(receiver)->DrawImageRect(source.get(), 0, 0, width, height, dx,
+                                        dy, width, height);
+}
+
+// static
+void CanvasRenderingContext2DApi::FastDrawImageScaled(
+    v8::Local<v8::Object> receiver, v8::Local<v8::Value> image, double dx,
+    double dy, double dw, double dh, v8::FastApiCallbackOptions& options) {
+  sk_sp<SkImage> source = GetImageSource(image);
+  if (!source) {
+    options.fallback = true;
+    return;
   }
+  FromReceiver(receiver)->DrawImageRect(source.get(), 0, 0, source->width(),
+                                        source->height(), dx, dy, dw, dh);
+}
+
+// static
+void CanvasRenderingContext2DApi::FastDrawImageRect(
+    v8::Local<v8::Object> receiver, v8::Local<v8::Value> image, double sx,
+    double sy, double sw, double sh, double dx, double dy, double dw, double dh,
+    v8::FastApiCallbackOptions& options) {
+  sk_sp<SkImage> source = GetImageSource(image);
+  if (!source) {
+    options.fallback = true;
+    return;
+  }
+  FromReceiver(receiver)->DrawImageRect(source.get(), sx, sy, sw, sh, dx, dy,
+                                        dw, dh);
 }
 
 void CanvasRenderingContext2DApi::State::ResetFillStyle() {
@@ -2523,9 +3235,9 @@ sk_sp<SkShader> CanvasGradientApi::GetShader() {
 
 // static
 v8::Local<v8::Function> CanvasGradientApi::GetConstructor(
-    JsApi* api, const JsScope& scope) {
+    const JsScope& scope) {
   v8::Local<v8::FunctionTemplate> canvas_gradient =
-      v8::FunctionTemplate::New(scope.isolate, CanvasGradient);
+      scope.NewFunctionTemplate(CanvasGradient);
   canvas_gradient->SetClassName(
       scope.GetConstantString(StringId::CanvasGradient));
 
@@ -2541,6 +3253,11 @@ v8::Local<v8::Function> CanvasGradientApi::GetConstructor(
   return canvas_gradient->GetFunction(scope.context).ToLocalChecked();
 }
 
+// static
+void CanvasGradientApi::AddExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {CanvasGradient, AddColorStop});
+}
+
 void CanvasRenderingContext2DApi::OnGradientUpdated(
     CanvasGradientApi* gradient) {
   if (state_.fill_gradient == gradient) {
@@ -2597,14 +3314,14 @@ void CanvasGradientApi::AddColorStop(
     return;
   }
 
-  std::string css = gradient->js()->ToString(info[1]);
-  SkColor color;
-  if (!CSSColorToSkColor(css, &color)) {
+  CSSCache::Color css = JsApi::Get(info.GetIsolate())
+                            ->ParseCSSColor(info[1].As<v8::String>());
+  if (!css.valid) {
     gradient->js()->ThrowError("Invalid color.");
     return;
   }
 
-  gradient->colors_.push_back(color);
+  gradient->colors_.push_back(css.color);
   gradient->positions_.push_back(offset);
 
   // Invalidate the shader.
@@ -2671,10 +3388,10 @@ sk_sp<SkShader> CanvasPatternApi::GetShader() {
 }
 
 // static
-v8::Local<v8::Function> CanvasPatternApi::GetConstructor(JsApi* api,
-                                                         const JsScope& scope) {
+v8::Local<v8::Function> CanvasPatternApi::GetConstructor(
+    const JsScope& scope) {
   v8::Local<v8::FunctionTemplate> canvas_pattern =
-      v8::FunctionTemplate::New(scope.isolate, CanvasPattern);
+      scope.NewFunctionTemplate(CanvasPattern);
   canvas_pattern->SetClassName(
       scope.GetConstantString(StringId::CanvasPattern));
 
@@ -2688,6 +3405,11 @@ v8::Local<v8::Function> CanvasPatternApi::GetConstructor(JsApi* api,
   return canvas_pattern->GetFunction(scope.context).ToLocalChecked();
 }
 
+// static
+void CanvasPatternApi::AddExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {CanvasPattern, SetTransform});
+}
+
 // static
 void CanvasPatternApi::SetTransform(
     const v8::FunctionCallbackInfo<v8::Value>& info) {
@@ -2710,6 +3432,63 @@ void CanvasPatternApi::SetTransform(
   }
 }
 
+CanvasPictureApi::CanvasPictureApi(JsApi* api, v8::Local<v8::Object> thiz,
+                                   sk_sp<SkPicture> picture)
+    : JsApiWrapper(api->isolate(), thiz), picture_(std::move(picture)) {
+  allocated_in_bytes_ = picture_->approximateBytesUsed();
+  api->isolate()->AdjustAmountOfExternalAllocatedMemory(allocated_in_bytes_);
+}
+
+CanvasPictureApi::~CanvasPictureApi() {
+  isolate()->AdjustAmountOfExternalAllocatedMemory(-allocated_in_bytes_);
+}
+
+// static
+v8::Local<v8::Function> CanvasPictureApi::GetConstructor(
+    const JsScope& scope) {
+  v8::Local<v8::FunctionTemplate> canvas_picture =
+      scope.NewFunctionTemplate(CanvasPicture);
+  canvas_picture->SetClassName(
+      scope.GetConstantString(StringId::CanvasPicture));
+
+  v8::Local<v8::ObjectTemplate> instance = canvas_picture->InstanceTemplate();
+  // Used in JsApiWrapper to track this.
+  instance->SetInternalFieldCount(1);
+
+  v8::Local<v8::ObjectTemplate> prototype = canvas_picture->PrototypeTemplate();
+  scope.Set(prototype, StringId::width, GetWidth);
+  scope.Set(prototype, StringId::height, GetHeight);
+
+  return canvas_picture->GetFunction(scope.context).ToLocalChecked();
+}
+
+// static
+void CanvasPictureApi::AddExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {CanvasPicture, GetWidth, GetHeight});
+}
+
+// static
+void CanvasPictureApi::GetWidth(
+    v8::Local<v8::String> property,
+    const v8::PropertyCallbackInfo<v8::Value>& info) {
+  CanvasPictureApi* picture =
+      JsApi::Get(info.GetIsolate())->GetCanvasPictureApi(info.This());
+  if (picture) {
+    info.GetReturnValue().Set(picture->picture()->cullRect().width());
+  }
+}
+
+// static
+void CanvasPictureApi::GetHeight(
+    v8::Local<v8::String> property,
+    const v8::PropertyCallbackInfo<v8::Value>& info) {
+  CanvasPictureApi* picture =
+      JsApi::Get(info.GetIsolate())->GetCanvasPictureApi(info.This());
+  if (picture) {
+    info.GetReturnValue().Set(picture->picture()->cullRect().height());
+  }
+}
+
 ImageDataApi::ImageDataApi(JsApi* api, v8::Local<v8::Object> thiz, int width,
                            int height)
     : JsApiWrapper(api->isolate(), thiz), width_(width), height_(height) {
@@ -2784,10 +3563,10 @@ ImageDataApi::ImageDataApi(JsApi* api, v8::Local<v8::Object> thiz,
 ImageDataApi::~ImageDataApi() {}
 
 // static
-v8::Local<v8::Function> ImageDataApi::GetConstructor(JsApi* api,
-                                                     const JsScope& scope) {
+v8::Local<v8::Function> ImageDataApi::GetConstructor(
+    const JsScope& scope) {
   v8::Local<v8::FunctionTemplate> image_data =
-      v8::FunctionTemplate::New(scope.isolate, ImageData);
+      scope.NewFunctionTemplate(ImageData);
   image_data->SetClassName(scope.GetConstantString(StringId::ImageData));
 
   v8::Local<v8::ObjectTemplate> instance = image_data->InstanceTemplate();
@@ -2806,6 +3585,12 @@ v8::Local<v8::Function> ImageDataApi::GetConstructor(JsApi* api,
   return image_data->GetFunction(scope.context).ToLocalChecked();
 }
 
+// static
+void ImageDataApi::AddExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {ImageData, Decode, GetData, GetWidth,
+                                   GetHeight, Encode});
+}
+
 // static
 void ImageDataApi::GetData(v8::Local<v8::String> property,
                            const v8::PropertyCallbackInfo<v8::Value>& info) {
@@ -2867,8 +3652,14 @@ void ImageDataApi::Decode(const v8::FunctionCallbackInfo<v8::Value>& info) {
     return;
   }
 
-  info.GetReturnValue().Set(
-      api->PostToBackgroundAndResolve([data]() -> JsApi::ResolveFunction {
+  AbortSignalApi* signal;
+  if (!api->GetAbortSignalOption(info[1], &signal)) {
+    return;
+  }
+
+  info.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::CPU, signal,
+      [data](const CancelFlag&) -> JsApi::ResolveFunction {
         sk_sp<SkImage> image = SkImage::MakeFromEncoded(data);
         if (!image) {
           return JsApi::Reject("Failed to decode image");
@@ -2899,20 +3690,22 @@ ImageBitmapApi::ImageBitmapApi(JsApi* api, v8::Local<v8::Object> thiz,
                                sk_sp<SkImage> texture)
     : JsApiWrapper(api->isolate(), thiz), texture_(texture) {
   ASSERT(texture->isTextureBacked());
+  thiz->SetAlignedPointerInInternalField(1, &kImageBitmapTag);
 }
 
 ImageBitmapApi::~ImageBitmapApi() {}
 
 // static
-v8::Local<v8::Function> ImageBitmapApi::GetConstructor(JsApi* api,
-                                                       const JsScope& scope) {
+v8::Local<v8::Function> ImageBitmapApi::GetConstructor(
+    const JsScope& scope) {
   v8::Local<v8::FunctionTemplate> image_bitmap =
-      v8::FunctionTemplate::New(scope.isolate, ImageBitmap);
+      scope.NewFunctionTemplate(ImageBitmap);
   image_bitmap->SetClassName(scope.GetConstantString(StringId::ImageBitmap));
 
   v8::Local<v8::ObjectTemplate> instance = image_bitmap->InstanceTemplate();
-  // Used in JsApiWrapper to track this.
-  instance->SetInternalFieldCount(1);
+  // Used in JsApiWrapper to track this, and for the tag of drawImage()
+  // sources.
+  instance->SetInternalFieldCount(2);
 
   scope.Set(image_bitmap, StringId::decode, Decode);
 
@@ -2925,6 +3718,12 @@ v8::Local<v8::Function> ImageBitmapApi::GetConstructor(JsApi* api,
   return image_bitmap->GetFunction(scope.context).ToLocalChecked();
 }
 
+// static
+void ImageBitmapApi::AddExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {ImageBitmap, Decode, GetWidth, GetHeight,
+                                   Encode});
+}
+
 // static
 void ImageBitmapApi::GetWidth(v8::Local<v8::String> property,
                               const v8::PropertyCallbackInfo<v8::Value>& info) {
@@ -2968,8 +3767,14 @@ void ImageBitmapApi::Decode(const v8::FunctionCallbackInfo<v8::Value>& info) {
     return;
   }
 
-  info.GetReturnValue().Set(
-      api->PostToBackgroundAndResolve([data]() -> JsApi::ResolveFunction {
+  AbortSignalApi* signal;
+  if (!api->GetAbortSignalOption(info[1], &signal)) {
+    return;
+  }
+
+  info.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::CPU, signal,
+      [data](const CancelFlag&) -> JsApi::ResolveFunction {
         sk_sp<SkImage> image = SkImage::MakeFromEncoded(data);
         if (!image) {
           return JsApi::Reject("Failed to decode image");
@@ -2999,10 +3804,9 @@ Path2DApi::Path2DApi(JsApi* api, v8::Local<v8::Object> thiz, const SkPath& path)
 Path2DApi::~Path2DApi() {}
 
 // static
-v8::Local<v8::Function> Path2DApi::GetConstructor(JsApi* api,
-                                                  const JsScope& scope) {
-  v8::Local<v8::FunctionTemplate> path2d =
-      v8::FunctionTemplate::New(scope.isolate, Path2D);
+v8::Local<v8::Function> Path2DApi::GetConstructor(
+    const JsScope& scope) {
+  v8::Local<v8::FunctionTemplate> path2d = scope.NewFunctionTemplate(Path2D);
   path2d->SetClassName(scope.GetConstantString(StringId::Path2D));
 
   v8::Local<v8::ObjectTemplate> instance = path2d->InstanceTemplate();
@@ -3025,6 +3829,13 @@ v8::Local<v8::Function> Path2DApi::GetConstructor(JsApi* api,
   return path2d->GetFunction(scope.context).ToLocalChecked();
 }
 
+// static
+void Path2DApi::AddExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {Path2D, AddPath, ClosePath, MoveTo, LineTo,
+                                   BezierCurveTo, QuadraticCurveTo, Arc, ArcTo,
+                                   Ellipse, Rect});
+}
+
 // static
 void Path2DApi::AddPath(const v8::FunctionCallbackInfo<v8::Value>& info) {
   // TODO: support DOMMatrix as the second argument.
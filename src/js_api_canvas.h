@@ -1,6 +1,7 @@
 #ifndef WINDOWJS_JS_API_CANVAS_H
 #define WINDOWJS_JS_API_CANVAS_H
 
+#include <array>
 #include <deque>
 #include <functional>
 #include <memory>
@@ -8,15 +9,20 @@
 #include <skia/include/core/SkFont.h>
 #include <skia/include/core/SkPaint.h>
 #include <skia/include/core/SkPath.h>
+#include <skia/include/core/SkPicture.h>
+#include <skia/include/core/SkPictureRecorder.h>
 #include <skia/include/core/SkShader.h>
+#include <v8/include/v8-fast-api-calls.h>
 #include <v8/include/v8.h>
 
 #include "canvas.h"
 #include "js_api.h"
 #include "js_scope.h"
+#include "text_blob_cache.h"
 
 class CanvasGradientApi;
 class CanvasPatternApi;
+class CanvasPictureApi;
 
 class CanvasRenderingContext2DApi final
     : public JsApiWrapper,
@@ -27,13 +33,18 @@ class CanvasRenderingContext2DApi final
   ~CanvasRenderingContext2DApi() override;
 
   Canvas* canvas() const { return canvas_.get(); }
-  SkCanvas* skia_canvas() const { return canvas_->canvas(); }
+
+  // The canvas that drawing calls go to: the recording canvas of the picture
+  // started by beginRecording(), if any.
+  SkCanvas* skia_canvas() const {
+    return recorder_ ? recorder_->getRecordingCanvas() : canvas_->canvas();
+  }
 
   void OnGradientUpdated(CanvasGradientApi* gradient);
   void OnPatternUpdated(CanvasPatternApi* pattern);
 
-  static v8::Local<v8::Function> GetConstructor(JsApi* api,
-                                                const JsScope& scope);
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
 
  private:
   static void GetWidth(v8::Local<v8::String> property,
@@ -184,6 +195,13 @@ class CanvasRenderingContext2DApi final
   static void ResetTransform(const v8::FunctionCallbackInfo<v8::Value>& info);
   static void Save(const v8::FunctionCallbackInfo<v8::Value>& info);
   static void Restore(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void BeginRecording(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void EndRecording(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void DrawPicture(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void FillRects(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void StrokeRects(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void FillCircles(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void DrawAtlas(const v8::FunctionCallbackInfo<v8::Value>& info);
 
   static void CreateGradient(const v8::FunctionCallbackInfo<v8::Value>& info,
                              int size, const char* function);
@@ -197,6 +215,42 @@ class CanvasRenderingContext2DApi final
   static void PutImageData(const v8::FunctionCallbackInfo<v8::Value>& info);
   static void Encode(const v8::FunctionCallbackInfo<v8::Value>& info);
   static void DrawImage(const v8::FunctionCallbackInfo<v8::Value>& info);
+  void DrawImageRect(SkImage* image, float sx, float sy, float sw, float sh,
+                     float dx, float dy, float dw, float dh);
+
+  // v8 Fast API versions of the hottest methods. Optimized code calls these
+  // directly, without a HandleScope or a FunctionCallbackInfo, when the
+  // receiver is a CanvasRenderingContext2D and the arguments are numbers.
+  // They can't allocate on the v8 heap nor throw; the drawImage() versions set
+  // options.fallback to retry in the slow path when the image is invalid.
+  static CanvasRenderingContext2DApi* FromReceiver(
+      v8::Local<v8::Object> receiver);
+  static void FastClearRect(v8::Local<v8::Object> receiver, double x, double y,
+                            double w, double h);
+  static void FastFillRect(v8::Local<v8::Object> receiver, double x, double y,
+                           double w, double h);
+  static void FastStrokeRect(v8::Local<v8::Object> receiver, double x,
+                             double y, double w, double h);
+  static void FastMoveTo(v8::Local<v8::Object> receiver, double x, double y);
+  static void FastLineTo(v8::Local<v8::Object> receiver, double x, double y);
+  static void FastArc(v8::Local<v8::Object> receiver, double x, double y,
+                      double r, double start, double end);
+  static void FastTranslate(v8::Local<v8::Object> receiver, double x,
+                            double y);
+  static void FastSave(v8::Local<v8::Object> receiver);
+  static void FastRestore(v8::Local<v8::Object> receiver);
+  static void FastDrawImage(v8::Local<v8::Object> receiver,
+                            v8::Local<v8::Value> image, double dx, double dy,
+                            v8::FastApiCallbackOptions& options);
+  static void FastDrawImageScaled(v8::Local<v8::Object> receiver,
+                                  v8::Local<v8::Value> image, double dx,
+                                  double dy, double dw, double dh,
+                                  v8::FastApiCallbackOptions& options);
+  static void FastDrawImageRect(v8::Local<v8::Object> receiver,
+                                v8::Local<v8::Value> image, double sx,
+                                double sy, double sw, double sh, double dx,
+                                double dy, double dw, double dh,
+                                v8::FastApiCallbackOptions& options);
 
   std::unique_ptr<Canvas> canvas_;
   int64_t allocated_in_bytes_;
@@ -235,6 +289,24 @@ class CanvasRenderingContext2DApi final
 
   State state_;
   std::deque<State> saved_state_;
+
+  // Set between beginRecording() and endRecording(). restore() doesn't pop
+  // the states saved before the recording started.
+  std::unique_ptr<SkPictureRecorder> recorder_;
+  size_t recording_saves_;
+
+  TextBlobCache text_cache_;
+
+  // The last strings drawn by fillText() and strokeText(), indexed by their
+  // hash. Redrawing the same v8::String in the same font doesn't convert it
+  // to UTF-8 to look it up in text_cache_.
+  struct InternedText {
+    v8::Global<v8::String> string;
+    SkFont font;
+    TextBlobCache::Text text;
+  };
+  static constexpr size_t kInternedTexts = 64;
+  std::array<InternedText, kInternedTexts> interned_texts_;
 };
 
 class CanvasGradientApi final : public JsApiWrapper {
@@ -248,8 +320,8 @@ class CanvasGradientApi final : public JsApiWrapper {
 
   sk_sp<SkShader> GetShader();
 
-  static v8::Local<v8::Function> GetConstructor(JsApi* api,
-                                                const JsScope& scope);
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
 
  private:
   static void AddColorStop(const v8::FunctionCallbackInfo<v8::Value>& info);
@@ -278,8 +350,8 @@ class CanvasPatternApi final : public JsApiWrapper {
 
   sk_sp<SkShader> GetShader();
 
-  static v8::Local<v8::Function> GetConstructor(JsApi* api,
-                                                const JsScope& scope);
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
 
  private:
   static void SetTransform(const v8::FunctionCallbackInfo<v8::Value>& info);
@@ -289,6 +361,27 @@ class CanvasPatternApi final : public JsApiWrapper {
   int ref_count_;
 };
 
+class CanvasPictureApi final : public JsApiWrapper {
+ public:
+  CanvasPictureApi(JsApi* api, v8::Local<v8::Object> thiz,
+                   sk_sp<SkPicture> picture);
+  ~CanvasPictureApi() override;
+
+  SkPicture* picture() const { return picture_.get(); }
+
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
+
+ private:
+  static void GetWidth(v8::Local<v8::String> property,
+                       const v8::PropertyCallbackInfo<v8::Value>& info);
+  static void GetHeight(v8::Local<v8::String> property,
+                        const v8::PropertyCallbackInfo<v8::Value>& info);
+
+  sk_sp<SkPicture> picture_;
+  int64_t allocated_in_bytes_;
+};
+
 class ImageDataApi final : public JsApiWrapper {
  public:
   ImageDataApi(JsApi* api, v8::Local<v8::Object> thiz, int width, int height);
@@ -318,8 +411,8 @@ class ImageDataApi final : public JsApiWrapper {
     };
   }
 
-  static v8::Local<v8::Function> GetConstructor(JsApi* api,
-                                                const JsScope& scope);
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
 
  private:
   static void GetData(v8::Local<v8::String> property,
@@ -347,8 +440,8 @@ class ImageBitmapApi final : public JsApiWrapper {
   int width() const { return texture_->width(); }
   int height() const { return texture_->height(); }
 
-  static v8::Local<v8::Function> GetConstructor(JsApi* api,
-                                                const JsScope& scope);
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
 
  private:
   static void GetWidth(v8::Local<v8::String> property,
@@ -368,8 +461,8 @@ class Path2DApi final : public JsApiWrapper {
 
   const SkPath& path() const { return path_; }
 
-  static v8::Local<v8::Function> GetConstructor(JsApi* api,
-                                                const JsScope& scope);
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
 
  private:
   static void AddPath(const v8::FunctionCallbackInfo<v8::Value>& info);
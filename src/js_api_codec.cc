@@ -71,7 +71,7 @@ void ToBase64(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
 }  // namespace
 
-v8::Local<v8::Object> MakeCodecApi(JsApi* api, const JsScope& scope) {
+v8::Local<v8::Object> MakeCodecApi(const JsScope& scope) {
   v8::Local<v8::Object> codec = v8::Object::New(scope.isolate);
 
   scope.Set(codec, StringId::base64ToArrayBuffer, Base64ToArrayBuffer);
@@ -79,3 +79,7 @@ v8::Local<v8::Object> MakeCodecApi(JsApi* api, const JsScope& scope) {
 
   return codec;
 }
+
+void AddCodecApiExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {Base64ToArrayBuffer, ToBase64});
+}
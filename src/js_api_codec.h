@@ -6,6 +6,7 @@
 #include "js_api.h"
 #include "js_scope.h"
 
-v8::Local<v8::Object> MakeCodecApi(JsApi* api, const JsScope& scope);
+v8::Local<v8::Object> MakeCodecApi(const JsScope& scope);
+void AddCodecApiExternalReferences(std::vector<intptr_t>* refs);
 
 #endif  // WINDOWJS_JS_API_CODEC_H
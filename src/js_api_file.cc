@@ -3,22 +3,28 @@
 #include "console.h"
 #include "fail.h"
 #include "file.h"
+#include "js_api_abort.h"
 #include "js_api_canvas.h"
 #include "thread.h"
 
 namespace {
 
 void ReadText(const v8::FunctionCallbackInfo<v8::Value>& args) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
     return;
   }
   std::string path = api->js()->ToString(args[0]);
+  AbortSignalApi* signal;
+  if (!api->GetAbortSignalOption(args[1], &signal)) {
+    return;
+  }
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
-      [p = std::move(path)]() -> JsApi::ResolveFunction {
+      JsApi::BackgroundTaskType::IO, signal,
+      [p = std::move(path)](const CancelFlag&) -> JsApi::ResolveFunction {
         std::string content;
         std::string error;
         ReadFile(p, &content, &error);
@@ -30,16 +36,21 @@ void ReadText(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 void ReadJson(const v8::FunctionCallbackInfo<v8::Value>& args) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
     return;
   }
   std::string path = api->js()->ToString(args[0]);
+  AbortSignalApi* signal;
+  if (!api->GetAbortSignalOption(args[1], &signal)) {
+    return;
+  }
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
-      [p = std::move(path)]() -> JsApi::ResolveFunction {
+      JsApi::BackgroundTaskType::IO, signal,
+      [p = std::move(path)](const CancelFlag&) -> JsApi::ResolveFunction {
         std::string content;
         std::string error;
         ReadFile(p, &content, &error);
@@ -61,16 +72,21 @@ void ReadJson(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 void ReadArrayBuffer(const v8::FunctionCallbackInfo<v8::Value>& args) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
     return;
   }
   std::string path = api->js()->ToString(args[0]);
+  AbortSignalApi* signal;
+  if (!api->GetAbortSignalOption(args[1], &signal)) {
+    return;
+  }
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
-      [p = std::move(path)]() -> JsApi::ResolveFunction {
+      JsApi::BackgroundTaskType::IO, signal,
+      [p = std::move(path)](const CancelFlag&) -> JsApi::ResolveFunction {
         std::string content;
         std::string error;
         ReadFile(p, &content, &error);
@@ -88,22 +104,31 @@ void ReadArrayBuffer(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 void ReadImageData(const v8::FunctionCallbackInfo<v8::Value>& args) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
     return;
   }
   std::string path = api->js()->ToString(args[0]);
+  AbortSignalApi* signal;
+  if (!api->GetAbortSignalOption(args[1], &signal)) {
+    return;
+  }
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
-      [p = std::move(path)]() -> JsApi::ResolveFunction {
+      JsApi::BackgroundTaskType::IO, signal,
+      [p = std::move(path)](
+          const CancelFlag& cancelled) -> JsApi::ResolveFunction {
         std::string error;
         sk_sp<SkData> data = ReadFile(p, &error);
         if (!error.empty()) {
           return JsApi::Reject(std::move(error));
         }
         ASSERT(data);
+        if (cancelled.IsCancelled()) {
+          return {};
+        }
         sk_sp<SkImage> image = SkImage::MakeFromEncoded(data);
         if (!image) {
           return JsApi::Reject("Failed to decode image");
@@ -131,22 +156,36 @@ void ReadImageData(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 void ReadImageBitmap(const v8::FunctionCallbackInfo<v8::Value>& args) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
+  if (!api->window()) {
+    // ImageBitmaps are textures in the GPU context of the window.
+    api->js()->ThrowError("ImageBitmaps aren't available in Workers.");
+    return;
+  }
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
     return;
   }
   std::string path = api->js()->ToString(args[0]);
+  AbortSignalApi* signal;
+  if (!api->GetAbortSignalOption(args[1], &signal)) {
+    return;
+  }
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
-      [p = std::move(path)]() -> JsApi::ResolveFunction {
+      JsApi::BackgroundTaskType::IO, signal,
+      [p = std::move(path)](
+          const CancelFlag& cancelled) -> JsApi::ResolveFunction {
         std::string error;
         sk_sp<SkData> data = ReadFile(p, &error);
         if (!error.empty()) {
           return JsApi::Reject(std::move(error));
         }
         ASSERT(data);
+        if (cancelled.IsCancelled()) {
+          return {};
+        }
         sk_sp<SkImage> image = SkImage::MakeFromEncoded(data);
         if (!image) {
           return JsApi::Reject("Failed to decode image");
@@ -171,7 +210,7 @@ void ReadImageBitmap(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 void Write(const v8::FunctionCallbackInfo<v8::Value>& args) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
@@ -204,6 +243,7 @@ void Write(const v8::FunctionCallbackInfo<v8::Value>& args) {
   }
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::IO,
       [p = std::move(path),
        c = std::move(content)]() -> JsApi::ResolveFunction {
         std::string error;
@@ -217,7 +257,7 @@ void Write(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
 void PathFunction(const v8::FunctionCallbackInfo<v8::Value>& args,
                   std::function<void(const std::string&, std::string*)> f) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
@@ -226,6 +266,7 @@ void PathFunction(const v8::FunctionCallbackInfo<v8::Value>& args,
   std::string path = api->js()->ToString(args[0]);
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::IO,
       [p = std::move(path), f = std::move(f)]() -> JsApi::ResolveFunction {
         std::string error;
         f(p, &error);
@@ -240,7 +281,7 @@ void PathsFunction(
     const v8::FunctionCallbackInfo<v8::Value>& args,
     std::function<void(const std::string&, const std::string&, std::string*)>
         f) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsString()) {
     api->js()->ThrowError("Two String arguments are required.");
@@ -250,6 +291,7 @@ void PathsFunction(
   std::string to = api->js()->ToString(args[1]);
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::IO,
       [from = std::move(from), to = std::move(to),
        f = std::move(f)]() -> JsApi::ResolveFunction {
         std::string error;
@@ -264,7 +306,7 @@ void PathsFunction(
 void BooleanPathFunction(
     const v8::FunctionCallbackInfo<v8::Value>& args,
     std::function<bool(const std::string&, std::string*)> f) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
@@ -273,6 +315,7 @@ void BooleanPathFunction(
   std::string path = api->js()->ToString(args[0]);
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::IO,
       [p = std::move(path), f = std::move(f)]() -> JsApi::ResolveFunction {
         std::string error;
         bool result = f(p, &error);
@@ -287,7 +330,7 @@ void ListFunction(const v8::FunctionCallbackInfo<v8::Value>& args,
                   std::function<std::vector<std::filesystem::path>(
                       const std::filesystem::path&, std::string*)>
                       f) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
@@ -296,6 +339,7 @@ void ListFunction(const v8::FunctionCallbackInfo<v8::Value>& args,
   std::string path = api->js()->ToString(args[0]);
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::IO,
       [p = std::move(path), f = std::move(f)]() -> JsApi::ResolveFunction {
         std::string error;
         std::vector<std::filesystem::path> list = f(p, &error);
@@ -325,7 +369,7 @@ void IsFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 void Size(const v8::FunctionCallbackInfo<v8::Value>& args) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
@@ -334,6 +378,7 @@ void Size(const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string path = api->js()->ToString(args[0]);
 
   args.GetReturnValue().Set(api->PostToBackgroundAndResolve(
+      JsApi::BackgroundTaskType::IO,
       [p = std::move(path)]() -> JsApi::ResolveFunction {
         std::string error;
         size_t size = ::GetFileSize(p, &error);
@@ -374,7 +419,7 @@ void Rename(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
 void GetCwd(v8::Local<v8::Name> property,
             const v8::PropertyCallbackInfo<v8::Value>& info) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(info.GetIsolate());
   info.GetReturnValue().Set(api->js()->MakeString(::GetCwd().u8string()));
 }
@@ -384,7 +429,7 @@ void MkDirs(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 void Basename(const v8::FunctionCallbackInfo<v8::Value>& args) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
@@ -395,7 +440,7 @@ void Basename(const v8::FunctionCallbackInfo<v8::Value>& args) {
 }
 
 void Dirname(const v8::FunctionCallbackInfo<v8::Value>& args) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(args.GetIsolate());
   if (args.Length() < 1 || !args[0]->IsString()) {
     api->js()->ThrowError("String argument is required.");
@@ -407,7 +452,7 @@ void Dirname(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
 void GetHome(v8::Local<v8::Name> property,
              const v8::PropertyCallbackInfo<v8::Value>& info) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   std::string error;
   std::string home = GetUserHomePath(&error);
   JsApi* api = JsApi::Get(info.GetIsolate());
@@ -420,7 +465,7 @@ void GetHome(v8::Local<v8::Name> property,
 
 void GetTmp(v8::Local<v8::Name> property,
             const v8::PropertyCallbackInfo<v8::Value>& info) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   std::string error;
   std::string tmp = GetTmpDir(&error);
   JsApi* api = JsApi::Get(info.GetIsolate());
@@ -433,7 +478,7 @@ void GetTmp(v8::Local<v8::Name> property,
 
 void GetSep(v8::Local<v8::Name> property,
             const v8::PropertyCallbackInfo<v8::Value>& info) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   JsApi* api = JsApi::Get(info.GetIsolate());
   char sep[2] = {std::filesystem::path::preferred_separator, '\0'};
   info.GetReturnValue().Set(api->js()->MakeString(sep));
@@ -441,7 +486,7 @@ void GetSep(v8::Local<v8::Name> property,
 
 }  // namespace
 
-v8::Local<v8::Object> MakeFileApi(JsApi* api, const JsScope& scope) {
+v8::Local<v8::Object> MakeFileApi(const JsScope& scope) {
   v8::Local<v8::Object> file = v8::Object::New(scope.isolate);
 
   scope.Set(file, StringId::readText, ReadText);
@@ -475,3 +520,11 @@ v8::Local<v8::Object> MakeFileApi(JsApi* api, const JsScope& scope) {
 
   return file;
 }
+
+void AddFileApiExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {ReadText, ReadJson, ReadArrayBuffer,
+                                   ReadImageBitmap, ReadImageData, Write, IsDir,
+                                   IsFile, Size, List, ListTree, Copy, CopyTree,
+                                   Remove, RemoveTree, Rename, MkDirs, GetCwd,
+                                   GetHome, GetSep, GetTmp, Basename, Dirname});
+}
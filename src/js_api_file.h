@@ -6,6 +6,7 @@
 #include "js_api.h"
 #include "js_scope.h"
 
-v8::Local<v8::Object> MakeFileApi(JsApi* api, const JsScope& scope);
+v8::Local<v8::Object> MakeFileApi(const JsScope& scope);
+void AddFileApiExternalReferences(std::vector<intptr_t>* refs);
 
 #endif  // WINDOWJS_JS_API_FILE_H
@@ -2,8 +2,6 @@
 
 #include <cstdlib>
 
-#include <uv.h>
-
 #include "args.h"
 #include "fail.h"
 #include "file.h"
@@ -28,13 +26,7 @@ void GetArgs(v8::Local<v8::String> property,
 
 void GetCpus(v8::Local<v8::String> property,
              const v8::PropertyCallbackInfo<v8::Value>& info) {
-  static int cpus = 0;
-  if (cpus == 0) {
-    uv_cpu_info_t* info = nullptr;
-    uv_cpu_info(&info, &cpus);
-    uv_free_cpu_info(info, cpus);
-  }
-  info.GetReturnValue().Set(cpus);
+  info.GetReturnValue().Set(GetNumberOfCpus());
 }
 
 void Process(const v8::FunctionCallbackInfo<v8::Value>& info) {
@@ -64,10 +56,9 @@ bool ProcessApi::SendMessage(MessageType type, std::string message) {
 }
 
 // static
-v8::Local<v8::Function> ProcessApi::GetConstructor(JsApi* api,
-                                                   const JsScope& scope) {
-  v8::Local<v8::FunctionTemplate> process =
-      v8::FunctionTemplate::New(scope.isolate, Process);
+v8::Local<v8::Function> ProcessApi::GetConstructor(
+    const JsScope& scope) {
+  v8::Local<v8::FunctionTemplate> process = scope.NewFunctionTemplate(Process);
   process->SetClassName(scope.GetConstantString(StringId::Process));
 
   v8::Local<v8::ObjectTemplate> instance = process->InstanceTemplate();
@@ -99,14 +90,22 @@ v8::Local<v8::Function> ProcessApi::GetConstructor(JsApi* api,
 }
 
 // static
-ProcessApi* ProcessApi::MaybeAttachToParent(
-    JsApi* api, const JsScope& scope, v8::Local<v8::Function> constructor) {
+void ProcessApi::AddExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {Process, PostMessage, AddEventListener,
+                                   RemoveEventListener, Close, GetArgs, GetCpus,
+                                   Spawn, Exit});
+}
+
+// static
+ProcessApi* ProcessApi::MaybeAttachToParent(JsApi* api,
+                                            const JsScope& scope) {
   if (!Args().is_child_process) {
     return nullptr;
   }
 
   v8::Local<v8::Object> object =
-      constructor->NewInstance(api->isolate()->GetCurrentContext())
+      api->GetProcessConstructor()
+          ->NewInstance(api->isolate()->GetCurrentContext())
           .ToLocalChecked();
   ProcessApi* process = api->GetProcessApi(object);
   ASSERT(process);
@@ -125,7 +124,7 @@ ProcessApi* ProcessApi::MaybeAttachToParent(
         });
       });
 
-  scope.Set(constructor, StringId::parent, object);
+  scope.Set(api->GetProcessConstructor(), StringId::parent, object);
 
   return process;
 }
@@ -33,11 +33,10 @@ class ProcessApi final : public JsApiWrapper {
 
   bool SendMessage(MessageType type, std::string message);
 
-  static v8::Local<v8::Function> GetConstructor(JsApi* api,
-                                                const JsScope& scope);
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
 
-  static ProcessApi* MaybeAttachToParent(JsApi* api, const JsScope& scope,
-                                         v8::Local<v8::Function> constructor);
+  static ProcessApi* MaybeAttachToParent(JsApi* api, const JsScope& scope);
 
  private:
   static void Spawn(const v8::FunctionCallbackInfo<v8::Value>& info);
@@ -0,0 +1,378 @@
+#include "js_api_worker.h"
+
+#include <cstdlib>
+#include <utility>
+
+#include "fail.h"
+#include "thread.h"
+
+namespace {
+
+class SerializerDelegate final : public v8::ValueSerializer::Delegate {
+ public:
+  explicit SerializerDelegate(v8::Isolate* isolate) : isolate_(isolate) {}
+
+  void ThrowDataCloneError(v8::Local<v8::String> message) override {
+    isolate_->ThrowException(v8::Exception::Error(message));
+  }
+
+ private:
+  v8::Isolate* isolate_;
+};
+
+// Serializes "value" into "message", and moves the backing stores of the
+// ArrayBuffers in "transfer" into it. Returns false and throws on failures.
+bool Serialize(JsApi* api, v8::Local<v8::Value> value,
+               v8::Local<v8::Value> transfer, WorkerMessage* message) {
+  v8::Isolate* isolate = api->isolate();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+  std::vector<v8::Local<v8::ArrayBuffer>> buffers;
+  if (!transfer.IsEmpty() && !transfer->IsUndefined()) {
+    if (!transfer->IsArray()) {
+      api->js()->ThrowTypeError("The transfer list must be an array.");
+      return false;
+    }
+    v8::Local<v8::Array> array = transfer.As<v8::Array>();
+    for (uint32_t i = 0; i < array->Length(); i++) {
+      v8::Local<v8::Value> item;
+      if (!array->Get(context, i).ToLocal(&item)) {
+        return false;
+      }
+      if (!item->IsArrayBuffer()) {
+        api->js()->ThrowTypeError("Only ArrayBuffers can be transferred.");
+        return false;
+      }
+      v8::Local<v8::ArrayBuffer> buffer = item.As<v8::ArrayBuffer>();
+      if (!buffer->IsDetachable() || buffer->WasDetached()) {
+        api->js()->ThrowError("The ArrayBuffer can't be transferred.");
+        return false;
+      }
+      for (v8::Local<v8::ArrayBuffer> other : buffers) {
+        if (other == buffer) {
+          api->js()->ThrowError("Duplicate ArrayBuffer in the transfer list.");
+          return false;
+        }
+      }
+      buffers.push_back(buffer);
+    }
+  }
+
+  SerializerDelegate delegate(isolate);
+  v8::ValueSerializer serializer(isolate, &delegate);
+  serializer.WriteHeader();
+  for (uint32_t i = 0; i < buffers.size(); i++) {
+    serializer.TransferArrayBuffer(i, buffers[i]);
+  }
+  if (!serializer.WriteValue(context, value).FromMaybe(false)) {
+    return false;
+  }
+
+  // The buffers are only detached once the message can be sent.
+  for (v8::Local<v8::ArrayBuffer> buffer : buffers) {
+    message->array_buffers.push_back(buffer->GetBackingStore());
+    buffer->Detach();
+  }
+
+  std::pair<uint8_t*, size_t> data = serializer.Release();
+  message->data.assign(data.first, data.first + data.second);
+  // Allocated by the default ValueSerializer::Delegate, with realloc().
+  std::free(data.first);
+  return true;
+}
+
+v8::MaybeLocal<v8::Value> Deserialize(WorkerMessage message,
+                                      const JsScope& scope) {
+  v8::ValueDeserializer deserializer(scope.isolate, message.data.data(),
+                                     message.data.size());
+  for (uint32_t i = 0; i < message.array_buffers.size(); i++) {
+    deserializer.TransferArrayBuffer(
+        i, v8::ArrayBuffer::New(scope.isolate,
+                                std::move(message.array_buffers[i])));
+  }
+  if (!deserializer.ReadHeader(scope.context).FromMaybe(false)) {
+    return {};
+  }
+  return deserializer.ReadValue(scope.context);
+}
+
+v8::Local<v8::Object> MakeWorkerExceptionEvent(
+    std::string message, std::vector<std::string> stack_trace,
+    const JsScope& scope) {
+  std::vector<v8::Local<v8::Value>> frames;
+  frames.reserve(stack_trace.size());
+  for (const std::string& frame : stack_trace) {
+    frames.push_back(scope.MakeString(frame));
+  }
+  v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
+  scope.Set(event, StringId::type, StringId::exception);
+  scope.SetValue(event, StringId::message, scope.MakeString(message));
+  scope.SetValue(event, StringId::stacktrace,
+                 v8::Array::New(scope.isolate, frames.data(), frames.size()));
+  event->SetIntegrityLevel(scope.context, v8::IntegrityLevel::kFrozen);
+  return event;
+}
+
+}  // namespace
+
+WorkerApi::WorkerApi(JsApi* api, v8::Local<v8::Object> thiz)
+    : JsApiWrapper(api->isolate(), thiz),
+      weak_factory_(this),
+      owner_(nullptr),
+      parent_thread_(nullptr) {}
+
+WorkerApi::~WorkerApi() {
+  Terminate();
+}
+
+void WorkerApi::Terminate() {
+  ASSERT(IsJsThread());
+  if (!thread_) {
+    return;
+  }
+  owner_->RemoveWorker(this);
+  owner_ = nullptr;
+  thread_.reset();
+  // No more events will happen to this object, so it can be GCed now.
+  SetWeak();
+}
+
+void WorkerApi::HandleMessage(WorkerMessage message) {
+  ASSERT(IsJsThread());
+  JsScope scope(js());
+  v8::TryCatch try_catch(scope.isolate);
+  v8::Local<v8::Value> event;
+  if (Deserialize(std::move(message), scope).ToLocal(&event)) {
+    events_.Dispatch(JsEventType::MESSAGE, event, scope);
+  }
+  if (try_catch.HasCaught()) {
+    js()->ReportException(try_catch.Message());
+  }
+}
+
+// static
+v8::Local<v8::Function> WorkerApi::GetConstructor(const JsScope& scope) {
+  v8::Local<v8::FunctionTemplate> worker = scope.NewFunctionTemplate(Worker);
+  worker->SetClassName(scope.GetConstantString(StringId::Worker));
+
+  v8::Local<v8::ObjectTemplate> instance = worker->InstanceTemplate();
+  // Used in JsApiWrapper to track this.
+  instance->SetInternalFieldCount(1);
+
+  // Methods on instances of "Worker". Called like so:
+  //   const worker = new Worker('worker.js');
+  //   worker.postMessage({pixels: buffer}, [buffer]);
+  //   worker.addEventListener('message', (message) => { ... });
+  v8::Local<v8::ObjectTemplate> prototype = worker->PrototypeTemplate();
+  scope.Set(prototype, StringId::postMessage, PostMessage);
+  scope.Set(prototype, StringId::addEventListener, AddEventListener);
+  scope.Set(prototype, StringId::removeEventListener, RemoveEventListener);
+  scope.Set(prototype, StringId::close, Close);
+
+  return worker->GetFunction(scope.context).ToLocalChecked();
+}
+
+// static
+void WorkerApi::AddExternalReferences(std::vector<intptr_t>* refs) {
+  AppendExternalReferences(refs, {Worker, PostMessage, AddEventListener,
+                                   RemoveEventListener, Close});
+}
+
+// static
+WorkerApi* WorkerApi::AttachToParent(JsApi* api, const JsScope& scope,
+                                     WorkerThread* thread) {
+  v8::Local<v8::Function> constructor = api->GetWorkerConstructor();
+  v8::Local<v8::Value> args[] = {
+      v8::External::New(scope.isolate, nullptr),
+  };
+  v8::Local<v8::Object> object =
+      constructor->NewInstance(scope.context, 1, args).ToLocalChecked();
+  WorkerApi* worker = api->GetWorkerApi(object);
+  ASSERT(worker);
+  worker->parent_thread_ = thread;
+  scope.Set(constructor, StringId::parent, object);
+  return worker;
+}
+
+// static
+void WorkerApi::Worker(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  if (!info.IsConstructCall()) {
+    info.GetIsolate()->ThrowError("Worker is a constructor");
+    return;
+  }
+
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  v8::Local<v8::Object> thiz = info.This();
+
+  // The Worker.parent handle is created internally, which passes an External.
+  if (info.Length() == 1 && info[0]->IsExternal()) {
+    new WorkerApi(api, thiz);
+    return;
+  }
+
+  if (!api->window()) {
+    api->js()->ThrowError("Workers can't start other Workers.");
+    return;
+  }
+  if (info.Length() < 1 || !info[0]->IsString()) {
+    api->js()->ThrowError("Worker requires a module path.");
+    return;
+  }
+
+  WorkerApi* worker = new WorkerApi(api, thiz);
+  worker->Start(api->js()->ToString(info[0]));
+}
+
+void WorkerApi::Start(std::string module) {
+  JsApi* api = this->api();
+  TaskQueue* task_queue = api->task_queue();
+  WeakPtr<WorkerApi> weak_this = weak_factory_.MakeWeakPtr();
+
+  // The handlers are called in the worker thread, which is joined before the
+  // owner JsApi is deleted; the task_queue outlives it.
+  thread_ = std::make_unique<WorkerThread>(
+      std::move(module),
+      [task_queue, weak_this](WorkerMessage message) {
+        task_queue->Post([weak_this, message = std::move(message)]() mutable {
+          WorkerApi* thiz = weak_this.Get();
+          if (thiz) {
+            thiz->HandleMessage(std::move(message));
+          }
+        });
+      },
+      [task_queue, weak_this](std::string message,
+                              std::vector<std::string> stack_trace) {
+        task_queue->Post([weak_this, message = std::move(message),
+                          stack_trace = std::move(stack_trace)]() mutable {
+          WorkerApi* thiz = weak_this.Get();
+          if (thiz) {
+            thiz->HandleException(std::move(message), std::move(stack_trace));
+          }
+        });
+      },
+      [task_queue, weak_this] {
+        task_queue->Post([weak_this] {
+          WorkerApi* thiz = weak_this.Get();
+          if (thiz) {
+            thiz->HandleExit();
+          }
+        });
+      });
+
+  owner_ = api;
+  owner_->AddWorker(this);
+
+  // Hold a reference to this object until the worker exits, to prevent the
+  // GC from destroying it and its thread.
+  SetStrong();
+}
+
+// static
+void WorkerApi::PostMessage(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  ASSERT(IsJsThread());
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  WorkerApi* worker = api->GetWorkerApi(info.This());
+  if (!worker || info.Length() < 1) {
+    return;
+  }
+  if (!worker->thread_ && !worker->parent_thread_) {
+    api->js()->ThrowError("Worker closed.");
+    return;
+  }
+  WorkerMessage message;
+  if (!Serialize(api, info[0], info[1], &message)) {
+    // Throws on failures.
+    return;
+  }
+  if (worker->thread_) {
+    worker->thread_->PostMessage(std::move(message));
+  } else {
+    worker->parent_thread_->PostMessageToParent(std::move(message));
+  }
+}
+
+// static
+void WorkerApi::Close(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* api = JsApi::Get(info.GetIsolate());
+  WorkerApi* worker = api->GetWorkerApi(info.This());
+  if (!worker) {
+    return;
+  }
+  if (worker->parent_thread_) {
+    // Workers can close themselves, and their parent gets an "exit" event.
+    worker->parent_thread_->Close();
+  } else {
+    worker->Terminate();
+  }
+}
+
+// static
+void WorkerApi::AddEventListener(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* api = JsApi::Get(info.GetIsolate());
+
+  if (info.Length() < 2 || !info[0]->IsString() || !info[1]->IsFunction()) {
+    api->js()->ThrowError(
+        "addEventListener requires an event type and a callback function");
+    return;
+  }
+
+  std::string type = api->js()->ToString(info[0]);
+  v8::Local<v8::Function> f = info[1].As<v8::Function>();
+
+  WorkerApi* worker = api->GetWorkerApi(info.This());
+  if (worker) {
+    worker->events_.AddEventListener(type, f, info.GetIsolate());
+  }
+}
+
+// static
+void WorkerApi::RemoveEventListener(
+    const v8::FunctionCallbackInfo<v8::Value>& info) {
+  JsApi* api = JsApi::Get(info.GetIsolate());
+
+  if (info.Length() < 2 || !info[0]->IsString() || !info[1]->IsFunction()) {
+    api->js()->ThrowError(
+        "removeEventListener requires an event type and a callback function");
+    return;
+  }
+
+  std::string type = api->js()->ToString(info[0]);
+  v8::Local<v8::Function> f = info[1].As<v8::Function>();
+
+  WorkerApi* worker = api->GetWorkerApi(info.This());
+  if (worker) {
+    worker->events_.RemoveEventListener(type, f);
+  }
+}
+
+void WorkerApi::HandleException(std::string message,
+                                std::vector<std::string> stack_trace) {
+  ASSERT(IsJsThread());
+  JsScope scope(js());
+  v8::TryCatch try_catch(scope.isolate);
+  v8::Local<v8::Object> event = MakeWorkerExceptionEvent(
+      std::move(message), std::move(stack_trace), scope);
+  events_.Dispatch(JsEventType::CHILD_EXCEPTION, event, scope);
+  if (try_catch.HasCaught()) {
+    js()->ReportException(try_catch.Message());
+  }
+}
+
+void WorkerApi::HandleExit() {
+  ASSERT(IsJsThread());
+  if (!thread_) {
+    // Terminated by the parent, which doesn't get an "exit" event.
+    return;
+  }
+  {
+    JsScope scope(js());
+    v8::TryCatch try_catch(scope.isolate);
+    v8::Local<v8::Object> event = MakeExitEvent("", 0, scope);
+    events_.Dispatch(JsEventType::CHILD_EXIT, event, scope);
+    if (try_catch.HasCaught()) {
+      js()->ReportException(try_catch.Message());
+    }
+  }
+  Terminate();
+}
@@ -0,0 +1,64 @@
+#ifndef WINDOWJS_JS_API_WORKER_H
+#define WINDOWJS_JS_API_WORKER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <v8/include/v8.h>
+
+#include "js_api.h"
+#include "js_events.h"
+#include "js_scope.h"
+#include "weak.h"
+#include "worker.h"
+
+// A handle to a Worker: either the handle that "new Worker()" returns to the
+// parent, or the Worker.parent handle inside the worker.
+class WorkerApi final : public JsApiWrapper {
+ public:
+  WorkerApi(JsApi* api, v8::Local<v8::Object> thiz);
+  ~WorkerApi() override;
+
+  // Terminates the worker of a parent's handle, if it's still running.
+  void Terminate();
+
+  // Dispatches a message from the other side of this handle.
+  void HandleMessage(WorkerMessage message);
+
+  static v8::Local<v8::Function> GetConstructor(const JsScope& scope);
+  static void AddExternalReferences(std::vector<intptr_t>* refs);
+
+  // Creates the Worker.parent handle, in the worker thread of "thread".
+  static WorkerApi* AttachToParent(JsApi* api, const JsScope& scope,
+                                   WorkerThread* thread);
+
+ private:
+  static void Worker(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void PostMessage(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void Close(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void AddEventListener(const v8::FunctionCallbackInfo<v8::Value>& info);
+  static void RemoveEventListener(
+      const v8::FunctionCallbackInfo<v8::Value>& info);
+
+  void Start(std::string module);
+  void HandleException(std::string message,
+                       std::vector<std::string> stack_trace);
+  void HandleExit();
+
+  WeakPtrFactory<WorkerApi> weak_factory_;
+
+  // The JsApi that started the worker of a parent's handle. It terminates the
+  // worker when it's deleted.
+  JsApi* owner_;
+
+  // Set in the parent's handle while its worker is running.
+  std::unique_ptr<WorkerThread> thread_;
+
+  // Set in the Worker.parent handle.
+  WorkerThread* parent_thread_;
+
+  JsEvents events_;
+};
+
+#endif  // WINDOWJS_JS_API_WORKER_H
@@ -28,6 +28,7 @@ JsEventType GetEventType(const std::string& type) {
       {"log", JsEventType::CHILD_LOG},
       {"exception", JsEventType::CHILD_EXCEPTION},
       {"exit", JsEventType::CHILD_EXIT},
+      {"abort", JsEventType::ABORT},
   };
   auto it = types.find(type);
   return it == types.end() ? JsEventType::NO_EVENT : it->second;
@@ -487,6 +488,101 @@ v8::Local<v8::Object> MakeMouseWheelEvent(double x, double y,
   return event;
 }
 
+namespace {
+
+using MakeSampleEvent = v8::Local<v8::Object> (*)(double x, double y,
+                                                  const JsScope& scope);
+
+// The samples are kept as [x0, y0, x1, y1, ...] in the "data" of the
+// getCoalescedEvents() function, and the events are only created when it's
+// called.
+v8::Local<v8::Array> MakeSamplesArray(const std::vector<InputSample>& samples,
+                                      const JsScope& scope) {
+  std::vector<v8::Local<v8::Value>> values;
+  values.reserve(samples.size() * 2);
+  for (const InputSample& sample : samples) {
+    values.push_back(v8::Number::New(scope.isolate, sample.x));
+    values.push_back(v8::Number::New(scope.isolate, sample.y));
+  }
+  return v8::Array::New(scope.isolate, values.data(), values.size());
+}
+
+void GetCoalescedEvents(const v8::FunctionCallbackInfo<v8::Value>& args,
+                        MakeSampleEvent make_event) {
+  JsScope scope(Js::Get(args.GetIsolate()));
+  v8::Local<v8::Array> samples = args.Data().As<v8::Array>();
+  uint32_t length = samples->Length() / 2;
+  v8::Local<v8::Array> events = v8::Array::New(scope.isolate, length);
+  for (uint32_t i = 0; i < length; i++) {
+    double x = samples->Get(scope.context, 2 * i)
+                   .ToLocalChecked()
+                   .As<v8::Number>()
+                   ->Value();
+    double y = samples->Get(scope.context, 2 * i + 1)
+                   .ToLocalChecked()
+                   .As<v8::Number>()
+                   ->Value();
+    IGNORE_RESULT(events->Set(scope.context, i, make_event(x, y, scope)));
+  }
+  args.GetReturnValue().Set(events);
+}
+
+void GetCoalescedMouseMoveEvents(
+    const v8::FunctionCallbackInfo<v8::Value>& args) {
+  GetCoalescedEvents(args, MakeMouseMoveEvent);
+}
+
+void GetCoalescedMouseWheelEvents(
+    const v8::FunctionCallbackInfo<v8::Value>& args) {
+  GetCoalescedEvents(args, MakeMouseWheelEvent);
+}
+
+}  // namespace
+
+v8::Local<v8::Object> MakeCoalescedMouseMoveEvent(
+    const std::vector<InputSample>& samples, const JsScope& scope) {
+  ASSERT(!samples.empty());
+  v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
+
+  double x = samples.back().x;
+  double y = samples.back().y;
+  scope.Set(event, StringId::type, StringId::mousemove);
+  scope.Set(event, StringId::x, x);
+  scope.Set(event, StringId::y, y);
+  scope.Set(event, StringId::clientX, x);
+  scope.Set(event, StringId::clientY, y);
+  scope.Set(event, StringId::offsetX, x);
+  scope.Set(event, StringId::offsetY, y);
+  scope.Set(event, StringId::getCoalescedEvents, GetCoalescedMouseMoveEvents,
+            MakeSamplesArray(samples, scope));
+
+  event->SetIntegrityLevel(scope.context, v8::IntegrityLevel::kFrozen);
+
+  return event;
+}
+
+v8::Local<v8::Object> MakeCoalescedMouseWheelEvent(
+    const std::vector<InputSample>& samples, const JsScope& scope) {
+  ASSERT(!samples.empty());
+  v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
+
+  double x = 0;
+  double y = 0;
+  for (const InputSample& sample : samples) {
+    x += sample.x;
+    y += sample.y;
+  }
+  scope.Set(event, StringId::type, StringId::wheel);
+  scope.Set(event, StringId::deltaX, x);
+  scope.Set(event, StringId::deltaY, y);
+  scope.Set(event, StringId::getCoalescedEvents, GetCoalescedMouseWheelEvents,
+            MakeSamplesArray(samples, scope));
+
+  event->SetIntegrityLevel(scope.context, v8::IntegrityLevel::kFrozen);
+
+  return event;
+}
+
 v8::Local<v8::Object> MakeDropEvent(std::vector<std::string> paths,
                                     const JsScope& scope) {
   v8::Local<v8::Object> event = v8::Object::New(scope.isolate);
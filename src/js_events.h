@@ -32,6 +32,7 @@ enum class JsEventType {
   CHILD_LOG,
   CHILD_EXCEPTION,
   CHILD_EXIT,
+  ABORT,
   NO_EVENT,  // Must be the last entry; this is also the number of JsEventTypes.
 };
 
@@ -79,6 +80,22 @@ v8::Local<v8::Object> MakeMouseMoveEvent(double x, double y,
 v8::Local<v8::Object> MakeMouseWheelEvent(double x, double y,
                                           const JsScope& scope);
 
+// A mouse position, or a pair of wheel deltas.
+struct InputSample {
+  double x;
+  double y;
+};
+
+// Returns a "mousemove" event at the position of the last sample. Its
+// getCoalescedEvents() method returns a "mousemove" event for each sample.
+v8::Local<v8::Object> MakeCoalescedMouseMoveEvent(
+    const std::vector<InputSample>& samples, const JsScope& scope);
+
+// Returns a "wheel" event with the sum of the deltas of all the samples. Its
+// getCoalescedEvents() method returns a "wheel" event for each sample.
+v8::Local<v8::Object> MakeCoalescedMouseWheelEvent(
+    const std::vector<InputSample>& samples, const JsScope& scope);
+
 v8::Local<v8::Object> MakeDropEvent(std::vector<std::string> paths,
                                     const JsScope& scope);
 
@@ -0,0 +1,109 @@
+#include "js_platform.h"
+
+#include <utility>
+
+#include <v8/include/libplatform/libplatform.h>
+
+namespace {
+
+// The default platform only runs worker tasks until a pool is set.
+constexpr int kNumDefaultPlatformThreads = 1;
+
+}  // namespace
+
+JsPlatform::JsPlatform()
+    : default_platform_(
+          v8::platform::NewDefaultPlatform(kNumDefaultPlatformThreads)),
+      pool_(nullptr) {}
+
+JsPlatform::~JsPlatform() {}
+
+v8::PageAllocator* JsPlatform::GetPageAllocator() {
+  return default_platform_->GetPageAllocator();
+}
+
+int JsPlatform::NumberOfWorkerThreads() {
+  ThreadPoolTaskQueue* pool = pool_;
+  return pool ? pool->num_threads()
+              : default_platform_->NumberOfWorkerThreads();
+}
+
+std::shared_ptr<v8::TaskRunner> JsPlatform::GetForegroundTaskRunner(
+    v8::Isolate* isolate) {
+  return default_platform_->GetForegroundTaskRunner(isolate);
+}
+
+void JsPlatform::CallOnWorkerThread(std::unique_ptr<v8::Task> task) {
+  PostToPool(ThreadPoolTaskQueue::Priority::kNormal, std::move(task));
+}
+
+void JsPlatform::CallBlockingTaskOnWorkerThread(
+    std::unique_ptr<v8::Task> task) {
+  PostToPool(ThreadPoolTaskQueue::Priority::kUserBlocking, std::move(task));
+}
+
+void JsPlatform::CallLowPriorityTaskOnWorkerThread(
+    std::unique_ptr<v8::Task> task) {
+  PostToPool(ThreadPoolTaskQueue::Priority::kNormal, std::move(task));
+}
+
+void JsPlatform::CallDelayedOnWorkerThread(std::unique_ptr<v8::Task> task,
+                                           double delay_in_seconds) {
+  ThreadPoolTaskQueue* pool = pool_;
+  if (!pool) {
+    default_platform_->CallDelayedOnWorkerThread(std::move(task),
+                                                 delay_in_seconds);
+    return;
+  }
+  // Tasks must be copyable.
+  pool->PostPlatformTask(delay_in_seconds,
+                         [task = std::shared_ptr<v8::Task>(std::move(task))] {
+                           task->Run();
+                         });
+}
+
+bool JsPlatform::IdleTasksEnabled(v8::Isolate* isolate) {
+  return default_platform_->IdleTasksEnabled(isolate);
+}
+
+std::unique_ptr<v8::JobHandle> JsPlatform::CreateJob(
+    v8::TaskPriority priority, std::unique_ptr<v8::JobTask> job_task) {
+  // The job posts its workers with the Call*OnWorkerThread methods of this
+  // platform, which pick the pool priority.
+  return v8::platform::NewDefaultJobHandle(this, priority, std::move(job_task),
+                                           NumberOfWorkerThreads());
+}
+
+double JsPlatform::MonotonicallyIncreasingTime() {
+  return default_platform_->MonotonicallyIncreasingTime();
+}
+
+double JsPlatform::CurrentClockTimeMillis() {
+  return default_platform_->CurrentClockTimeMillis();
+}
+
+v8::Platform::StackTracePrinter JsPlatform::GetStackTracePrinter() {
+  return default_platform_->GetStackTracePrinter();
+}
+
+v8::TracingController* JsPlatform::GetTracingController() {
+  return default_platform_->GetTracingController();
+}
+
+void JsPlatform::PostToPool(ThreadPoolTaskQueue::Priority priority,
+                            std::unique_ptr<v8::Task> task) {
+  ThreadPoolTaskQueue* pool = pool_;
+  if (!pool) {
+    if (priority == ThreadPoolTaskQueue::Priority::kUserBlocking) {
+      default_platform_->CallBlockingTaskOnWorkerThread(std::move(task));
+    } else {
+      default_platform_->CallOnWorkerThread(std::move(task));
+    }
+    return;
+  }
+  // Tasks must be copyable.
+  pool->PostPlatformTask(priority,
+                         [task = std::shared_ptr<v8::Task>(std::move(task))] {
+                           task->Run();
+                         });
+}
@@ -0,0 +1,62 @@
+#ifndef WINDOWJS_JS_PLATFORM_H
+#define WINDOWJS_JS_PLATFORM_H
+
+#include <atomic>
+#include <memory>
+
+#include <v8/include/v8-platform.h>
+
+#include "task_queue.h"
+
+// The v8::Platform of Window.js. It runs the worker tasks of v8, e.g.
+// concurrent marking and compilation, in the same pool as the CPU-bound
+// background work of the Javascript APIs, so that v8 and Window.js don't
+// each spawn a thread per CPU.
+//
+// v8 tasks that block the main thread run before the other tasks of the
+// pool, and the other v8 tasks are queued in order with the Window.js tasks.
+//
+// Until a pool is set with SetWorkerPool(), e.g. when making the startup
+// snapshot, the worker tasks run in a single thread of the default platform.
+// The foreground task runners, the clock and the tracing controller always
+// come from the default platform.
+class JsPlatform final : public v8::Platform {
+ public:
+  JsPlatform();
+  ~JsPlatform() override;
+
+  JsPlatform(const JsPlatform&) = delete;
+  JsPlatform& operator=(const JsPlatform&) = delete;
+
+  // "pool" must outlive the isolates that post tasks to it. Pass nullptr to
+  // go back to the default platform, once those isolates are deleted.
+  void SetWorkerPool(ThreadPoolTaskQueue* pool) { pool_ = pool; }
+
+  v8::PageAllocator* GetPageAllocator() override;
+  int NumberOfWorkerThreads() override;
+  std::shared_ptr<v8::TaskRunner> GetForegroundTaskRunner(
+      v8::Isolate* isolate) override;
+  void CallOnWorkerThread(std::unique_ptr<v8::Task> task) override;
+  void CallBlockingTaskOnWorkerThread(std::unique_ptr<v8::Task> task) override;
+  void CallLowPriorityTaskOnWorkerThread(
+      std::unique_ptr<v8::Task> task) override;
+  void CallDelayedOnWorkerThread(std::unique_ptr<v8::Task> task,
+                                 double delay_in_seconds) override;
+  bool IdleTasksEnabled(v8::Isolate* isolate) override;
+  std::unique_ptr<v8::JobHandle> CreateJob(
+      v8::TaskPriority priority,
+      std::unique_ptr<v8::JobTask> job_task) override;
+  double MonotonicallyIncreasingTime() override;
+  double CurrentClockTimeMillis() override;
+  StackTracePrinter GetStackTracePrinter() override;
+  v8::TracingController* GetTracingController() override;
+
+ private:
+  void PostToPool(ThreadPoolTaskQueue::Priority priority,
+                  std::unique_ptr<v8::Task> task);
+
+  std::unique_ptr<v8::Platform> default_platform_;
+  std::atomic<ThreadPoolTaskQueue*> pool_;
+};
+
+#endif  // WINDOWJS_JS_PLATFORM_H
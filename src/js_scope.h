@@ -1,6 +1,10 @@
 #ifndef WINDOWJS_JS_SCOPE_H
 #define WINDOWJS_JS_SCOPE_H
 
+#include <initializer_list>
+
+#include <v8/include/v8-fast-api-calls.h>
+
 #include "js.h"
 
 struct JsScope {
@@ -117,6 +121,7 @@ struct JsScope {
   void Set(v8::Local<v8::Object> object, const char* key,
            v8::FunctionCallback function,
            v8::Local<v8::Value> data = {}) const {
+    CheckCallback(function);
     SetValue(object, key,
              v8::Function::New(context, function, data).ToLocalChecked());
   }
@@ -124,6 +129,7 @@ struct JsScope {
   void Set(v8::Local<v8::Object> object, StringId id,
            v8::FunctionCallback function,
            v8::Local<v8::Value> data = {}) const {
+    CheckCallback(function);
     SetValue(object, id,
              v8::Function::New(context, function, data).ToLocalChecked());
   }
@@ -131,6 +137,7 @@ struct JsScope {
   void Set(v8::Local<v8::Object> object, const char* key,
            v8::AccessorNameGetterCallback get,
            v8::Local<v8::External> data = {}) const {
+    CheckCallback(get);
     v8::Local<v8::String> k =
         v8::String::NewFromUtf8(isolate, key).ToLocalChecked();
     ASSERT(object->SetAccessor(context, k, get, nullptr, data).FromJust());
@@ -140,6 +147,8 @@ struct JsScope {
            v8::AccessorNameGetterCallback get,
            v8::AccessorNameSetterCallback set,
            v8::Local<v8::External> data = {}) const {
+    CheckCallback(get);
+    CheckCallback(set);
     v8::Local<v8::String> k =
         v8::String::NewFromUtf8(isolate, key).ToLocalChecked();
     ASSERT(object->SetAccessor(context, k, get, set, data).FromJust());
@@ -148,6 +157,7 @@ struct JsScope {
   void Set(v8::Local<v8::Object> object, StringId id,
            v8::AccessorNameGetterCallback get,
            v8::Local<v8::External> data = {}) const {
+    CheckCallback(get);
     ASSERT(
         object->SetAccessor(context, GetConstantString(id), get, nullptr, data)
             .FromJust());
@@ -157,6 +167,8 @@ struct JsScope {
            v8::AccessorNameGetterCallback get,
            v8::AccessorNameSetterCallback set,
            v8::Local<v8::External> data = {}) const {
+    CheckCallback(get);
+    CheckCallback(set);
     ASSERT(object->SetAccessor(context, GetConstantString(id), get, set, data)
                .FromJust());
   }
@@ -164,31 +176,72 @@ struct JsScope {
   void Set(v8::Local<v8::ObjectTemplate> prototype, StringId id,
            v8::AccessorGetterCallback getter,
            v8::AccessorSetterCallback setter = nullptr) const {
+    CheckCallback(getter);
+    CheckCallback(setter);
     prototype->SetNativeDataProperty(GetConstantString(id), getter, setter);
   }
 
   void Set(v8::Local<v8::ObjectTemplate> prototype, StringId id,
            v8::FunctionCallback function) const {
-    prototype->Set(GetConstantString(id),
-                   v8::FunctionTemplate::New(isolate, function));
+    prototype->Set(GetConstantString(id), NewFunctionTemplate(function));
+  }
+
+  // Sets a method with v8 Fast API versions: optimized code calls the "fast"
+  // overload that matches the number of arguments directly, when the receiver
+  // matches "signature" and the arguments are of its types. Other calls go to
+  // "function".
+  void Set(v8::Local<v8::ObjectTemplate> prototype, StringId id,
+           v8::Local<v8::Signature> signature, v8::FunctionCallback function,
+           std::initializer_list<v8::CFunction> fast) const {
+    CheckCallback(function);
+    for (const v8::CFunction& f : fast) {
+      CheckCallback(f.GetAddress());
+      CheckCallback(f.GetTypeInfo());
+    }
+    prototype->Set(
+        GetConstantString(id),
+        v8::FunctionTemplate::NewWithCFunctionOverloads(
+            isolate, function, {}, signature, 0,
+            v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasSideEffect,
+            {fast.begin(), fast.size()}));
   }
 
   void Set(v8::Local<v8::FunctionTemplate> templ, StringId id,
            v8::AccessorGetterCallback getter,
            v8::AccessorSetterCallback setter = nullptr) const {
+    CheckCallback(getter);
+    CheckCallback(setter);
     templ->SetNativeDataProperty(GetConstantString(id), getter, setter);
   }
 
   void Set(v8::Local<v8::FunctionTemplate> templ, StringId id,
            v8::FunctionCallback function) const {
-    templ->Set(GetConstantString(id),
-               v8::FunctionTemplate::New(isolate, function));
+    templ->Set(GetConstantString(id), NewFunctionTemplate(function));
+  }
+
+  // Constructors should be created with this too.
+  v8::Local<v8::FunctionTemplate> NewFunctionTemplate(
+      v8::FunctionCallback function) const {
+    CheckCallback(function);
+    return v8::FunctionTemplate::New(isolate, function);
   }
 
   void SetLazy(v8::Local<v8::Object> object, StringId id,
-               v8::AccessorNameGetterCallback get) const {
-    ASSERT(object->SetLazyDataProperty(context, GetConstantString(id), get)
-               .FromJust());
+               v8::AccessorNameGetterCallback get,
+               v8::Local<v8::Value> data = {}) const {
+    CheckCallback(get);
+    ASSERT(
+        object->SetLazyDataProperty(context, GetConstantString(id), get, data)
+            .FromJust());
+  }
+
+  // Callbacks installed in the startup snapshot must be in
+  // JsApi::GetExternalReferences().
+  template <typename Callback>
+  void CheckCallback(Callback callback) const {
+    if (callback) {
+      js->CheckExternalReference(reinterpret_cast<intptr_t>(callback));
+    }
   }
 };
 
@@ -1,17 +1,28 @@
 #include "js_strings.h"
 
-JsStrings::JsStrings(v8::Isolate* isolate) {
-#define SET_STRING(string)                          \
-  strings_[static_cast<int>(StringId::string)].Set( \
-      isolate, v8::String::NewFromUtf8Literal(      \
-                   isolate, #string, v8::NewStringType::kInternalized))
+#include <string_view>
 
-#define SET_SPECIAL(name, string)                 \
-  strings_[static_cast<int>(StringId::name)].Set( \
-      isolate, v8::String::NewFromUtf8Literal(    \
-                   isolate, string, v8::NewStringType::kInternalized))
+#include "fail.h"
+
+namespace {
+
+using StringTexts =
+    std::array<std::string_view, static_cast<int>(StringId::LAST_STRING_ID)>;
+
+StringTexts MakeStringTexts() {
+  StringTexts texts;
+
+#define SET_STRING(string) texts[static_cast<int>(StringId::string)] = #string
+
+#define SET_SPECIAL(name, string) \
+  texts[static_cast<int>(StringId::name)] = string
 
   SET_STRING(a);
+  SET_STRING(abort);
+  SET_STRING(AbortController);
+  SET_STRING(aborted);
+  SET_STRING(AbortError);
+  SET_STRING(AbortSignal);
   SET_STRING(actualBoundingBoxAscent);
   SET_STRING(actualBoundingBoxDescent);
   SET_STRING(actualBoundingBoxLeft);
@@ -42,6 +53,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(base64ToArrayBuffer);
   SET_STRING(basename);
   SET_STRING(beginPath);
+  SET_STRING(beginRecording);
   SET_STRING(bevel);
   SET_STRING(bezierCurveTo);
   SET_STRING(blur);
@@ -52,12 +64,15 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(button);
   SET_STRING(c);
   SET_STRING(cancelAnimationFrame);
+  SET_STRING(cancelIdleCallback);
   SET_STRING(canvas);
   SET_STRING(CanvasGradient);
   SET_STRING(CanvasPattern);
+  SET_STRING(CanvasPicture);
   SET_STRING(CanvasRenderingContext2D);
   SET_STRING(CapsLock);
   SET_STRING(center);
+  SET_STRING(clearInterval);
   SET_STRING(clearRect);
   SET_STRING(clearTimeout);
   SET_STRING(click);
@@ -68,6 +83,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(closePath);
   SET_STRING(code);
   SET_STRING(Codec);
+  SET_STRING(codeCache);
   SET_STRING(color);
   SET_STRING(Comma);
   SET_STRING(content);
@@ -77,6 +93,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(ControlRight);
   SET_STRING(copy);
   SET_STRING(copyTree);
+  SET_STRING(count);
   SET_STRING(cpus);
   SET_STRING(createImageData);
   SET_STRING(createLinearGradient);
@@ -94,10 +111,12 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(debug);
   SET_STRING(decode);
   SET_STRING(decorated);
+  SET_STRING(deferred);
   SET_STRING(Delete);
   SET_STRING(deltaX);
   SET_STRING(deltaY);
   SET_STRING(devicePixelRatio);
+  SET_STRING(didTimeout);
   SET_STRING(difference);
   SET_STRING(Digit0);
   SET_STRING(Digit1);
@@ -110,19 +129,23 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(Digit8);
   SET_STRING(Digit9);
   SET_STRING(dirname);
+  SET_STRING(drawAtlas);
   SET_STRING(drawImage);
+  SET_STRING(drawPicture);
   SET_STRING(drop);
   SET_STRING(e);
   SET_STRING(ellipse);
   SET_STRING(encode);
   SET_STRING(end);
   SET_STRING(End);  // Keep after | sort | uniq.
+  SET_STRING(endRecording);
   SET_STRING(Enter);
   SET_STRING(Equal);
   SET_STRING(error);
   SET_STRING(Escape);
   SET_STRING(exception);
   SET_STRING(exclusion);
+  SET_STRING(executed);
   SET_STRING(exit);
   SET_STRING(f);
   SET_STRING(F1);
@@ -153,7 +176,9 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(File);
   SET_STRING(files);
   SET_STRING(fill);
+  SET_STRING(fillCircles);
   SET_STRING(fillRect);
+  SET_STRING(fillRects);
   SET_STRING(fillStyle);
   SET_STRING(fillText);
   SET_STRING(focus);
@@ -163,10 +188,13 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(frameBottom);
   SET_STRING(frameLeft);
   SET_STRING(frameRight);
+  SET_STRING(framesOverBudget);
   SET_STRING(frameTop);
   SET_STRING(fullscreen);
   SET_STRING(g);
+  SET_STRING(gc);
   SET_STRING(getClipboardText);
+  SET_STRING(getCoalescedEvents);
   SET_STRING(getImageData);
   SET_STRING(getLineDash);
   SET_STRING(getTransform);
@@ -175,6 +203,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(h);
   SET_STRING(hanging);
   SET_STRING(height);
+  SET_STRING(hits);
   SET_STRING(Home);
   SET_STRING(home);
   SET_STRING(hue);
@@ -226,6 +255,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(KeyY);
   SET_STRING(KeyZ);
   SET_STRING(l);
+  SET_STRING(lastFramePause);
   SET_STRING(left);
   SET_STRING(level);
   SET_STRING(lighten);
@@ -242,8 +272,10 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(log);
   SET_STRING(luminosity);
   SET_STRING(m);
+  SET_STRING(major);
   SET_STRING(maximize);
   SET_STRING(maximized);
+  SET_STRING(maxPause);
   SET_STRING(measureText);
   SET_STRING(memory);
   SET_STRING(message);
@@ -254,7 +286,9 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(middle);
   SET_STRING(minimize);
   SET_STRING(minimized);
+  SET_STRING(minor);
   SET_STRING(Minus);
+  SET_STRING(misses);
   SET_STRING(miter);
   SET_STRING(miterLimit);
   SET_STRING(mkdirs);
@@ -266,6 +300,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(moveTo);
   SET_STRING(multiply);
   SET_STRING(n);
+  SET_STRING(name);
   SET_STRING(now);
   SET_STRING(NumLock);
   SET_STRING(Numpad0);
@@ -313,7 +348,9 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(readImageData);
   SET_STRING(readJSON);
   SET_STRING(readText);
+  SET_STRING(reason);
   SET_STRING(rect);
+  SET_STRING(rejected);
   SET_STRING(remove);
   SET_STRING(removeEventListener);
   SET_STRING(removeTree);
@@ -321,7 +358,9 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(repeat);
   SET_STRING(requestAnimationFrame);
   SET_STRING(requestAttention);
+  SET_STRING(requestIdleCallback);
   SET_STRING(resetTransform);
+  SET_STRING(residentSetSize);
   SET_STRING(resizable);
   SET_STRING(resize);
   SET_STRING(restore);
@@ -339,6 +378,7 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(sender);
   SET_STRING(sep);
   SET_STRING(setClipboardText);
+  SET_STRING(setInterval);
   SET_STRING(setLineDash);
   SET_STRING(setTimeout);
   SET_STRING(setTransform);
@@ -353,26 +393,38 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(showOverlayConsole);
   SET_STRING(showOverlayConsoleOnErrors);
   SET_STRING(showOverlayStats);
+  SET_STRING(signal);
   SET_STRING(size);
   SET_STRING(Slash);
   SET_STRING(Space);
   SET_STRING(spawn);
   SET_STRING(square);
+  SET_STRING(stacktrace);
   SET_STRING(start);
+  SET_STRING(startProfiling);
+  SET_STRING(startTracing);
   SET_STRING(status);
+  SET_STRING(stopProfiling);
+  SET_STRING(stopTracing);
   SET_STRING(stroke);
   SET_STRING(strokeRect);
+  SET_STRING(strokeRects);
   SET_STRING(strokeStyle);
   SET_STRING(strokeText);
   SET_STRING(t);
   SET_STRING(Tab);
+  SET_STRING(tasks);
   SET_STRING(textAlign);
   SET_STRING(textBaseline);
+  SET_STRING(throwIfAborted);
+  SET_STRING(timeout);
+  SET_STRING(timeRemaining);
   SET_STRING(title);
   SET_STRING(tmp);
   SET_STRING(toBase64);
   SET_STRING(top);
   SET_STRING(totalJSHeapSize);
+  SET_STRING(totalPause);
   SET_STRING(transform);
   SET_STRING(translate);
   SET_STRING(type);
@@ -387,7 +439,9 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_STRING(wheel);
   SET_STRING(width);
   SET_STRING(window);
+  SET_STRING(Worker);
   SET_STRING(write);
+  SET_STRING(writeHeapSnapshot);
   SET_STRING(x);
   SET_STRING(y);
   SET_STRING(z);
@@ -432,6 +486,53 @@ JsStrings::JsStrings(v8::Isolate* isolate) {
   SET_SPECIAL(sourceIn, "source-in");
   SET_SPECIAL(sourceOut, "source-out");
   SET_SPECIAL(sourceOver, "source-over");
+
+#undef SET_STRING
+#undef SET_SPECIAL
+
+  return texts;
 }
 
+}  // namespace
+
+JsStrings::JsStrings(v8::Isolate* isolate, bool from_snapshot)
+    : from_snapshot_(from_snapshot) {}
+
 JsStrings::~JsStrings() {}
+
+v8::Local<v8::String> JsStrings::MakeConstantString(StringId id,
+                                                    v8::Isolate* isolate) {
+  static const StringTexts texts = MakeStringTexts();
+
+  int index = static_cast<int>(id);
+  v8::Local<v8::String> string;
+  if (from_snapshot_) {
+    string = isolate->GetDataFromSnapshotOnce<v8::String>(index)
+                 .ToLocalChecked();
+  } else {
+    std::string_view text = texts[index];
+    string = v8::String::NewFromUtf8(isolate, text.data(),
+                                     v8::NewStringType::kInternalized,
+                                     static_cast<int>(text.size()))
+                 .ToLocalChecked();
+  }
+  strings_[index].Set(isolate, string);
+  return string;
+}
+
+void JsStrings::MaterializeAll(v8::Isolate* isolate) {
+  for (size_t i = 0; i < strings_.size(); i++) {
+    GetConstantString(static_cast<StringId>(i), isolate);
+  }
+}
+
+void JsStrings::AddToSnapshot(v8::SnapshotCreator* creator,
+                              v8::Isolate* isolate) {
+  // The strings are the only data added to the isolate, so their indices
+  // match their StringIds.
+  for (size_t i = 0; i < strings_.size(); i++) {
+    v8::Local<v8::String> string =
+        GetConstantString(static_cast<StringId>(i), isolate);
+    ASSERT(creator->AddData(string) == i);
+  }
+}
@@ -7,6 +7,11 @@
 
 enum class StringId {
   a,
+  abort,
+  AbortController,
+  aborted,
+  AbortError,
+  AbortSignal,
   actualBoundingBoxAscent,
   actualBoundingBoxDescent,
   actualBoundingBoxLeft,
@@ -37,6 +42,7 @@ enum class StringId {
   base64ToArrayBuffer,
   basename,
   beginPath,
+  beginRecording,
   bevel,
   bezierCurveTo,
   blur,
@@ -47,12 +53,15 @@ enum class StringId {
   button,
   c,
   cancelAnimationFrame,
+  cancelIdleCallback,
   canvas,
   CanvasGradient,
   CanvasPattern,
+  CanvasPicture,
   CanvasRenderingContext2D,
   CapsLock,
   center,
+  clearInterval,
   clearRect,
   clearTimeout,
   click,
@@ -63,6 +72,7 @@ enum class StringId {
   closePath,
   code,
   Codec,
+  codeCache,
   color,
   Comma,
   content,
@@ -72,6 +82,7 @@ enum class StringId {
   ControlRight,
   copy,
   copyTree,
+  count,
   cpus,
   createImageData,
   createLinearGradient,
@@ -89,10 +100,12 @@ enum class StringId {
   debug,
   decode,
   decorated,
+  deferred,
   Delete,
   deltaX,
   deltaY,
   devicePixelRatio,
+  didTimeout,
   difference,
   Digit0,
   Digit1,
@@ -105,19 +118,23 @@ enum class StringId {
   Digit8,
   Digit9,
   dirname,
+  drawAtlas,
   drawImage,
+  drawPicture,
   drop,
   e,
   ellipse,
   encode,
   end,
   End,  // Keep after | sort | uniq.
+  endRecording,
   Enter,
   Equal,
   error,
   Escape,
   exception,
   exclusion,
+  executed,
   exit,
   f,
   F1,
@@ -148,7 +165,9 @@ enum class StringId {
   File,
   files,
   fill,
+  fillCircles,
   fillRect,
+  fillRects,
   fillStyle,
   fillText,
   focus,
@@ -158,10 +177,13 @@ enum class StringId {
   frameBottom,
   frameLeft,
   frameRight,
+  framesOverBudget,
   frameTop,
   fullscreen,
   g,
+  gc,
   getClipboardText,
+  getCoalescedEvents,
   getImageData,
   getLineDash,
   getTransform,
@@ -170,6 +192,7 @@ enum class StringId {
   h,
   hanging,
   height,
+  hits,
   Home,
   home,
   hue,
@@ -221,6 +244,7 @@ enum class StringId {
   KeyY,
   KeyZ,
   l,
+  lastFramePause,
   left,
   level,
   lighten,
@@ -237,8 +261,10 @@ enum class StringId {
   log,
   luminosity,
   m,
+  major,
   maximize,
   maximized,
+  maxPause,
   measureText,
   memory,
   message,
@@ -249,7 +275,9 @@ enum class StringId {
   middle,
   minimize,
   minimized,
+  minor,
   Minus,
+  misses,
   miter,
   miterLimit,
   mkdirs,
@@ -261,6 +289,7 @@ enum class StringId {
   moveTo,
   multiply,
   n,
+  name,
   now,
   NumLock,
   Numpad0,
@@ -308,7 +337,9 @@ enum class StringId {
   readImageData,
   readJSON,
   readText,
+  reason,
   rect,
+  rejected,
   remove,
   removeEventListener,
   removeTree,
@@ -316,7 +347,9 @@ enum class StringId {
   repeat,
   requestAnimationFrame,
   requestAttention,
+  requestIdleCallback,
   resetTransform,
+  residentSetSize,
   resizable,
   resize,
   restore,
@@ -334,6 +367,7 @@ enum class StringId {
   sender,
   sep,
   setClipboardText,
+  setInterval,
   setLineDash,
   setTimeout,
   setTransform,
@@ -348,26 +382,38 @@ enum class StringId {
   showOverlayConsole,
   showOverlayConsoleOnErrors,
   showOverlayStats,
+  signal,
   size,
   Slash,
   Space,
   spawn,
   square,
+  stacktrace,
   start,
+  startProfiling,
+  startTracing,
   status,
+  stopProfiling,
+  stopTracing,
   stroke,
   strokeRect,
+  strokeRects,
   strokeStyle,
   strokeText,
   t,
   Tab,
+  tasks,
   textAlign,
   textBaseline,
+  throwIfAborted,
+  timeout,
+  timeRemaining,
   title,
   tmp,
   toBase64,
   top,
   totalJSHeapSize,
+  totalPause,
   transform,
   translate,
   type,
@@ -382,7 +428,9 @@ enum class StringId {
   wheel,
   width,
   window,
+  Worker,
   write,
+  writeHeapSnapshot,
   x,
   y,
   z,
@@ -433,14 +481,29 @@ enum class StringId {
 
 class JsStrings final {
  public:
-  explicit JsStrings(v8::Isolate* isolate);
+  // If "from_snapshot" then the strings are taken from the startup snapshot
+  // of the "isolate", which must have been created by AddToSnapshot().
+  // Strings are only internalized, or taken from the snapshot, on first use.
+  JsStrings(v8::Isolate* isolate, bool from_snapshot);
   ~JsStrings();
 
+  void AddToSnapshot(v8::SnapshotCreator* creator, v8::Isolate* isolate);
+
+  // Creates all the strings that haven't been used yet.
+  void MaterializeAll(v8::Isolate* isolate);
+
   v8::Local<v8::String> GetConstantString(StringId id, v8::Isolate* isolate) {
-    return strings_[static_cast<int>(id)].Get(isolate);
+    v8::Eternal<v8::String>& string = strings_[static_cast<int>(id)];
+    if (string.IsEmpty()) {
+      return MakeConstantString(id, isolate);
+    }
+    return string.Get(isolate);
   }
 
  private:
+  v8::Local<v8::String> MakeConstantString(StringId id, v8::Isolate* isolate);
+
+  bool from_snapshot_;
   std::array<v8::Eternal<v8::String>,
              static_cast<int>(StringId::LAST_STRING_ID)>
       strings_;
@@ -1,8 +1,10 @@
 #include "main.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <string_view>
 
 #include <skia/include/core/SkEncodedImageFormat.h>
 
@@ -11,9 +13,79 @@
 #include "file.h"
 #include "js_api_process.h"
 #include "json.h"
+#include "profiler.h"
 #include "thread.h"
+#include "trace.h"
 #include "version.h"
 
+extern const std::string_view kEmbeddedSnapshot;
+
+namespace {
+
+// The GC thread gives the isolate lock back to the main thread between steps
+// of this length, when the main thread has input or frames to handle.
+constexpr double kGcStepTime = 0.004;
+
+// Threads for blocking I/O mostly wait on the disk, so there can be more of
+// them than CPUs.
+int NumIoThreads() {
+  if (Args().io_threads > 0) {
+    return Args().io_threads;
+  }
+  return std::clamp(GetNumberOfCpus(), 4, 16);
+}
+
+// Leave a CPU for the main thread. These threads run the worker tasks of v8
+// too.
+int NumCpuThreads() {
+  if (Args().cpu_threads > 0) {
+    return Args().cpu_threads;
+  }
+  return std::max(1, GetNumberOfCpus() - 1);
+}
+
+// Returns the first of "<prefix>.<extension>", "<prefix>-2.<extension>", etc.
+// that doesn't exist in the current directory, or an empty path if there are
+// too many of them already.
+std::filesystem::path GetUnusedFile(std::string_view prefix,
+                                    std::string_view extension) {
+  for (int i = 1; i < 1000; i++) {
+    std::string name(prefix);
+    if (i > 1) {
+      name += "-" + std::to_string(i);
+    }
+    name += ".";
+    name += extension;
+    std::filesystem::path path = GetCwd() / name;
+    std::string error;
+    if (!IsFile(path, &error) && error.empty()) {
+      return path;
+    }
+  }
+  return {};
+}
+
+// Writes "data" to a file named by GetUnusedFile(). "what" names the content
+// in the log messages.
+void WriteToUnusedFile(std::string_view prefix, std::string_view extension,
+                       const void* data, size_t size, std::string_view what) {
+  std::filesystem::path path = GetUnusedFile(prefix, extension);
+  if (path.empty()) {
+    $(DEV) << "The " << what << " couldn't be saved: too many files!";
+    return;
+  }
+  std::string name = path.filename().u8string();
+  std::string error;
+  if (WriteFile(path, data, size, &error)) {
+    $(DEV) << "Saved " << what << " to " << name << ".";
+  } else {
+    $(DEV) << "The " << what << " couldn't be saved to " << name << ": "
+           << error;
+  }
+}
+
+}  // namespace
+
 int main(int argc, char* argv[]) {
   InitFail();
   InitArgs(argc, argv);
@@ -31,13 +103,28 @@ int main(int argc, char* argv[]) {
     $(DEV) << "[profile-startup] main() enter: " << glfwGetTime();
   }
 
+  Trace::SetThreadName("Main");
+  if (!Args().trace.empty()) {
+    Trace::Start();
+  }
+
   Js::Init(argv[0]);
+  Js::SetStartupSnapshot(kEmbeddedSnapshot, JsApi::GetExternalReferences());
   Window::Init();
 
   std::unique_ptr<Main> main = std::make_unique<Main>();
   main->RunUntilClosed();
   main.reset();
 
+  if (!Args().trace.empty()) {
+    std::string json = Trace::ToJson(Trace::Stop());
+    std::string error;
+    if (!WriteFile(Args().trace, json, &error)) {
+      std::cerr << "Failed to write trace to " << Args().trace << ": "
+                << error << "\n";
+    }
+  }
+
 #if !defined(WINDOWJS_RELEASE_BUILD)
   const bool log_shutdown = !Args().is_child_process;
 #endif
@@ -58,18 +145,36 @@ int main(int argc, char* argv[]) {
 }
 
 Main::Main()
-    : background_queue_(4),
+    : io_queue_(NumIoThreads(), "I/O worker"),
+      cpu_queue_(NumCpuThreads(), "CPU worker"),
       window_(this, 800, 600),
       gc_quit_(false),
+      gc_deadline_(0),
+      gc_yield_(false),
+      idle_deadline_(0),
       main_module_loaded_(false),
       reload_requested_(false),
-      first_load_(true) {
+      full_reload_requested_(false),
+      first_load_(true),
+      last_resize_render_(0),
+      resize_pending_(false) {
   ASSERT(IsMainThread());
   SetLogHandler(this);
   task_queue_.SetPostsEmptyEvents(true);
+  task_queue_.SetTimeBudget(Args().task_budget / 1000.0);
   window_.SetDelegate(this);
   window_.SetTitle(Args().initial_module);
-  Reload();
+  Js::SetWorkerPool(&cpu_queue_);
+  if (!Args().disable_code_cache) {
+    std::filesystem::path dir =
+        Args().code_cache.empty()
+            ? CodeCache::GetDefaultDir()
+            : std::filesystem::path(Args().code_cache);
+    if (!dir.empty()) {
+      code_cache_ = std::make_unique<CodeCache>(std::move(dir), &io_queue_);
+    }
+  }
+  Reload(true);
 }
 
 Main::~Main() {
@@ -79,9 +184,15 @@ Main::~Main() {
   gc_quit_ = true;
   gc_signal_.SetAndNotify();
   gc_thread_.join();
+  WriteStartupCpuProfile();
+  // The isolates may post tasks to cpu_queue_ until they are deleted. The
+  // JsApi terminates the Workers.
+  api_.reset();
+  js_.reset();
+  Js::SetWorkerPool(nullptr);
 }
 
-void Main::Reload() {
+void Main::Reload(bool full) {
   ASSERT(IsMainThread());
 
   window_.OnLoadingStart();
@@ -91,38 +202,62 @@ void Main::Reload() {
     glfwSetTime(0.0);
     window_.stats()->Reset();
     messages_to_console_.clear();
-    gc_quit_ = true;
-    gc_signal_.SetAndNotify();
-    gc_thread_.join();
-    events_.RemoveAll();
-    api_.reset();
-    js_.reset();
+    if (full) {
+      gc_quit_ = true;
+      gc_signal_.SetAndNotify();
+      gc_thread_.join();
+      // The startup profile ends with its isolate.
+      WriteStartupCpuProfile();
+      events_.RemoveAll();
+      api_.reset();
+      js_.reset();
+      window_.fonts_cache()->clear();
+    } else {
+      // Only the state visible to Javascript is dropped. The isolate, its
+      // heap and the GC thread are kept, and the CodeCache keeps the code of
+      // the modules in memory.
+      v8::Locker locker(js_->isolate());
+      events_.RemoveAll();
+      api_.reset();
+      js_->ResetContext();
+    }
     window_.SetWindowCanvas(nullptr);
     window_.console_overlay()->Clear();
     window_.console_overlay()->SetEnabled(false);
     window_.console_overlay()->SetEnableOnErrors(true);
     pending_events_.clear();
-    background_queue_.ResetDropAllTasks();
+    last_resize_render_ = 0;
+    resize_pending_ = false;
+    io_queue_.ResetDropAllTasks();
+    cpu_queue_.ResetDropAllTasks();
     task_queue_.ResetDropAllTasks();
   }
 
   // Recreate those objects now.
-  js_ =
-      std::make_unique<Js>(this, std::filesystem::current_path(), &task_queue_);
-  js_->isolate()->IsolateInForegroundNotification();
-  js_->isolate()->DisableMemorySavingsMode();
-  js_->isolate()->MemoryPressureNotification(v8::MemoryPressureLevel::kNone);
-  js_->isolate()->SetIdle(false);
+  if (!js_) {
+    js_ = std::make_unique<Js>(this, std::filesystem::current_path(),
+                               &task_queue_, &io_queue_, code_cache_.get());
+    js_->isolate()->IsolateInForegroundNotification();
+    js_->isolate()->DisableMemorySavingsMode();
+    js_->isolate()->MemoryPressureNotification(v8::MemoryPressureLevel::kNone);
+    js_->isolate()->SetIdle(false);
+    if (first_load_ && !Args().cpu_profile.empty()) {
+      v8::Locker locker(js_->isolate());
+      js_->profiler()->StartCpuProfile();
+    }
+  }
 
   api_ = std::make_unique<JsApi>(&window_, js_.get(), &events_, &task_queue_,
-                                 &background_queue_);
+                                 &io_queue_, &cpu_queue_);
 
   window_.stats()->SetJs(js_.get(), api_.get());
 
-  gc_quit_ = false;
-  gc_thread_ = std::thread([this] {
-    GcThread();
-  });
+  if (!gc_thread_.joinable()) {
+    gc_quit_ = false;
+    gc_thread_ = std::thread([this] {
+      GcThread();
+    });
+  }
 
   // Load the initial module again.
   if (first_load_ && Args().profile_startup) {
@@ -137,6 +272,42 @@ void Main::Reload() {
   }
 }
 
+void Main::DispatchPendingEvents(const JsScope& scope) {
+  v8::TryCatch try_catch(scope.isolate);
+  std::vector<PendingEvent> events;
+  events.swap(pending_events_);
+  for (const PendingEvent& event : events) {
+    if (events_.HasListeners(event.type)) {
+      events_.Dispatch(event.type, event.f(scope), scope);
+      if (try_catch.HasCaught()) {
+        js_->ReportException(try_catch.Message());
+        try_catch.Reset();
+      }
+    }
+  }
+}
+
+void Main::DispatchResizeEvent(const JsScope& scope) {
+  if (events_.HasListeners(JsEventType::RESIZE)) {
+    v8::TryCatch try_catch(scope.isolate);
+    v8::Local<v8::Value> event = MakeEvent(StringId::resize, scope);
+    events_.Dispatch(JsEventType::RESIZE, event, scope);
+    if (try_catch.HasCaught()) {
+      js_->ReportException(try_catch.Message());
+    }
+  }
+}
+
+bool Main::CoalesceInputSample(JsEventType type, double x, double y) {
+  // Merge into the last pending event only if it has the same type, so that
+  // events are still dispatched in the order they were received.
+  if (pending_events_.empty() || pending_events_.back().type != type) {
+    return false;
+  }
+  pending_events_.back().samples->push_back(InputSample{x, y});
+  return true;
+}
+
 void Main::OnMainModuleLoaded() {
   main_module_loaded_ = true;
   window_.OnLoadingFinished();
@@ -153,34 +324,37 @@ void Main::RunUntilClosed() {
     // The first part of the loop dispatches any input events to Javascript
     // listeners, and runs any pending tasks.
     {
+      // Waits for the GC pass in the background thread to finish.
+      Trace::Begin("frame", "GC");
       v8::Locker locker(js_->isolate());
+      Trace::End("frame", "GC");
       window_.stats()->OnGcFinished();
 
       JsScope scope(js_.get());
       v8::TryCatch try_catch(scope.isolate);
 
       // Dispatch events.
-      std::vector<PendingEvent> events;
-      events.swap(pending_events_);
-      for (const PendingEvent& event : events) {
-        if (events_.HasListeners(event.type)) {
-          events_.Dispatch(event.type, event.f(scope), scope);
-          if (try_catch.HasCaught()) {
-            js_->ReportException(try_catch.Message());
-            try_catch.Reset();
-          }
-        }
+      Trace::Begin("frame", "Events");
+      DispatchPendingEvents(scope);
+      if (resize_pending_) {
+        resize_pending_ = false;
+        DispatchResizeEvent(scope);
       }
       ASSERT(!try_catch.HasCaught());
+      Trace::End("frame", "Events");
 
       // Each task is responsible for try/catching uncaught exceptions.
+      Trace::Begin("frame", "Tasks");
       task_queue_.RunTasks();
       ASSERT(!try_catch.HasCaught());
+      Trace::End("frame", "Tasks");
       window_.stats()->OnJsFinished();
 
       // CallAnimationFrameCallbacks handles exceptions internally too.
+      Trace::Begin("frame", "AnimationFrame");
       api_->CallAnimationFrameCallbacks(scope);
       ASSERT(!try_catch.HasCaught());
+      Trace::End("frame", "AnimationFrame");
       window_.stats()->OnRafFinished();
 
       if (first_load_ && Args().profile_startup) {
@@ -188,12 +362,39 @@ void Main::RunUntilClosed() {
                << glfwGetTime();
       }
 
+      // Idle callbacks run with the slack left before the next frame has to
+      // be rendered. CallIdleCallbacks handles exceptions internally too.
+      if (api_->has_idle_callbacks()) {
+        Trace::Begin("frame", "Idle");
+        bool animating =
+            api_->has_animation_frame_callbacks() || window_.wants_frames();
+        idle_deadline_ = window_.stats()->GetIdleDeadline(animating);
+        api_->CallIdleCallbacks(scope, idle_deadline_);
+        ASSERT(!try_catch.HasCaught());
+        Trace::End("frame", "Idle");
+      }
+      window_.stats()->OnIdleFinished();
+
       // Log any Promise failures that didn't have a handler.
       js_->HandleUncaughtExceptionsInPromises();
     }
 
-    // Let the background thread do a GC pass now while we wait for vsync.
-    gc_signal_.SetAndNotify();
+    // Let the background thread do a GC pass now while we wait for vsync,
+    // with the time left until the next frame starts. Tight frames skip it.
+    {
+      bool animating =
+          api_->has_animation_frame_callbacks() || window_.wants_frames();
+      double idle_time = window_.stats()->GetGcIdleTime(animating);
+      double next_task = task_queue_.GetSecondsToNextTask();
+      if (next_task >= 0) {
+        idle_time = std::min(idle_time, next_task);
+      }
+      if (idle_time > 0) {
+        gc_deadline_ = Js::MonotonicallyIncreasingTime() + idle_time;
+        gc_yield_ = false;
+        gc_signal_.SetAndNotify();
+      }
+    }
 
     // === Loop part 2 ===
     //
@@ -207,13 +408,17 @@ void Main::RunUntilClosed() {
     // That can happen if it does a top-level await. Note that this also
     // prevents showing the main window until the module is finished.
     if (main_module_loaded_) {
+      Trace::Begin("frame", "Swap");
       window_.RenderAndSwapBuffers();
+      Trace::End("frame", "Swap");
       window_.stats()->OnSwapFinished();
     }
 
     if (reload_requested_) {
+      bool full = full_reload_requested_;
       reload_requested_ = false;
-      Reload();
+      full_reload_requested_ = false;
+      Reload(full);
     }
 
     // === Loop part 3 ===
@@ -228,6 +433,7 @@ void Main::RunUntilClosed() {
     // Case (1) just polls for events now and immediately goes into the next
     // frame. Case (2) waits "forever" until an event arrives. Case (3) waits
     // for T seconds or until an input event is received.
+    Trace::Begin("frame", "Wait");
     double timeout = GetTimeoutUntilNextFrame();
     if (timeout < 0) {
       glfwWaitEvents();
@@ -236,6 +442,11 @@ void Main::RunUntilClosed() {
     } else {
       glfwWaitEventsTimeout(timeout);
     }
+    Trace::End("frame", "Wait");
+
+    // The next frame needs the isolate lock; make a GC pass that's still
+    // running return it after its current step.
+    gc_yield_ = true;
 
     window_.stats()->OnWaitFinished();
 
@@ -247,9 +458,14 @@ double Main::GetTimeoutUntilNextFrame() const {
   double timeout = task_queue_.GetSecondsToNextTask();
 
   // Draw the next frame as soon as possible if there is a callback to
-  // requestAnimationFrame.
+  // requestAnimationFrame. Otherwise, pending idle callbacks get the next idle
+  // period once the current one has ended; polling right away would spin the
+  // loop when an idle callback reschedules itself.
   if (api_->has_animation_frame_callbacks() || window_.wants_frames()) {
     timeout = 0;
+  } else if (api_->has_idle_callbacks()) {
+    double idle = std::max(0.0, idle_deadline_ - glfwGetTime());
+    timeout = timeout < 0 ? idle : std::min(timeout, idle);
   }
 
   // If the window is minimized then don't render on every vsync until it's
@@ -262,14 +478,32 @@ double Main::GetTimeoutUntilNextFrame() const {
 }
 
 void Main::GcThread() {
+  Trace::SetThreadName("GC");
   for (;;) {
     gc_signal_.WaitAndClear();
     if (gc_quit_) {
       return;
     }
-    v8::Locker locker(js_->isolate());
-    js_->isolate()->IdleNotificationDeadline(Js::MonotonicallyIncreasingTime() +
-                                             0.001);
+    // Idle periods can last up to 50 ms when nothing is animating. They run
+    // in short steps, so that input that arrives meanwhile doesn't wait for
+    // the whole period.
+    while (!gc_yield_) {
+      // The deadline may have passed already if the main thread took the
+      // lock first.
+      double now = Js::MonotonicallyIncreasingTime();
+      double deadline = gc_deadline_;
+      if (deadline <= now) {
+        break;
+      }
+      v8::Locker locker(js_->isolate());
+      Trace::Begin("gc", "IdleNotification");
+      bool done = js_->isolate()->IdleNotificationDeadline(
+          std::min(deadline, now + kGcStepTime));
+      Trace::End("gc", "IdleNotification");
+      if (done) {
+        break;
+      }
+    }
   }
 }
 
@@ -284,15 +518,18 @@ void Main::ShowConsole() {
         std::move(exe), std::move(args), Args().log,
         [this](uint32_t type, std::string message) {
           // Called on the Pipe's background thread.
-          task_queue_.Post([this, message = std::move(message)] {
-            HandleMessageFromConsoleProcess(std::move(message));
-          });
+          task_queue_.Post(TaskPriority::kInput,
+                           [this, message = std::move(message)] {
+                             HandleMessageFromConsoleProcess(
+                                 std::move(message));
+                           });
         },
         [this](int64_t status, std::string error) {
           // Called on the Pipe's background thread.
-          task_queue_.Post([this, error = std::move(error)] {
-            HandleConsoleProcessExit(std::move(error));
-          });
+          task_queue_.Post(TaskPriority::kInput,
+                           [this, error = std::move(error)] {
+                             HandleConsoleProcessExit(std::move(error));
+                           });
         });
     std::stringstream json;
     json << "{\"type\":\"init\"";
@@ -324,32 +561,71 @@ void Main::SaveScreenshot() {
   // thread.
   image = image->makeNonTextureImage();
   ASSERT(image);
-  background_queue_.Post([image]() {
+  cpu_queue_.Post([image]() {
     sk_sp<SkData> data = image->encodeToData(SkEncodedImageFormat::kPNG, 100);
     ASSERT(data);
-    for (int i = 1; i < 1000; i++) {
-      std::string name;
-      if (i == 1) {
-        name = "Screenshot.png";
-      } else {
-        name = "Screenshot-" + std::to_string(i) + ".png";
-      }
-      std::filesystem::path path = GetCwd() / name;
-      std::string error;
-      if (IsFile(path, &error) || !error.empty()) {
-        continue;
-      }
-      if (WriteFile(path, data->data(), data->size(), &error)) {
-        $(DEV) << "Saved screenshot to " << name << ".";
-      } else {
-        $(DEV) << "Screenshot couldn't be saved to " << name << ": " << error;
-      }
-      return;
+    WriteToUnusedFile("Screenshot", "png", data->data(), data->size(),
+                      "screenshot");
+  });
+}
+
+void Main::ToggleCpuProfile() {
+  v8::Locker locker(js_->isolate());
+  Profiler* profiler = js_->profiler();
+  if (profiler->StartCpuProfile()) {
+    $(DEV) << "Started CPU profiling. Press F7 again to stop.";
+    return;
+  }
+  // The profile is copied now, and converted to JSON and written in the
+  // background.
+  auto profile =
+      std::make_shared<Profiler::CpuProfile>(profiler->StopCpuProfile());
+  io_queue_.Post([profile] {
+    std::string json = Profiler::ToJson(*profile);
+    WriteToUnusedFile("Profile", "cpuprofile", json.data(), json.size(),
+                      "CPU profile");
+  });
+}
+
+void Main::WriteHeapSnapshot() {
+  std::filesystem::path path = GetUnusedFile("Heap", "heapsnapshot");
+  if (path.empty()) {
+    $(DEV) << "The heap snapshot couldn't be saved: too many files!";
+    return;
+  }
+  std::string name = path.filename().u8string();
+  Profiler::FinishWriting finish;
+  {
+    v8::Locker locker(js_->isolate());
+    finish = js_->profiler()->WriteHeapSnapshot(path, &io_queue_);
+  }
+  io_queue_.Post([finish = std::move(finish), name = std::move(name)] {
+    std::string error;
+    if (finish(&error)) {
+      $(DEV) << "Saved heap snapshot to " << name << ".";
+    } else {
+      $(DEV) << "The heap snapshot couldn't be saved to " << name << ": "
+             << error;
     }
-    $(DEV) << "Screenshot couldn't be saved: too many screenshots!";
   });
 }
 
+void Main::WriteStartupCpuProfile() {
+  if (Args().cpu_profile.empty() || !js_->profiler()->is_profiling()) {
+    return;
+  }
+  std::string json;
+  {
+    v8::Locker locker(js_->isolate());
+    json = Profiler::ToJson(js_->profiler()->StopCpuProfile());
+  }
+  std::string error;
+  if (!WriteFile(Args().cpu_profile, json, &error)) {
+    std::cerr << "Failed to write the CPU profile to " << Args().cpu_profile
+              << ": " << error << "\n";
+  }
+}
+
 void Main::HandleMessageFromConsoleProcess(std::string message) {
   ASSERT(IsMainThread());
   std::string error;
@@ -363,8 +639,15 @@ void Main::HandleMessageFromConsoleProcess(std::string message) {
     OnClose();
   } else if (type.String() == "reload") {
     reload_requested_ = true;
+  } else if (type.String() == "full-reload") {
+    reload_requested_ = true;
+    full_reload_requested_ = true;
   } else if (type.String() == "screenshot") {
     SaveScreenshot();
+  } else if (type.String() == "cpu-profile") {
+    ToggleCpuProfile();
+  } else if (type.String() == "heap-snapshot") {
+    WriteHeapSnapshot();
   } else if (type.String() == "focus") {
     window_.Focus();
   } else if (type.String() == "fps") {
@@ -417,6 +700,7 @@ void Main::OnLog(std::string message, ConsoleLogLevel level) {
       "{\"type\": \"log\", \"message\":" + Json::EscapeString(message) +
       ", \"level\":\"" + ConsoleLogLevelToString(level) + "\"}";
   task_queue_.Post(
+      TaskPriority::kLogging,
       [this, json = std::move(json), message = std::move(message), level] {
         if (Args().is_child_process) {
           api_->parent_process()->SendMessage(ProcessApi::LOG, std::move(json));
@@ -430,7 +714,7 @@ void Main::OnLog(std::string message, ConsoleLogLevel level) {
 void Main::OnClearLogs() {
   // Can be called on any thread. This is synchronized via SetLogHandler.
   if (!Args().is_child_process) {
-    task_queue_.Post([this] {
+    task_queue_.Post(TaskPriority::kLogging, [this] {
       if (console_) {
         std::string json = "{\"type\": \"clearLogs\"}";
         PostMessageToConsole(std::move(json));
@@ -490,13 +774,18 @@ void Main::OnKey(int key, int scancode, int action, int mods) {
       } else if (key == GLFW_KEY_F4 && action == GLFW_PRESS) {
         window_.console_overlay()->SetEnabled(
             !window_.console_overlay()->is_enabled());
+      } else if (key == GLFW_KEY_F7 && action == GLFW_PRESS) {
+        ToggleCpuProfile();
       } else if (key == GLFW_KEY_F8 && action == GLFW_PRESS) {
         SaveScreenshot();
+      } else if (key == GLFW_KEY_F9 && action == GLFW_PRESS) {
+        WriteHeapSnapshot();
       }
     }
     if (key == GLFW_KEY_F5 && action == GLFW_PRESS) {
       if (!Args().is_child_process || (mods & GLFW_MOD_CONTROL) != 0) {
         reload_requested_ = true;
+        full_reload_requested_ = (mods & GLFW_MOD_SHIFT) != 0;
         return;
       }
     }
@@ -530,10 +819,15 @@ void Main::OnCharacter(unsigned int codepoint) {
 }
 
 void Main::OnMouseMove(double x, double y) {
+  if (CoalesceInputSample(JsEventType::MOUSEMOVE, x, y)) {
+    return;
+  }
+  auto samples =
+      std::make_shared<std::vector<InputSample>>(1, InputSample{x, y});
   auto f = [=](const JsScope& scope) {
-    return MakeMouseMoveEvent(x, y, scope);
+    return MakeCoalescedMouseMoveEvent(*samples, scope);
   };
-  pending_events_.push_back({JsEventType::MOUSEMOVE, f});
+  pending_events_.push_back({JsEventType::MOUSEMOVE, f, samples});
 }
 
 void Main::OnMouseButton(int button, bool pressed, double x, double y) {
@@ -551,10 +845,15 @@ void Main::OnMouseButton(int button, bool pressed, double x, double y) {
 }
 
 void Main::OnMouseWheel(double x, double y) {
+  if (CoalesceInputSample(JsEventType::WHEEL, x, y)) {
+    return;
+  }
+  auto samples =
+      std::make_shared<std::vector<InputSample>>(1, InputSample{x, y});
   auto f = [=](const JsScope& scope) {
-    return MakeMouseWheelEvent(x, y, scope);
+    return MakeCoalescedMouseWheelEvent(*samples, scope);
   };
-  pending_events_.push_back({JsEventType::WHEEL, f});
+  pending_events_.push_back({JsEventType::WHEEL, f, samples});
 }
 
 void Main::OnMouseEnter(bool entered) {
@@ -585,6 +884,17 @@ void Main::OnResize(int width, int height) {
   // event immediately, and swap the updated buffer to the screen.
   //
   // This makes resizes smoother (i.e. black borders aren't visible).
+  //
+  // Resize gestures can report several resizes per vsync interval, though.
+  // Only one per interval is dispatched and rendered from here; the others are
+  // coalesced into the next one. The main loop doesn't run during the whole
+  // gesture on Windows, so this can't wait for the next frame.
+  if (glfwGetTime() - last_resize_render_ <
+      window_.stats()->frame_interval()) {
+    resize_pending_ = true;
+    return;
+  }
+
   bool has_resize_callbacks = events_.HasListeners(JsEventType::RESIZE);
   bool has_raf_callbacks = api_->has_animation_frame_callbacks();
 
@@ -596,26 +906,8 @@ void Main::OnResize(int width, int height) {
     // Dispatch any pending events now too. This makes sure that "minimize",
     // "maximize" and "restore" events are received before their corresponding
     // "resize" events.
-    std::vector<PendingEvent> events;
-    events.swap(pending_events_);
-    for (const PendingEvent& event : events) {
-      if (events_.HasListeners(event.type)) {
-        events_.Dispatch(event.type, event.f(scope), scope);
-        if (try_catch.HasCaught()) {
-          js_->ReportException(try_catch.Message());
-          try_catch.Reset();
-        }
-      }
-    }
-
-    if (has_resize_callbacks) {
-      v8::Local<v8::Value> event = MakeEvent(StringId::resize, scope);
-      events_.Dispatch(JsEventType::RESIZE, event, scope);
-      if (try_catch.HasCaught()) {
-        js_->ReportException(try_catch.Message());
-        try_catch.Reset();
-      }
-    }
+    DispatchPendingEvents(scope);
+    DispatchResizeEvent(scope);
 
     // The 'resize' event might have scheduled a requestAnimationFrame.
     if (main_module_loaded_) {
@@ -629,7 +921,9 @@ void Main::OnResize(int width, int height) {
     // if the initial code does window.width = 1024, for example; we should
     // only show the first frame after the entire initial loading has finished.
     window_.RenderAndSwapBuffers();
+    last_resize_render_ = glfwGetTime();
   }
+  resize_pending_ = false;
 }
 
 void Main::OnClose() {
@@ -1,6 +1,7 @@
 #ifndef WINDOWJS_MAIN_H
 #define WINDOWJS_MAIN_H
 
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <memory>
@@ -9,6 +10,7 @@
 #include <thread>
 #include <vector>
 
+#include "code_cache.h"
 #include "console.h"
 #include "js.h"
 #include "js_api.h"
@@ -52,24 +54,41 @@ class Main final : public Js::Delegate, public Window::Delegate, LogHandler {
   struct PendingEvent {
     JsEventType type;
     std::function<v8::Local<v8::Value>(const JsScope&)> f;
+    // The samples coalesced into a "mousemove" or "wheel" event. "f" shares
+    // them, so that later samples can still be merged before dispatching.
+    std::shared_ptr<std::vector<InputSample>> samples;
   };
 
-  void Reload();
+  // A fast reload keeps the isolate and creates a new context in it; a full
+  // reload also recreates the isolate and drops the caches of the window.
+  void Reload(bool full);
+  void DispatchPendingEvents(const JsScope& scope);
+  void DispatchResizeEvent(const JsScope& scope);
+  bool CoalesceInputSample(JsEventType type, double x, double y);
   void AttachToParentProcess();
   double GetTimeoutUntilNextFrame() const;
   void UpdateStats();
   void GcThread();
   void ShowConsole();
   void SaveScreenshot();
+  void ToggleCpuProfile();
+  void WriteHeapSnapshot();
+  // Writes the profile started by --cpu-profile, if it's still recording.
+  void WriteStartupCpuProfile();
   void HandleMessageFromConsoleProcess(std::string message);
   void HandleConsoleProcessExit(std::string error);
   void PostMessageToConsole(std::string json);
 
   // This order is important. Background tasks may reference the TaskQueue
   // and post tasks to the foreground, so task_queue_ must be valid as long as
-  // background_queue_ is still valid too. See PostToBackgroundAndResolve.
+  // the background queues are still valid too. See PostToBackgroundAndResolve.
   TaskQueue task_queue_;
-  ThreadPoolTaskQueue background_queue_;
+  // Background threads for blocking I/O, and for CPU-bound work. The worker
+  // tasks of v8 run in cpu_queue_ too.
+  ThreadPoolTaskQueue io_queue_;
+  ThreadPoolTaskQueue cpu_queue_;
+  // Null if the code cache is disabled. Writes to io_queue_.
+  std::unique_ptr<CodeCache> code_cache_;
 
   std::vector<PendingEvent> pending_events_;
   JsEvents events_;
@@ -80,11 +99,27 @@ class Main final : public Js::Delegate, public Window::Delegate, LogHandler {
   std::thread gc_thread_;
   Signal gc_signal_;
   bool gc_quit_;
+  // Until when the GC thread can run after gc_signal_, in the time base of
+  // Js::MonotonicallyIncreasingTime().
+  std::atomic<double> gc_deadline_;
+  // Set by the main thread when it needs the isolate lock back. The GC thread
+  // checks it between its steps.
+  std::atomic<bool> gc_yield_;
+  // The deadline of the last idle period, in the time base of glfwGetTime().
+  double idle_deadline_;
 
   bool main_module_loaded_;
   bool reload_requested_;
+  bool full_reload_requested_;
   bool first_load_;
 
+  // When OnResize() last dispatched and rendered a resize, in the time base of
+  // glfwGetTime(). Resizes within a vsync interval after that only set
+  // resize_pending_, and a single "resize" event is dispatched by the next
+  // frame or by the next resize that gets rendered.
+  double last_resize_render_;
+  bool resize_pending_;
+
   std::unique_ptr<Pipe> console_;
   std::deque<std::string> messages_to_console_;
 };
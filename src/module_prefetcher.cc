@@ -0,0 +1,204 @@
+#include "module_prefetcher.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "file.h"
+#include "util.h"
+
+namespace {
+
+struct Graph {
+  ThreadPoolTaskQueue* io_queue;
+  ModulePrefetcher::Callback done;
+
+  std::mutex lock;
+  // Paths that have been read or are being read, and the "skip" paths.
+  std::unordered_set<std::string> seen;
+  ModulePrefetcher::Sources sources;
+  // Number of reads that haven't finished yet.
+  int pending = 0;
+};
+
+bool IsIdentifierChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+// Whether a "/" after "c" starts a regular expression, rather than being a
+// division. This doesn't handle keywords like "return /re/", which just makes
+// the scan miss some imports.
+bool CanPrecedeRegExp(char c) {
+  switch (c) {
+    case '\0':
+    case '(':
+    case ',':
+    case '=':
+    case ':':
+    case '[':
+    case '!':
+    case '&':
+    case '|':
+    case '?':
+    case '{':
+    case '}':
+    case ';':
+      return true;
+    default:
+      return false;
+  }
+}
+
+void Read(std::shared_ptr<Graph> graph, std::filesystem::path path) {
+  graph->io_queue->Post([graph, path = std::move(path)] {
+    std::string content;
+    std::string error;
+    bool ok = ReadFile(path, &content, &error);
+
+    std::vector<std::filesystem::path> imports;
+    if (ok) {
+      std::filesystem::path dir = path;
+      dir.remove_filename();
+      for (const std::string& spec : ModulePrefetcher::ScanImports(content)) {
+        imports.push_back((dir / spec).lexically_normal());
+      }
+    }
+
+    std::vector<std::filesystem::path> next;
+    bool last;
+    {
+      std::lock_guard<std::mutex> lock(graph->lock);
+      if (ok) {
+        graph->sources[path.string()] = std::move(content);
+      }
+      for (std::filesystem::path& import : imports) {
+        if (graph->seen.insert(import.string()).second) {
+          next.push_back(std::move(import));
+        }
+      }
+      // Count the new reads before this one finishes, so that "pending" only
+      // gets to 0 after the last read.
+      graph->pending += static_cast<int>(next.size());
+      graph->pending--;
+      last = graph->pending == 0;
+    }
+
+    for (std::filesystem::path& import : next) {
+      Read(graph, std::move(import));
+    }
+
+    if (last) {
+      // No other thread accesses the graph after the last read.
+      graph->done(std::move(graph->sources));
+    }
+  });
+}
+
+}  // namespace
+
+// static
+void ModulePrefetcher::Prefetch(const std::filesystem::path& path,
+                                std::unordered_set<std::string> skip,
+                                ThreadPoolTaskQueue* io_queue, Callback done) {
+  auto graph = std::make_shared<Graph>();
+  graph->io_queue = io_queue;
+  graph->done = std::move(done);
+  graph->seen = std::move(skip);
+  graph->seen.insert(path.string());
+  graph->pending = 1;
+  Read(std::move(graph), path);
+}
+
+// static
+std::vector<std::string> ModulePrefetcher::ScanImports(
+    std::string_view source) {
+  // The last token that can precede a specifier.
+  enum class Token {
+    OTHER,
+    IMPORT,
+    FROM,
+  };
+
+  std::vector<std::string> specs;
+  Token token = Token::OTHER;
+  // The last character that isn't whitespace or part of a comment.
+  char last = '\0';
+  size_t i = 0;
+  size_t n = source.size();
+
+  while (i < n) {
+    char c = source[i];
+
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      i++;
+    } else if (c == '/' && i + 1 < n && source[i + 1] == '/') {
+      i = source.find('\n', i);
+      i = i == std::string_view::npos ? n : i + 1;
+    } else if (c == '/' && i + 1 < n && source[i + 1] == '*') {
+      i = source.find("*/", i + 2);
+      i = i == std::string_view::npos ? n : i + 2;
+    } else if (c == '/' && CanPrecedeRegExp(last)) {
+      // Skip the regular expression, including its classes.
+      bool in_class = false;
+      for (i++; i < n && source[i] != '\n'; i++) {
+        if (source[i] == '\\') {
+          i++;
+        } else if (source[i] == '[') {
+          in_class = true;
+        } else if (source[i] == ']') {
+          in_class = false;
+        } else if (source[i] == '/' && !in_class) {
+          i++;
+          break;
+        }
+      }
+      token = Token::OTHER;
+      last = '/';
+    } else if (c == '"' || c == '\'' || c == '`') {
+      size_t begin = ++i;
+      bool escaped = false;
+      while (i < n && source[i] != c) {
+        if (source[i] == '\\') {
+          escaped = true;
+          i++;
+        }
+        i++;
+      }
+      std::string_view literal = source.substr(begin, std::min(i, n) - begin);
+      i++;
+      if (c != '`' && !escaped && token != Token::OTHER &&
+          (StartsWith(literal, "./") || StartsWith(literal, "../"))) {
+        specs.emplace_back(literal);
+      }
+      token = Token::OTHER;
+      last = c;
+    } else if (IsIdentifierChar(c)) {
+      size_t begin = i;
+      while (i < n && IsIdentifierChar(source[i])) {
+        i++;
+      }
+      std::string_view word = source.substr(begin, i - begin);
+      // Property names like "x.import" and "x.from" aren't keywords.
+      if (last == '.') {
+        token = Token::OTHER;
+      } else if (word == "import") {
+        token = Token::IMPORT;
+      } else if (word == "from") {
+        token = Token::FROM;
+      } else {
+        token = Token::OTHER;
+      }
+      last = source[i - 1];
+    } else {
+      // This includes the "(" of import() calls: dynamic imports are loaded
+      // when they run, and may never run at all.
+      token = Token::OTHER;
+      last = c;
+      i++;
+    }
+  }
+
+  return specs;
+}
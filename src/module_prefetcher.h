@@ -0,0 +1,44 @@
+#ifndef WINDOWJS_MODULE_PREFETCHER_H
+#define WINDOWJS_MODULE_PREFETCHER_H
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "task_queue.h"
+
+// Reads a graph of ES modules in parallel, in the background.
+//
+// Each module is read in the I/O pool and scanned for the specifiers of its
+// imports, and then the modules that it imports are read in parallel too.
+// Js then compiles the whole graph from memory, instead of reading each file
+// in the main thread when it's reached.
+//
+// The scan is a lightweight lexer and not a full parse. Modules that it misses
+// are read by Js when they're needed, and files that it reads by mistake are
+// just dropped; errors are always reported by Js.
+class ModulePrefetcher final {
+ public:
+  // Module sources, by their lexically normal path. Files that failed to read
+  // aren't included.
+  using Sources = std::unordered_map<std::string, std::string>;
+
+  // Called in a background thread once all the reads have finished.
+  using Callback = std::function<void(Sources sources)>;
+
+  // Reads the module at "path" and everything it imports, except the modules
+  // in "skip" and what they import. "path" must be lexically normal.
+  static void Prefetch(const std::filesystem::path& path,
+                       std::unordered_set<std::string> skip,
+                       ThreadPoolTaskQueue* io_queue, Callback done);
+
+  // Returns the relative specifiers in the static imports and re-exports of
+  // "source". Specifiers in import() calls aren't included.
+  static std::vector<std::string> ScanImports(std::string_view source);
+};
+
+#endif  // WINDOWJS_MODULE_PREFETCHER_H
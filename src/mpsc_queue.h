@@ -0,0 +1,66 @@
+#ifndef WINDOWJS_MPSC_QUEUE_H
+#define WINDOWJS_MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// A lock-free, unbounded, multiple-producer single-consumer queue.
+//
+// Push() can be called concurrently from any thread. Pop() and empty() must
+// only be called from a single consumer thread.
+//
+// This is based on Dmitry Vyukov's intrusive MPSC node-based queue. Push() is
+// wait-free; Pop() may briefly see the queue as empty while a concurrent
+// Push() is half-way done, and the element becomes visible once that Push()
+// returns.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(new Node), tail_(head_.load()) {}
+
+  ~MpscQueue() {
+    T value;
+    while (Pop(&value)) {
+    }
+    delete tail_;
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  void Push(T value) {
+    Node* node = new Node;
+    node->value = std::move(value);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  bool Pop(T* value) {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (!next) {
+      return false;
+    }
+    // "next" becomes the new dummy node at the tail.
+    *value = std::move(next->value);
+    tail_ = next;
+    delete tail;
+    return true;
+  }
+
+  bool empty() const {
+    return tail_->next.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  struct Node {
+    std::atomic<Node*> next{nullptr};
+    T value;
+  };
+
+  // Producers push at the head, the consumer pops from the tail.
+  std::atomic<Node*> head_;
+  Node* tail_;
+};
+
+#endif  // WINDOWJS_MPSC_QUEUE_H
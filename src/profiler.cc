@@ -0,0 +1,273 @@
+#include "profiler.h"
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <utility>
+
+#include <errno.h>
+#include <string.h>
+
+#include "fail.h"
+#include "json.h"
+#include "task_queue.h"
+
+namespace {
+
+// Same as "node --cpu-prof". Shorter intervals make the sampler thread
+// compete with the frames for CPU time.
+constexpr int kSamplingIntervalUs = 1000;
+
+constexpr char kProfileTitle[] = "windowjs";
+
+constexpr int kHeapSnapshotChunkSize = 64 * 1024;
+
+// How many chunks of a heap snapshot can wait to be written before the
+// serialization waits for them.
+constexpr size_t kMaxPendingChunks = 16;
+
+// Receives the chunks of a serialized heap snapshot in the thread of the
+// isolate, and writes them to a file in tasks of an I/O queue. Only one task
+// writes at a time, so the chunks are written in order even though the queue
+// has many threads. The serialization is aborted if a write fails.
+class HeapSnapshotWriter final
+    : public v8::OutputStream,
+      public std::enable_shared_from_this<HeapSnapshotWriter> {
+ public:
+  HeapSnapshotWriter(std::filesystem::path path, ThreadPoolTaskQueue* io_queue)
+      : path_(std::move(path)), io_queue_(io_queue) {}
+
+  void EndOfStream() override {}
+
+  int GetChunkSize() override { return kHeapSnapshotChunkSize; }
+
+  WriteResult WriteAsciiChunk(char* data, int size) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] {
+      return chunks_.size() < kMaxPendingChunks || !error_.empty();
+    });
+    if (!error_.empty()) {
+      return kAbort;
+    }
+    chunks_.emplace_back(data, size);
+    if (!write_posted_) {
+      write_posted_ = true;
+      io_queue_->Post([self = shared_from_this()] { self->Write(); });
+    }
+    return kContinue;
+  }
+
+  // Called in the I/O queue once the serialization is over.
+  bool Finish(std::string* error) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // A task that is already writing has to finish first. Tasks that haven't
+    // started yet won't write anymore.
+    cond_.wait(lock, [this] { return !writing_; });
+    writing_ = true;
+    finished_ = true;
+    WriteChunks(lock);
+    if (!error_.empty()) {
+      *error = error_;
+      return false;
+    }
+    lock.unlock();
+
+    if (!Open(error)) {
+      return false;
+    }
+    file_.close();
+    if (file_.fail()) {
+      *error =
+          "Failed to write to " + path_.u8string() + ": " + strerror(errno);
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  void Write() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    write_posted_ = false;
+    if (writing_ || finished_) {
+      // The task that is writing takes the new chunks too.
+      return;
+    }
+    writing_ = true;
+    WriteChunks(lock);
+    writing_ = false;
+    cond_.notify_all();
+  }
+
+  // Writes the pending chunks until there are none left. The file is only
+  // used by the task that set writing_, without holding the lock.
+  void WriteChunks(std::unique_lock<std::mutex>& lock) {
+    while (!chunks_.empty() && error_.empty()) {
+      std::string chunk = std::move(chunks_.front());
+      chunks_.pop_front();
+      cond_.notify_all();
+      lock.unlock();
+      std::string error;
+      if (Open(&error)) {
+        file_.write(chunk.data(), chunk.size());
+        if (file_.fail()) {
+          error = "Failed to write to " + path_.u8string() + ": " +
+                  strerror(errno);
+        }
+      }
+      lock.lock();
+      if (!error.empty()) {
+        error_ = std::move(error);
+        chunks_.clear();
+        cond_.notify_all();
+      }
+    }
+  }
+
+  bool Open(std::string* error) {
+    if (!file_.is_open()) {
+      file_.open(path_, std::ios::binary);
+      if (!file_.is_open()) {
+        *error = "Failed to open " + path_.u8string() +
+                 " for writing: " + strerror(errno);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const std::filesystem::path path_;
+  ThreadPoolTaskQueue* io_queue_;
+  std::ofstream file_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::string> chunks_;
+  std::string error_;
+  bool write_posted_ = false;
+  bool writing_ = false;
+  bool finished_ = false;
+};
+
+void CopyNode(const v8::CpuProfileNode* node, Profiler::CpuProfile* profile) {
+  Profiler::CpuProfile::Node copy;
+  copy.id = node->GetNodeId();
+  copy.function_name = node->GetFunctionNameStr();
+  copy.url = node->GetScriptResourceNameStr();
+  copy.script_id = node->GetScriptId();
+  copy.line = node->GetLineNumber();
+  copy.column = node->GetColumnNumber();
+  copy.hit_count = node->GetHitCount();
+  int count = node->GetChildrenCount();
+  for (int i = 0; i < count; i++) {
+    copy.children.push_back(node->GetChild(i)->GetNodeId());
+  }
+  profile->nodes.emplace_back(std::move(copy));
+  for (int i = 0; i < count; i++) {
+    CopyNode(node->GetChild(i), profile);
+  }
+}
+
+}  // namespace
+
+Profiler::Profiler(v8::Isolate* isolate)
+    : isolate_(isolate), cpu_profiler_(nullptr) {}
+
+Profiler::~Profiler() {
+  if (cpu_profiler_) {
+    StopCpuProfile();
+  }
+}
+
+bool Profiler::StartCpuProfile() {
+  if (cpu_profiler_) {
+    return false;
+  }
+  cpu_profiler_ = v8::CpuProfiler::New(isolate_);
+  cpu_profiler_->SetSamplingInterval(kSamplingIntervalUs);
+  v8::HandleScope handle_scope(isolate_);
+  cpu_profiler_->StartProfiling(
+      v8::String::NewFromUtf8Literal(isolate_, kProfileTitle), true);
+  return true;
+}
+
+Profiler::CpuProfile Profiler::StopCpuProfile() {
+  ASSERT(cpu_profiler_);
+  CpuProfile copy;
+  {
+    v8::HandleScope handle_scope(isolate_);
+    v8::CpuProfile* profile = cpu_profiler_->StopProfiling(
+        v8::String::NewFromUtf8Literal(isolate_, kProfileTitle));
+    if (profile) {
+      CopyNode(profile->GetTopDownRoot(), &copy);
+      copy.start_time = profile->GetStartTime();
+      copy.end_time = profile->GetEndTime();
+      int count = profile->GetSamplesCount();
+      copy.samples.reserve(count);
+      copy.timestamps.reserve(count);
+      for (int i = 0; i < count; i++) {
+        copy.samples.push_back(profile->GetSample(i)->GetNodeId());
+        copy.timestamps.push_back(profile->GetSampleTimestamp(i));
+      }
+      profile->Delete();
+    }
+  }
+  cpu_profiler_->Dispose();
+  cpu_profiler_ = nullptr;
+  return copy;
+}
+
+// static
+std::string Profiler::ToJson(const CpuProfile& profile) {
+  // See the Profile type of the Chrome DevTools protocol. Its line and column
+  // numbers are 0-based, and -1 if unknown.
+  std::ostringstream out;
+  out << "{\"nodes\":[";
+  for (size_t i = 0; i < profile.nodes.size(); i++) {
+    const CpuProfile::Node& node = profile.nodes[i];
+    if (i > 0) {
+      out << ",\n";
+    }
+    out << "{\"id\":" << node.id << ",\"callFrame\":{\"functionName\":"
+        << Json::EscapeString(node.function_name) << ",\"scriptId\":\""
+        << node.script_id << "\",\"url\":" << Json::EscapeString(node.url)
+        << ",\"lineNumber\":" << node.line - 1
+        << ",\"columnNumber\":" << node.column - 1
+        << "},\"hitCount\":" << node.hit_count << ",\"children\":[";
+    for (size_t j = 0; j < node.children.size(); j++) {
+      out << (j > 0 ? "," : "") << node.children[j];
+    }
+    out << "]}";
+  }
+  out << "],\"startTime\":" << profile.start_time
+      << ",\"endTime\":" << profile.end_time << ",\"samples\":[";
+  for (size_t i = 0; i < profile.samples.size(); i++) {
+    out << (i > 0 ? "," : "") << profile.samples[i];
+  }
+  // The timestamps are deltas from the previous sample.
+  out << "],\"timeDeltas\":[";
+  int64_t last = profile.start_time;
+  for (size_t i = 0; i < profile.timestamps.size(); i++) {
+    out << (i > 0 ? "," : "") << profile.timestamps[i] - last;
+    last = profile.timestamps[i];
+  }
+  out << "]}\n";
+  return out.str();
+}
+
+Profiler::FinishWriting Profiler::WriteHeapSnapshot(
+    std::filesystem::path path, ThreadPoolTaskQueue* io_queue) {
+  auto writer =
+      std::make_shared<HeapSnapshotWriter>(std::move(path), io_queue);
+
+  v8::HandleScope handle_scope(isolate_);
+  const v8::HeapSnapshot* snapshot =
+      isolate_->GetHeapProfiler()->TakeHeapSnapshot();
+  ASSERT(snapshot);
+  snapshot->Serialize(writer.get(), v8::HeapSnapshot::kJSON);
+  const_cast<v8::HeapSnapshot*>(snapshot)->Delete();
+
+  return [writer](std::string* error) { return writer->Finish(error); };
+}
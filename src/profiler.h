@@ -0,0 +1,83 @@
+#ifndef WINDOWJS_PROFILER_H
+#define WINDOWJS_PROFILER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <v8/include/v8-profiler.h>
+#include <v8/include/v8.h>
+
+class ThreadPoolTaskQueue;
+
+// Records CPU profiles and heap snapshots of an isolate, in the formats that
+// the Chrome DevTools load: ".cpuprofile" and ".heapsnapshot" files.
+//
+// All methods must be called in the thread of the isolate, except ToJson().
+class Profiler final {
+ public:
+  // A copy of a v8::CpuProfile, which can outlive the profiler.
+  struct CpuProfile {
+    struct Node {
+      int id;
+      std::string function_name;
+      std::string url;
+      int script_id;
+      // 1-based, or 0 if unknown.
+      int line;
+      int column;
+      unsigned hit_count;
+      std::vector<int> children;
+    };
+
+    std::vector<Node> nodes;
+    // Timestamps in microseconds.
+    int64_t start_time = 0;
+    int64_t end_time = 0;
+    // The node ID of each sample, and when it was taken.
+    std::vector<int> samples;
+    std::vector<int64_t> timestamps;
+  };
+
+  explicit Profiler(v8::Isolate* isolate);
+  ~Profiler();
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  bool is_profiling() const { return cpu_profiler_ != nullptr; }
+
+  // Starts sampling the Javascript stacks of the isolate. Returns false if a
+  // profile is already being recorded.
+  bool StartCpuProfile();
+
+  // Stops the profile started by StartCpuProfile(), and returns a copy of it.
+  CpuProfile StopCpuProfile();
+
+  // Converts a profile to the JSON of a ".cpuprofile" file. Can be called from
+  // any thread.
+  static std::string ToJson(const CpuProfile& profile);
+
+  // Waits until the last chunk of a heap snapshot is written and closes its
+  // file. Returns false and sets "error" if that failed.
+  using FinishWriting = std::function<bool(std::string* error)>;
+
+  // Takes a snapshot of the heap and writes it to "path" as a ".heapsnapshot"
+  // file. v8 serializes it in the thread of the isolate, which is paused until
+  // this returns; the chunks of JSON are written in order in tasks posted to
+  // "io_queue", and the serialization waits when too many are pending.
+  // The returned function must be called in a task of "io_queue" afterwards.
+  FinishWriting WriteHeapSnapshot(std::filesystem::path path,
+                                  ThreadPoolTaskQueue* io_queue);
+
+ private:
+  v8::Isolate* isolate_;
+
+  // Only exists while profiling, so that the sampler thread doesn't run
+  // otherwise.
+  v8::CpuProfiler* cpu_profiler_;
+};
+
+#endif  // WINDOWJS_PROFILER_H
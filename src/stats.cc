@@ -1,5 +1,7 @@
 #include "stats.h"
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 
 #include <uv.h>
@@ -12,12 +14,28 @@
 #include "fail.h"
 #include "js_api.h"
 #include "platform.h"
+#include "text_blob_cache.h"
 #include "window.h"
 
 namespace {
 
 uv_rusage_t g_prev_rusage;
 
+// Idle periods last at most 50 ms, like in browsers, so that input events
+// are still handled promptly.
+const double kMaxIdlePeriod = 0.05;
+
+// Safety margin left between the end of idle callbacks and the time when the
+// next frame must start rendering.
+const double kIdleMargin = 0.001;
+
+// GC steps shorter than this aren't worth starting; the GC catches up in
+// later frames, or in allocations.
+const double kMinGcIdleTime = 0.0005;
+
+// Weight of each new sample in the smoothed frame interval and render time.
+const double kSmoothing = 0.1;
+
 }  // namespace
 
 double DeltaTimevalMs(uv_timeval_t before, uv_timeval_t after) {
@@ -32,6 +50,17 @@ Stats::Stats(Window* window)
       frames_count_(0),
       last_stats_update_(-1),
       fps_(0),
+      previous_timestamp_(0),
+      frame_start_timestamp_(0),
+      elapsed_wait_(0),
+      elapsed_gc_(0),
+      elapsed_js_(0),
+      elapsed_raf_(0),
+      elapsed_idle_(0),
+      elapsed_swap_(0),
+      swap_timestamp_(0),
+      frame_interval_(1 / 60.0),
+      render_time_(0),
       redraw_(false),
       print_frame_times_(false) {}
 
@@ -42,7 +71,7 @@ int Stats::width() const {
 }
 
 int Stats::height() const {
-  return 76 * window_->device_pixel_ratio();
+  return 104 * window_->device_pixel_ratio();
 }
 
 void Stats::SetEnabled(bool enabled) {
@@ -51,6 +80,7 @@ void Stats::SetEnabled(bool enabled) {
       canvas_.reset(new Canvas(window_->shared_context(), width(), height(),
                                Canvas::TEXTURE));
       redraw_ = true;
+      TextBlobCache::TakeCounters();
     }
   } else {
     canvas_.reset();
@@ -70,7 +100,64 @@ void Stats::UpdateTimestamp(double* timestamp) {
   previous_timestamp_ = now;
 }
 
+void Stats::OnRenderFinished() {
+  // Doesn't update "previous_timestamp_", so that the Swap time still
+  // includes rendering. Frames rendered outside of the main loop (e.g. while
+  // resizing) don't have a meaningful start time and are skipped.
+  double elapsed = glfwGetTime() - previous_timestamp_;
+  if (elapsed < 0.1) {
+    render_time_ += (elapsed - render_time_) * kSmoothing;
+  }
+}
+
+void Stats::OnSwapFinished() {
+  UpdateTimestamp(&elapsed_swap_);
+  double interval = previous_timestamp_ - swap_timestamp_;
+  swap_timestamp_ = previous_timestamp_;
+  // Only frames that were drawn back-to-back tell the vsync interval; the
+  // main loop didn't block waiting for events before those.
+  if (elapsed_wait_ < 0.001 && interval > 0 && interval < 0.1) {
+    frame_interval_ += (interval - frame_interval_) * kSmoothing;
+  }
+}
+
+double Stats::GetNextVsync(double now) const {
+  double next_vsync = swap_timestamp_ + frame_interval_;
+  if (next_vsync < now) {
+    // The previous frame took longer than a vsync interval; the next frame
+    // gets presented at the following vsync.
+    next_vsync +=
+        std::ceil((now - next_vsync) / frame_interval_) * frame_interval_;
+  }
+  return next_vsync;
+}
+
+double Stats::GetIdleDeadline(bool animating) const {
+  double now = glfwGetTime();
+  double deadline = now + kMaxIdlePeriod;
+  if (animating) {
+    deadline =
+        std::min(deadline, GetNextVsync(now) - render_time_ - kIdleMargin);
+  }
+  return deadline;
+}
+
+double Stats::GetGcIdleTime(bool animating) const {
+  double idle_time = kMaxIdlePeriod;
+  if (animating) {
+    // The current frame is rendered and swapped meanwhile, and the next one
+    // starts once the swap returns at the next vsync.
+    double now = glfwGetTime();
+    idle_time = std::min(idle_time, GetNextVsync(now) - now - kIdleMargin);
+  }
+  return idle_time < kMinGcIdleTime ? 0 : idle_time;
+}
+
 void Stats::OnFrameFinished() {
+  if (js_) {
+    js_->gc_stats()->OnFrameFinished();
+  }
+
   if (print_frame_times_) {
     double now = glfwGetTime();
     double elapsed = now - frame_start_timestamp_;
@@ -79,9 +166,9 @@ void Stats::OnFrameFinished() {
     double fps = 1 / elapsed;
     $(DEV) << "Input " << std::fixed << std::setprecision(3)
            << elapsed_wait_ * 1000 << " GC " << elapsed_gc_ * 1000 << " JS "
-           << elapsed_js_ * 1000 << " RAF " << elapsed_raf_ * 1000 << " Swap "
-           << elapsed_swap_ * 1000 << " Total frame " << elapsed * 1000
-           << " FPS " << fps;
+           << elapsed_js_ * 1000 << " RAF " << elapsed_raf_ * 1000 << " Idle "
+           << elapsed_idle_ * 1000 << " Swap " << elapsed_swap_ * 1000
+           << " Total frame " << elapsed * 1000 << " FPS " << fps;
   }
 
   if (!is_enabled()) {
@@ -199,5 +286,39 @@ void Stats::Draw() {
     y += 14 * ratio;
   }
 
+  if (js_) {
+    // The GC pauses of the last frame, and the longest pause so far.
+    GcStats::Counters minor = js_->gc_stats()->counters(GcStats::Type::MINOR);
+    GcStats::Counters major = js_->gc_stats()->counters(GcStats::Type::MAJOR);
+    double last_frame = minor.last_frame_pause + major.last_frame_pause;
+    double max = std::max(minor.max_pause, major.max_pause);
+
+    std::stringstream ss;
+    ss << "GC " << std::fixed << std::setprecision(1) << last_frame * 1000
+       << " max " << max * 1000 << " ms";
+    std::string s = ss.str();
+    canvas->drawSimpleText(s.c_str(), s.size(), SkTextEncoding::kUTF8, 4, y,
+                           font, paint);
+
+    y += 14 * ratio;
+  }
+
+  {
+    // The hit rate of the text caches of the canvases since the last update.
+    TextBlobCache::Counters text = TextBlobCache::TakeCounters();
+    uint64_t lookups = text.hits + text.misses;
+    double rate = lookups > 0 ? 100.0 * text.hits / lookups : 0;
+
+    std::stringstream ss;
+    ss << "Text " << std::fixed << std::setprecision(1) << rate << "% of "
+       << lookups;
+    std::string s = ss.str();
+    paint.setColor(SK_ColorYELLOW);
+    canvas->drawSimpleText(s.c_str(), s.size(), SkTextEncoding::kUTF8, 4, y,
+                           font, paint);
+
+    y += 14 * ratio;
+  }
+
   redraw_ = false;
 }
@@ -21,6 +21,9 @@ class Stats {
   int height() const;
   Canvas* canvas() { return canvas_.get(); }
 
+  // Smoothed estimate of the vsync interval, in seconds.
+  double frame_interval() const { return frame_interval_; }
+
   void SetEnabled(bool enabled);
   void SetPrintFrameTimes(bool print) { print_frame_times_ = print; }
   void SetJs(Js* js, JsApi* api) {
@@ -33,15 +36,31 @@ class Stats {
   void OnGcFinished() { UpdateTimestamp(&elapsed_gc_); }
   void OnJsFinished() { UpdateTimestamp(&elapsed_js_); }
   void OnRafFinished() { UpdateTimestamp(&elapsed_raf_); }
-  void OnSwapFinished() { UpdateTimestamp(&elapsed_swap_); }
+  void OnIdleFinished() { UpdateTimestamp(&elapsed_idle_); }
+  void OnRenderFinished();
+  void OnSwapFinished();
   void OnWaitFinished() { UpdateTimestamp(&elapsed_wait_); }
 
   void OnFrameFinished();
 
+  // Returns the time until which idle callbacks can run without delaying the
+  // next frame. If "animating" then that's the expected time of the next
+  // vsync, minus the time it takes to render and flush a frame. Otherwise
+  // the idle period lasts up to 50 ms.
+  double GetIdleDeadline(bool animating) const;
+
+  // Returns how long, in seconds, the GC can run in the background after the
+  // current frame was drawn, without delaying the next frame. If "animating"
+  // then that lasts until the expected time of the next vsync, when the next
+  // frame starts. Otherwise the idle period lasts up to 50 ms. Returns 0 if
+  // there isn't enough time left for a GC step.
+  double GetGcIdleTime(bool animating) const;
+
   void Draw();
 
  private:
   void UpdateTimestamp(double* timestamp);
+  double GetNextVsync(double now) const;
   void PrintFrameTimes(double elapsed);
 
   Window* window_;
@@ -59,8 +78,15 @@ class Stats {
   double elapsed_gc_;
   double elapsed_js_;
   double elapsed_raf_;
+  double elapsed_idle_;
   double elapsed_swap_;
 
+  // Smoothed estimates of the vsync interval and of the time to render a
+  // frame, excluding the wait for vsync.
+  double swap_timestamp_;
+  double frame_interval_;
+  double render_time_;
+
   bool redraw_;
   bool print_frame_times_;
 };
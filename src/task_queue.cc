@@ -1,87 +1,236 @@
 #include "task_queue.h"
 
+#include <algorithm>
+#include <limits>
+
 #include <GLFW/glfw3.h>
 
 static inline double Now() {
   return glfwGetTime();
 }
 
-TaskQueue::TaskQueue() : post_empty_event_(false) {}
+static const double kNever = std::numeric_limits<double>::infinity();
+
+TaskQueue::TaskQueue()
+    : wake_up_pending_(false),
+      wake_ups_(0),
+      time_budget_(0),
+      post_empty_event_(false),
+      stop_running_(false),
+      wake_up_signal_(nullptr) {}
 
 TaskQueue::~TaskQueue() {}
 
-void TaskQueue::Post(Task task) {
-  {
-    std::lock_guard<std::mutex> lock(lock_);
-    tasks_.emplace(std::move(task));
-  }
-  if (post_empty_event_) {
-    glfwPostEmptyEvent();
-  }
+void TaskQueue::Post(TaskPriority priority, Task task,
+                     const TraceLocation& from) {
+  task = Trace::WrapTask("TaskQueue", from, 0, std::move(task));
+  posted_tasks_.Push(PostedTask{priority, std::move(task)});
+  WakeUp();
 }
 
-void TaskQueue::Post(double delay_in_seconds, Task task) {
+void TaskQueue::Post(double delay_in_seconds, Task task,
+                     const TraceLocation& from) {
+  task = Trace::WrapTask("TaskQueue", from, delay_in_seconds, std::move(task));
   {
     double when = Now() + delay_in_seconds;
     std::lock_guard<std::mutex> lock(lock_);
     delayed_tasks_.emplace(DelayedTask{std::move(task), when});
   }
-  if (post_empty_event_) {
-    glfwPostEmptyEvent();
+  WakeUp();
+}
+
+TaskQueue::TimerId TaskQueue::StartTimer(double delay_in_seconds,
+                                        double interval_in_seconds,
+                                        Task task, const TraceLocation& from) {
+  task = Trace::WrapTask("TaskQueue", from,
+                         interval_in_seconds > 0 ? -1 : delay_in_seconds,
+                         std::move(task));
+  TimerId id;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    id = timers_.Start(Now(), delay_in_seconds, interval_in_seconds,
+                       std::move(task));
   }
+  WakeUp();
+  return id;
 }
 
-double TaskQueue::GetSecondsToNextTask() const {
+void TaskQueue::CancelTimer(TimerId id) {
   std::lock_guard<std::mutex> lock(lock_);
-  if (!tasks_.empty()) {
+  timers_.Cancel(id);
+}
+
+double TaskQueue::GetSecondsToNextTask() const {
+  if (!posted_tasks_.empty()) {
     return 0;
   }
-  if (delayed_tasks_.empty()) {
+  for (const std::queue<Task>& tasks : tasks_) {
+    if (!tasks.empty()) {
+      return 0;
+    }
+  }
+  std::lock_guard<std::mutex> lock(lock_);
+  double when = timers_.GetNextExpiration();
+  if (!delayed_tasks_.empty()) {
+    when = std::min(when, delayed_tasks_.top().when);
+  }
+  if (when == kNever) {
     return -1;
   }
-  double interval = delayed_tasks_.top().when - Now();
+  double interval = when - Now();
   return interval <= 0 ? 0 : interval;
 }
 
 void TaskQueue::RunTasks() {
+  double deadline = time_budget_ > 0 ? Now() + time_budget_ : kNever;
+  stop_running_ = false;
+
+  // Whether each priority has run at least one task in this call.
+  std::array<bool, kNumTaskPriorities> ran{};
+
   for (;;) {
-    Task task;
+    TakePostedTasks();
 
+    double now = Now();
     {
       std::lock_guard<std::mutex> lock(lock_);
+      PromoteReadyDelayedTasks(now);
+    }
 
-      // Process delayed tasks first, to prevent immediate tasks from delaying
-      // these indefinitely.
-      if (!delayed_tasks_.empty() && Now() >= delayed_tasks_.top().when) {
-        task = std::move(delayed_tasks_.top().task);
-        delayed_tasks_.pop();
-      } else if (!tasks_.empty()) {
-        task = std::move(tasks_.front());
-        tasks_.pop();
-      } else {
-        return;
+    bool over_budget = now >= deadline;
+    int priority = -1;
+    for (int i = 0; i < kNumTaskPriorities; i++) {
+      if (tasks_[i].empty()) {
+        continue;
+      }
+      if (!over_budget || !ran[i] ||
+          i == static_cast<int>(TaskPriority::kInput)) {
+        priority = i;
+        break;
       }
     }
 
+    if (priority == -1) {
+      if (over_budget) {
+        uint64_t deferred = 0;
+        for (const std::queue<Task>& tasks : tasks_) {
+          deferred += tasks.size();
+        }
+        if (deferred > 0) {
+          counters_.tasks_deferred += deferred;
+          counters_.frames_over_budget++;
+        }
+      }
+      return;
+    }
+
+    ran[priority] = true;
+    Task task = std::move(tasks_[priority].front());
+    tasks_[priority].pop();
+    counters_.tasks_run++;
+
     task();
+
+    if (stop_running_) {
+      return;
+    }
   }
 }
 
 void TaskQueue::ResetDropAllTasks() {
-  std::queue<Task> tasks;
+  TakePostedTasks();
+  std::array<std::queue<Task>, kNumTaskPriorities> tasks;
   std::priority_queue<DelayedTask> delayed_tasks;
+  TimerWheel timers;
+  tasks_.swap(tasks);
   {
     std::lock_guard<std::mutex> lock(lock_);
-    tasks_.swap(tasks);
     delayed_tasks_.swap(delayed_tasks);
+    std::swap(timers_, timers);
   }
   // Run destructors without the lock.
 }
 
-ThreadPoolTaskQueue::ThreadPoolTaskQueue(int num_threads) : quit_(false) {
+TaskQueue::Counters TaskQueue::counters() const {
+  Counters counters = counters_;
+  counters.wake_ups = wake_ups_;
+  return counters;
+}
+
+void TaskQueue::TakePostedTasks() {
+  // Clear the flag before taking the tasks, so that any tasks posted after
+  // this point wake up the loop again.
+  wake_up_pending_ = false;
+  PostedTask posted;
+  while (posted_tasks_.Pop(&posted)) {
+    tasks_[static_cast<int>(posted.priority)].emplace(std::move(posted.task));
+  }
+}
+
+void TaskQueue::WakeUp() {
+  if ((post_empty_event_ || wake_up_signal_) &&
+      !wake_up_pending_.exchange(true)) {
+    wake_ups_++;
+    if (wake_up_signal_) {
+      wake_up_signal_->SetAndNotify();
+    } else {
+      glfwPostEmptyEvent();
+    }
+  }
+}
+
+void TaskQueue::PromoteReadyDelayedTasks(double now) {
+  // Delayed tasks are promoted in the order that they expire, and ahead of
+  // any lower priority tasks; immediate tasks can't delay them indefinitely.
+  std::queue<Task>& timers = tasks_[static_cast<int>(TaskPriority::kTimer)];
+  while (!delayed_tasks_.empty() && now >= delayed_tasks_.top().when) {
+    timers.emplace(std::move(delayed_tasks_.top().task));
+    delayed_tasks_.pop();
+  }
+
+  expired_timers_.clear();
+  timers_.Advance(now, &expired_timers_);
+  for (TimerId id : expired_timers_) {
+    timers.emplace([this, id] { RunTimer(id); });
+  }
+}
+
+void TaskQueue::RunTimer(TimerId id) {
+  Task task;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (!timers_.BeginRun(id, &task)) {
+      // Cancelled after expiring.
+      return;
+    }
+  }
+  task();
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    timers_.EndRun(id, std::move(task));
+  }
+}
+
+// The pool and worker index of the current thread, if it's a worker thread.
+static thread_local const ThreadPoolTaskQueue* current_pool = nullptr;
+static thread_local int current_worker = -1;
+
+ThreadPoolTaskQueue::ThreadPoolTaskQueue()
+    : ThreadPoolTaskQueue(DefaultNumThreads()) {}
+
+ThreadPoolTaskQueue::ThreadPoolTaskQueue(int num_threads, const char* name)
+    : next_worker_(0),
+      pending_tasks_(0),
+      sleeping_workers_(0),
+      next_delayed_task_(kNever),
+      quit_(false) {
+  workers_.resize(num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    workers_[i] = std::make_unique<Worker>();
+  }
   threads_.resize(num_threads);
   for (int i = 0; i < num_threads; i++) {
-    threads_[i] = std::thread(&ThreadPoolTaskQueue::Run, this);
+    threads_[i] = std::thread(&ThreadPoolTaskQueue::Run, this, i, name);
   }
 }
 
@@ -96,65 +245,235 @@ ThreadPoolTaskQueue::~ThreadPoolTaskQueue() {
   }
 }
 
-void ThreadPoolTaskQueue::Post(Task task) {
+// static
+int ThreadPoolTaskQueue::DefaultNumThreads() {
+  unsigned int n = std::thread::hardware_concurrency();
+  return n < 2 ? 2 : static_cast<int>(n);
+}
+
+void ThreadPoolTaskQueue::Post(Task task, const TraceLocation& from) {
+  task = Trace::WrapTask("ThreadPoolTaskQueue", from, 0, std::move(task));
+  PostImmediate(PooledTask{std::move(task), true});
+}
+
+void ThreadPoolTaskQueue::Post(double delay_in_seconds, Task task,
+                               const TraceLocation& from) {
+  task = Trace::WrapTask("ThreadPoolTaskQueue", from, delay_in_seconds,
+                         std::move(task));
+  PostDelayed(delay_in_seconds, PooledTask{std::move(task), true});
+}
+
+void ThreadPoolTaskQueue::PostPlatformTask(Priority priority, Task task,
+                                           const TraceLocation& from) {
+  task = Trace::WrapTask("v8", from, 0, std::move(task));
+  if (priority == Priority::kNormal) {
+    PostImmediate(PooledTask{std::move(task), false});
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(user_blocking_.lock);
+    user_blocking_.tasks.emplace_back(PooledTask{std::move(task), false});
+    user_blocking_.size++;
+  }
+  pending_tasks_++;
+  WakeUpOneWorker();
+}
+
+void ThreadPoolTaskQueue::PostPlatformTask(double delay_in_seconds, Task task,
+                                           const TraceLocation& from) {
+  task = Trace::WrapTask("v8", from, delay_in_seconds, std::move(task));
+  PostDelayed(delay_in_seconds, PooledTask{std::move(task), false});
+}
+
+void ThreadPoolTaskQueue::PostImmediate(PooledTask task) {
+  unsigned int index;
+  if (current_pool == this) {
+    index = current_worker;
+  } else {
+    index = next_worker_.fetch_add(1, std::memory_order_relaxed) %
+            workers_.size();
+  }
+  Worker* worker = workers_[index].get();
   {
-    std::lock_guard<std::mutex> lock(lock_);
-    tasks_.emplace(std::move(task));
+    std::lock_guard<std::mutex> lock(worker->lock);
+    worker->tasks.emplace_back(std::move(task));
+    worker->size++;
   }
-  cond_var_.notify_one();
+  pending_tasks_++;
+  WakeUpOneWorker();
 }
 
-void ThreadPoolTaskQueue::Post(double delay_in_seconds, Task task) {
+void ThreadPoolTaskQueue::PostDelayed(double delay_in_seconds,
+                                      PooledTask task) {
   double when = Now() + delay_in_seconds;
   {
     std::lock_guard<std::mutex> lock(lock_);
-    delayed_tasks_.emplace(DelayedTask{std::move(task), when});
+    delayed_tasks_.emplace(DelayedPooledTask{std::move(task), when});
+    next_delayed_task_ = delayed_tasks_.top().when;
   }
   cond_var_.notify_one();
 }
 
-void ThreadPoolTaskQueue::Run() {
+void ThreadPoolTaskQueue::WakeUpOneWorker() {
+  // Workers increment sleeping_workers_ before checking pending_tasks_, and
+  // Post() increments pending_tasks_ before checking sleeping_workers_; at
+  // least one of them sees the other's update. Taking the lock makes sure
+  // that the sleeping worker is already waiting on cond_var_.
+  if (sleeping_workers_ > 0) {
+    { std::lock_guard<std::mutex> lock(lock_); }
+    cond_var_.notify_one();
+  }
+}
+
+void ThreadPoolTaskQueue::Run(int index, const char* name) {
+  current_pool = this;
+  current_worker = index;
+  Trace::SetThreadName(name);
+
   for (;;) {
+    if (quit_) {
+      return;
+    }
+
     Task task;
 
-    {
+    // Process delayed tasks first, to prevent immediate tasks from delaying
+    // these indefinitely.
+    if (Now() >= next_delayed_task_) {
+      std::lock_guard<std::mutex> lock(lock_);
+      PopReadyDelayedTask(Now(), &task);
+    }
+
+    if (!task && !PopOrSteal(index, &task)) {
       std::unique_lock<std::mutex> lock(lock_);
 
       for (;;) {
         double now = Now();
         if (quit_) {
           return;
-        } else if (!delayed_tasks_.empty() &&
-                   now >= delayed_tasks_.top().when) {
-          task = std::move(delayed_tasks_.top().task);
-          delayed_tasks_.pop();
+        } else if (PopReadyDelayedTask(now, &task)) {
           break;
-        } else if (!tasks_.empty()) {
-          task = std::move(tasks_.front());
-          tasks_.pop();
+        }
+
+        sleeping_workers_++;
+        if (pending_tasks_ > 0) {
+          // A task was posted concurrently; go steal it.
+          sleeping_workers_--;
           break;
+        }
+        if (delayed_tasks_.empty()) {
+          cond_var_.wait(lock);
         } else {
-          if (delayed_tasks_.empty()) {
-            cond_var_.wait(lock);
-          } else {
-            double timeout = delayed_tasks_.top().when - now;
-            cond_var_.wait_for(lock, std::chrono::duration<double>(timeout));
-          }
+          double timeout = delayed_tasks_.top().when - now;
+          cond_var_.wait_for(lock, std::chrono::duration<double>(timeout));
         }
+        sleeping_workers_--;
       }
     }
 
-    task();
+    if (task) {
+      task();
+    }
+  }
+}
+
+bool ThreadPoolTaskQueue::PopOrSteal(int index, Task* task) {
+  if (pending_tasks_ == 0) {
+    return false;
+  }
+
+  if (user_blocking_.size > 0) {
+    std::lock_guard<std::mutex> lock(user_blocking_.lock);
+    if (!user_blocking_.tasks.empty()) {
+      *task = std::move(user_blocking_.tasks.front().task);
+      user_blocking_.tasks.pop_front();
+      user_blocking_.size--;
+      pending_tasks_--;
+      return true;
+    }
+  }
+
+  Worker* worker = workers_[index].get();
+  if (worker->size > 0) {
+    std::lock_guard<std::mutex> lock(worker->lock);
+    if (!worker->tasks.empty()) {
+      *task = std::move(worker->tasks.front().task);
+      worker->tasks.pop_front();
+      worker->size--;
+      pending_tasks_--;
+      return true;
+    }
+  }
+
+  // Steal from the back of the other workers' deques.
+  int num_workers = static_cast<int>(workers_.size());
+  for (int i = 1; i < num_workers; i++) {
+    Worker* victim = workers_[(index + i) % num_workers].get();
+    if (victim->size == 0) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(victim->lock);
+    if (!victim->tasks.empty()) {
+      *task = std::move(victim->tasks.back().task);
+      victim->tasks.pop_back();
+      victim->size--;
+      pending_tasks_--;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ThreadPoolTaskQueue::PopReadyDelayedTask(double now, Task* task) {
+  if (delayed_tasks_.empty() || now < delayed_tasks_.top().when) {
+    return false;
   }
+  *task = std::move(delayed_tasks_.top().task.task);
+  delayed_tasks_.pop();
+  next_delayed_task_ =
+      delayed_tasks_.empty() ? kNever : delayed_tasks_.top().when;
+  return true;
 }
 
 void ThreadPoolTaskQueue::ResetDropAllTasks() {
-  std::queue<Task> tasks;
-  std::priority_queue<DelayedTask> delayed_tasks;
+  std::vector<PooledTask> dropped;
+  for (unsigned int i = 0; i < workers_.size(); i++) {
+    Worker* worker = workers_[i].get();
+    std::lock_guard<std::mutex> lock(worker->lock);
+    std::deque<PooledTask> kept;
+    for (PooledTask& task : worker->tasks) {
+      if (task.droppable) {
+        dropped.emplace_back(std::move(task));
+      } else {
+        kept.emplace_back(std::move(task));
+      }
+    }
+    pending_tasks_ -= static_cast<int>(worker->tasks.size() - kept.size());
+    worker->size = static_cast<int>(kept.size());
+    worker->tasks.swap(kept);
+  }
+  std::priority_queue<DelayedPooledTask> delayed_tasks;
   {
     std::lock_guard<std::mutex> lock(lock_);
-    tasks_.swap(tasks);
     delayed_tasks_.swap(delayed_tasks);
+    next_delayed_task_ = kNever;
+  }
+  std::vector<DelayedPooledTask> kept;
+  for (; !delayed_tasks.empty(); delayed_tasks.pop()) {
+    if (!delayed_tasks.top().task.droppable) {
+      kept.push_back(delayed_tasks.top());
+    }
+  }
+  if (!kept.empty()) {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      for (DelayedPooledTask& task : kept) {
+        delayed_tasks_.emplace(std::move(task));
+      }
+      next_delayed_task_ = delayed_tasks_.top().when;
+    }
+    cond_var_.notify_one();
   }
   // Run destructors without the lock.
 }
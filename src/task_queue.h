@@ -1,11 +1,22 @@
 #ifndef WINDOWJS_TASK_QUEUE_H
 #define WINDOWJS_TASK_QUEUE_H
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
+
+#include "mpsc_queue.h"
+#include "signal.h"
+#include "timer_wheel.h"
+#include "trace.h"
 
 using Task = std::function<void()>;
 
@@ -16,8 +27,38 @@ struct DelayedTask {
   bool operator<(const DelayedTask& t) const { return when > t.when; }
 };
 
+// Priority classes for tasks posted to the main TaskQueue, from the highest
+// to the lowest priority.
+enum class TaskPriority {
+  // Input from the user, e.g. commands typed in the console.
+  kInput,
+  // Delayed tasks that are ready to run.
+  kTimer,
+  // Completions of asynchronous work, e.g. resolving Promises.
+  kAsync,
+  // Log messages.
+  kLogging,
+};
+
+constexpr int kNumTaskPriorities = 4;
+
 class TaskQueue {
  public:
+  struct Counters {
+    // Number of tasks executed by RunTasks().
+    uint64_t tasks_run = 0;
+
+    // Number of tasks that were still pending when RunTasks() returned due to
+    // the time budget, summed over all calls.
+    uint64_t tasks_deferred = 0;
+
+    // Number of calls to RunTasks() that ran out of time budget.
+    uint64_t frames_over_budget = 0;
+
+    // Number of empty events posted to wake up the main loop.
+    uint64_t wake_ups = 0;
+  };
+
   TaskQueue();
   ~TaskQueue();
 
@@ -26,34 +67,143 @@ class TaskQueue {
   TaskQueue(TaskQueue&&) = delete;
   TaskQueue&& operator=(TaskQueue&&) = delete;
 
-  // If enabled then an empty event is sent to GLFW after each call to Post(),
-  // to wake up any calls blocked on glfwWaitEvents().
+  // If enabled then an empty event is sent to GLFW when a task is posted to an
+  // idle queue, to wake up any calls blocked on glfwWaitEvents(). Further
+  // posts don't send more events until the next call to RunTasks().
   void SetPostsEmptyEvents(bool post) { post_empty_event_ = post; }
 
-  void Post(Task task);
-  void Post(double delay_in_seconds, Task task);
+  // Like SetPostsEmptyEvents(), but notifies "signal" instead, for threads
+  // that wait for tasks without GLFW. "signal" must outlive the TaskQueue.
+  void SetWakeUpSignal(Signal* signal) { wake_up_signal_ = signal; }
+
+  // Limits how long each call to RunTasks() runs tasks of priority kTimer and
+  // lower. Tasks left over at the deadline run in the next call. A budget of
+  // 0 means no limit.
+  void SetTimeBudget(double seconds) { time_budget_ = seconds; }
+
+  // Posts a task with priority kAsync.
+  //
+  // "from" is recorded by Trace when tracing is enabled, and defaults to the
+  // caller.
+  void Post(Task task, const TraceLocation& from = TraceLocation::Current()) {
+    Post(TaskPriority::kAsync, std::move(task), from);
+  }
+
+  // Immediate tasks can be posted from any thread without taking a lock.
+  void Post(TaskPriority priority, Task task,
+            const TraceLocation& from = TraceLocation::Current());
+
+  // Delayed tasks run with priority kTimer once they are ready.
+  void Post(double delay_in_seconds, Task task,
+            const TraceLocation& from = TraceLocation::Current());
+
+  using TimerId = TimerWheel::TimerId;
+
+  // Timers are like delayed tasks, but can be cancelled and can repeat.
+  // Starting and cancelling a timer takes constant time.
+  //
+  // The "task" runs with priority kTimer after "delay_in_seconds". If
+  // "interval_in_seconds" is positive then it runs again after each interval,
+  // until the timer is cancelled.
+  TimerId StartTimer(double delay_in_seconds, double interval_in_seconds,
+                     Task task,
+                     const TraceLocation& from = TraceLocation::Current());
+  void CancelTimer(TimerId id);
 
   // Returns -1 if there are no delayed tasks in the queue.
   // Returns 0 if there are tasks ready to be executed immediately.
+  //
+  // This, RunTasks(), ResetDropAllTasks() and counters() must be called
+  // from the thread that runs the tasks.
   double GetSecondsToNextTask() const;
 
-  // Runs all the tasks that can be executed now, and returns.
+  // Runs the tasks that can be executed now, in priority order, and returns.
+  //
+  // Tasks of priority kInput always run. Lower priority tasks stop running
+  // once the time budget is exhausted, except that each priority with pending
+  // tasks runs at least one task per call so that none of them can be
+  // starved.
   void RunTasks();
 
+  // Makes the current call to RunTasks() return once the running task
+  // returns. The other tasks stay in the queue. Must be called from a task.
+  void StopRunningTasks() { stop_running_ = true; }
+
   void ResetDropAllTasks();
 
+  Counters counters() const;
+
  private:
+  struct PostedTask {
+    TaskPriority priority;
+    Task task;
+  };
+
+  // Moves the tasks posted from any thread into tasks_.
+  void TakePostedTasks();
+
+  // Moves the delayed tasks and timers that are ready into the kTimer queue.
+  // Requires lock_.
+  void PromoteReadyDelayedTasks(double now);
+
+  void RunTimer(TimerId id);
+
+  // Posts an empty event to GLFW or notifies the wake up signal, unless a
+  // wake up is already pending.
+  void WakeUp();
+
+  MpscQueue<PostedTask> posted_tasks_;
+  std::atomic<bool> wake_up_pending_;
+  std::atomic<uint64_t> wake_ups_;
+
+  // Only accessed by the thread that runs the tasks.
+  std::array<std::queue<Task>, kNumTaskPriorities> tasks_;
+
+  // Protects the delayed tasks and timers, which can be posted from any
+  // thread.
   mutable std::mutex lock_;
-  std::queue<Task> tasks_;
   std::priority_queue<DelayedTask> delayed_tasks_;
+  TimerWheel timers_;
+  std::vector<TimerId> expired_timers_;
+  Counters counters_;
+  double time_budget_;
   bool post_empty_event_;
+  bool stop_running_;
+  Signal* wake_up_signal_;
 };
 
+// A pool of threads running background tasks.
+//
+// Each worker thread owns a deque of tasks with its own lock. Tasks posted
+// from outside the pool are distributed round-robin across the workers, and
+// tasks posted from a worker thread go to its own deque. Workers pop from the
+// front of their own deque and steal from the back of the other deques when
+// they run out of work, so there is no single lock shared by every Post().
+//
+// Delayed tasks are kept in a single heap, and are checked before the
+// immediate tasks so that a busy pool doesn't delay them indefinitely.
+//
+// The worker tasks of v8 can run in a pool too; see JsPlatform. These have
+// their own priorities, and survive ResetDropAllTasks().
 class ThreadPoolTaskQueue {
  public:
+  // Priorities of the tasks posted with PostPlatformTask().
+  enum class Priority {
+    // Runs before any other immediate task of the pool, e.g. v8 work that
+    // the main thread is blocked on.
+    kUserBlocking,
+    // Runs in order with the tasks posted with Post().
+    kNormal,
+  };
+
+  // Spawns DefaultNumThreads() threads.
+  ThreadPoolTaskQueue();
+
   // Spawns "num_threads" that keep running and pumping tasks until the queue
-  // is deleted.
-  explicit ThreadPoolTaskQueue(int num_threads);
+  // is deleted. The threads are called "name" in traces; it must be a string
+  // literal.
+  explicit ThreadPoolTaskQueue(int num_threads,
+                               const char* name = "ThreadPool");
 
   // Joins on all threads before returning.
   ~ThreadPoolTaskQueue();
@@ -63,20 +213,83 @@ class ThreadPoolTaskQueue {
   ThreadPoolTaskQueue(ThreadPoolTaskQueue&&) = delete;
   ThreadPoolTaskQueue&& operator=(ThreadPoolTaskQueue&&) = delete;
 
-  void Post(Task task);
-  void Post(double delay_in_seconds, Task task);
+  // Returns the number of hardware threads, and at least 2.
+  static int DefaultNumThreads();
+
+  int num_threads() const { return static_cast<int>(threads_.size()); }
+
+  void Post(Task task, const TraceLocation& from = TraceLocation::Current());
+  void Post(double delay_in_seconds, Task task,
+            const TraceLocation& from = TraceLocation::Current());
+
+  // Posts a task of the v8::Platform. Unlike the tasks posted with Post(),
+  // these aren't dropped by ResetDropAllTasks(), since v8 may be waiting for
+  // them to run.
+  void PostPlatformTask(Priority priority, Task task,
+                        const TraceLocation& from = TraceLocation::Current());
+  void PostPlatformTask(double delay_in_seconds, Task task,
+                        const TraceLocation& from = TraceLocation::Current());
 
+  // Drops the pending tasks posted with Post().
   void ResetDropAllTasks();
 
  private:
-  void Run();
+  struct PooledTask {
+    Task task;
+    // False for the tasks of the v8::Platform.
+    bool droppable;
+  };
+
+  struct DelayedPooledTask {
+    PooledTask task;
+    double when;
+
+    bool operator<(const DelayedPooledTask& t) const { return when > t.when; }
+  };
+
+  struct Worker {
+    std::mutex lock;
+    std::deque<PooledTask> tasks;
+    // Size of "tasks", readable without the lock.
+    std::atomic<int> size{0};
+  };
+
+  void PostImmediate(PooledTask task);
+  void PostDelayed(double delay_in_seconds, PooledTask task);
+
+  void Run(int index, const char* name);
 
+  // Wakes up one of the sleeping workers, if any.
+  void WakeUpOneWorker();
+
+  // Pops a task from the worker at "index", or steals one from another worker.
+  bool PopOrSteal(int index, Task* task);
+
+  // Pops a delayed task if there is one ready to run. Requires lock_.
+  bool PopReadyDelayedTask(double now, Task* task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<unsigned int> next_worker_;
+
+  // The kUserBlocking tasks, which every worker checks before its own deque.
+  Worker user_blocking_;
+
+  // Number of tasks in the workers' deques, including user_blocking_.
+  std::atomic<int> pending_tasks_;
+
+  // Number of workers blocked on cond_var_.
+  std::atomic<int> sleeping_workers_;
+
+  // When the next delayed task is due; infinity if there are none.
+  std::atomic<double> next_delayed_task_;
+
+  std::atomic<bool> quit_;
+
+  // Protects delayed_tasks_ and the sleeping workers.
   std::mutex lock_;
   std::condition_variable cond_var_;
-  std::queue<Task> tasks_;
-  std::priority_queue<DelayedTask> delayed_tasks_;
+  std::priority_queue<DelayedPooledTask> delayed_tasks_;
   std::vector<std::thread> threads_;
-  bool quit_;
 };
 
 #endif  // WINDOWJS_TASK_QUEUE_H
@@ -0,0 +1,92 @@
+#include "text_blob_cache.h"
+
+#include <functional>
+#include <utility>
+
+#include <skia/include/core/SkTypeface.h>
+
+#include "fail.h"
+
+namespace {
+
+constexpr size_t kMaxFontMetrics = 16;
+
+size_t Combine(size_t hash, size_t value) {
+  return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+}
+
+}  // namespace
+
+TextBlobCache::Counters TextBlobCache::counters_;
+
+TextBlobCache::TextBlobCache(size_t capacity) : capacity_(capacity) {
+  ASSERT(capacity_ > 0);
+}
+
+TextBlobCache::~TextBlobCache() {}
+
+const TextBlobCache::Text& TextBlobCache::GetText(std::string text,
+                                                  const SkFont& font) {
+  Key key{std::move(text), font};
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    counters_.hits++;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return it->second.text;
+  }
+
+  counters_.misses++;
+  if (entries_.size() >= capacity_) {
+    // Erase by iterator: the key of the victim is owned by its own node.
+    auto victim = entries_.find(*lru_.back());
+    lru_.pop_back();
+    entries_.erase(victim);
+  }
+
+  Text value;
+  value.blob = SkTextBlob::MakeFromText(key.text.c_str(), key.text.size(),
+                                        font, SkTextEncoding::kUTF8);
+  value.advance = font.measureText(key.text.c_str(), key.text.size(),
+                                   SkTextEncoding::kUTF8);
+  auto result = entries_.emplace(std::move(key), Entry{std::move(value), {}});
+  ASSERT(result.second);
+  lru_.push_front(&result.first->first);
+  result.first->second.lru = lru_.begin();
+  return result.first->second.text;
+}
+
+const SkFontMetrics& TextBlobCache::GetMetrics(const SkFont& font) {
+  auto it = metrics_.find(font);
+  if (it != metrics_.end()) {
+    counters_.hits++;
+    return it->second;
+  }
+  counters_.misses++;
+  if (metrics_.size() >= kMaxFontMetrics) {
+    metrics_.clear();
+  }
+  SkFontMetrics& metrics = metrics_[font];
+  font.getMetrics(&metrics);
+  return metrics;
+}
+
+// static
+TextBlobCache::Counters TextBlobCache::TakeCounters() {
+  Counters counters = counters_;
+  counters_ = Counters();
+  return counters;
+}
+
+size_t TextBlobCache::FontHash::operator()(const SkFont& font) const {
+  size_t hash = font.getTypeface() ? font.getTypeface()->uniqueID() : 0;
+  hash = Combine(hash, std::hash<float>()(font.getSize()));
+  hash = Combine(hash, std::hash<float>()(font.getScaleX()));
+  hash = Combine(hash, std::hash<float>()(font.getSkewX()));
+  hash = Combine(hash, static_cast<size_t>(font.getEdging()));
+  hash = Combine(hash, static_cast<size_t>(font.getHinting()));
+  return hash;
+}
+
+size_t TextBlobCache::KeyHash::operator()(const Key& key) const {
+  return Combine(std::hash<std::string>()(key.text), FontHash()(key.font));
+}
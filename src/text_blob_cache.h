@@ -0,0 +1,91 @@
+#ifndef WINDOWJS_TEXT_BLOB_CACHE_H
+#define WINDOWJS_TEXT_BLOB_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include <skia/include/core/SkFont.h>
+#include <skia/include/core/SkFontMetrics.h>
+#include <skia/include/core/SkRefCnt.h>
+#include <skia/include/core/SkTextBlob.h>
+
+// A least-recently-used cache of the text blobs drawn by fillText() and
+// strokeText() of a canvas, and of the metrics of its fonts. Text that is
+// redrawn every frame, like scores and labels, isn't converted to glyphs and
+// measured again on each call.
+//
+// Must only be used in the main thread.
+class TextBlobCache final {
+ public:
+  struct Text {
+    // Null if the text has no glyphs.
+    sk_sp<SkTextBlob> blob;
+    // The advance width of the text.
+    float advance;
+  };
+
+  // Lookups of all the caches, since the last call to TakeCounters().
+  struct Counters {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  explicit TextBlobCache(size_t capacity);
+  ~TextBlobCache();
+
+  TextBlobCache(const TextBlobCache&) = delete;
+  TextBlobCache& operator=(const TextBlobCache&) = delete;
+
+  // Returns the blob of the UTF-8 "text" in "font", building it on a miss.
+  // The reference is valid until the next call.
+  const Text& GetText(std::string text, const SkFont& font);
+
+  // Returns the metrics of "font". The reference is valid until the next call.
+  const SkFontMetrics& GetMetrics(const SkFont& font);
+
+  // Counts a hit of a cache in front of this one, that returned a Text from
+  // an earlier GetText() call without calling it again.
+  static void CountHit() { counters_.hits++; }
+
+  // Returns the counters of all the caches, and resets them.
+  static Counters TakeCounters();
+
+ private:
+  struct FontHash {
+    size_t operator()(const SkFont& font) const;
+  };
+
+  struct Key {
+    std::string text;
+    SkFont font;
+
+    bool operator==(const Key& other) const {
+      return text == other.text && font == other.font;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    Text text;
+    // Position in lru_.
+    std::list<const Key*>::iterator lru;
+  };
+
+  size_t capacity_;
+  std::unordered_map<Key, Entry, KeyHash> entries_;
+  // The keys of entries_, from the most to the least recently used.
+  std::list<const Key*> lru_;
+
+  // Canvases use few fonts, so this is cleared when it gets too large instead
+  // of tracking their use.
+  std::unordered_map<SkFont, SkFontMetrics, FontHash> metrics_;
+
+  static Counters counters_;
+};
+
+#endif  // WINDOWJS_TEXT_BLOB_CACHE_H
@@ -2,6 +2,8 @@
 
 #include <thread>
 
+#include <uv.h>
+
 #include "fail.h"
 
 void InitMainThread() {
@@ -13,3 +15,31 @@ bool IsMainThread() {
   static std::thread::id main_thread_id = std::this_thread::get_id();
   return std::this_thread::get_id() == main_thread_id;
 }
+
+namespace {
+
+thread_local bool is_worker_thread = false;
+
+}  // namespace
+
+void InitWorkerThread() {
+  ASSERT(!IsMainThread());
+  is_worker_thread = true;
+}
+
+bool IsJsThread() {
+  return is_worker_thread || IsMainThread();
+}
+
+int GetNumberOfCpus() {
+  static int cpus = [] {
+    int count = 0;
+    uv_cpu_info_t* info = nullptr;
+    if (uv_cpu_info(&info, &count) != 0) {
+      return 1;
+    }
+    uv_free_cpu_info(info, count);
+    return count < 1 ? 1 : count;
+  }();
+  return cpus;
+}
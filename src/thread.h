@@ -1,7 +1,34 @@
 #ifndef WINDOWJS_THREAD_H
 #define WINDOWJS_THREAD_H
 
+#include <atomic>
+
 void InitMainThread();
 bool IsMainThread();
 
+// Marks the current thread as a Worker thread, which runs its own isolate and
+// TaskQueue like the main thread does.
+void InitWorkerThread();
+
+// Whether the current thread is the main thread or a Worker thread. The APIs
+// that Workers also get assert this instead of IsMainThread().
+bool IsJsThread();
+
+// Returns the number of logical CPUs, as reported by Process.cpus.
+int GetNumberOfCpus();
+
+// A flag that one thread sets to ask work running in another thread to stop.
+// The work checks it between its stages.
+class CancelFlag {
+ public:
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  bool IsCancelled() const {
+    return cancelled_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<bool> cancelled_{false};
+};
+
 #endif  // WINDOWJS_THREAD_H
@@ -0,0 +1,233 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Duration of each tick, in seconds.
+static const double kTickSeconds = 0.001;
+
+static uint64_t TicksUntil(double time) {
+  return time <= 0 ? 0 : static_cast<uint64_t>(std::ceil(time / kTickSeconds));
+}
+
+TimerWheel::TimerWheel() : current_tick_(0), next_id_(1) {
+  level_count_.fill(0);
+}
+
+TimerWheel::~TimerWheel() {}
+
+TimerWheel::TimerId TimerWheel::Start(double now, double delay,
+                                      double interval, Task task) {
+  if (IsEmpty()) {
+    // Nothing can expire in between; jump ahead.
+    current_tick_ =
+        std::max(current_tick_, static_cast<uint64_t>(now / kTickSeconds));
+  }
+
+  std::unique_ptr<Timer> timer = std::make_unique<Timer>();
+  timer->id = next_id_++;
+  timer->expires =
+      std::max(TicksUntil(now + std::max(delay, 0.0)), current_tick_ + 1);
+  timer->interval = interval > 0 ? std::max<uint64_t>(TicksUntil(interval), 1)
+                                 : 0;
+  timer->task = std::move(task);
+
+  Insert(timer.get());
+  TimerId id = timer->id;
+  timers_.emplace(id, std::move(timer));
+  return id;
+}
+
+bool TimerWheel::Cancel(TimerId id) {
+  auto it = timers_.find(id);
+  if (it == timers_.end()) {
+    return false;
+  }
+  Unlink(it->second.get());
+  timers_.erase(it);
+  return true;
+}
+
+void TimerWheel::Advance(double now, std::vector<TimerId>* expired) {
+  uint64_t target = static_cast<uint64_t>(now / kTickSeconds);
+
+  while (current_tick_ < target) {
+    // If the lowest N levels are empty then nothing expires or cascades until
+    // the next multiple of 64^N ticks.
+    int empty_levels = 0;
+    while (empty_levels < kLevels && level_count_[empty_levels] == 0) {
+      empty_levels++;
+    }
+    if (empty_levels == kLevels) {
+      current_tick_ = target;
+      return;
+    }
+    if (empty_levels > 0) {
+      uint64_t mask = (uint64_t(1) << (kSlotBits * empty_levels)) - 1;
+      current_tick_ = std::min(target - 1, current_tick_ | mask);
+    }
+
+    current_tick_++;
+
+    // Cascade the upper levels down when the lower level wraps around.
+    for (int level = 1; level < kLevels; level++) {
+      uint64_t lower_mask = (uint64_t(1) << (kSlotBits * level)) - 1;
+      if ((current_tick_ & lower_mask) != 0) {
+        break;
+      }
+      Cascade(level);
+    }
+
+    Expire(expired);
+  }
+}
+
+bool TimerWheel::BeginRun(TimerId id, Task* task) {
+  auto it = timers_.find(id);
+  if (it == timers_.end()) {
+    return false;
+  }
+  Timer* timer = it->second.get();
+  timer->queued = false;
+  *task = std::move(timer->task);
+  if (timer->interval == 0) {
+    timers_.erase(it);
+  }
+  return true;
+}
+
+void TimerWheel::EndRun(TimerId id, Task task) {
+  auto it = timers_.find(id);
+  if (it != timers_.end()) {
+    it->second->task = std::move(task);
+  }
+}
+
+double TimerWheel::GetNextExpiration() const {
+  // A timer stays in its upper level until it cascades, so a timer that is
+  // due before the ones in level 0 can still be in level 1 or above. Each
+  // level contributes the earliest timer of its first occupied slot.
+  uint64_t next = std::numeric_limits<uint64_t>::max();
+  for (int level = 0; level < kLevels; level++) {
+    if (level_count_[level] == 0) {
+      continue;
+    }
+    uint64_t base = current_tick_ >> (kSlotBits * level);
+    for (uint64_t i = 1; i <= kSlots; i++) {
+      const Timer* timer = slots_[level][(base + i) & (kSlots - 1)].head;
+      if (timer) {
+        for (; timer; timer = timer->next) {
+          next = std::min(next, timer->expires);
+        }
+        break;
+      }
+    }
+  }
+  if (next == std::numeric_limits<uint64_t>::max()) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return static_cast<double>(next) * kTickSeconds;
+}
+
+bool TimerWheel::IsEmpty() const {
+  for (int count : level_count_) {
+    if (count > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TimerWheel::Insert(Timer* timer) {
+  uint64_t delta =
+      timer->expires > current_tick_ ? timer->expires - current_tick_ : 0;
+  uint64_t expires = timer->expires;
+
+  int level = 0;
+  while (level < kLevels - 1 &&
+         delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) {
+    level++;
+  }
+  uint64_t max_delta = (uint64_t(1) << (kSlotBits * kLevels)) - 1;
+  if (delta > max_delta) {
+    // Beyond the range of the wheel; gets cascaded again later.
+    expires = current_tick_ + max_delta;
+  }
+
+  int slot = (expires >> (kSlotBits * level)) & (kSlots - 1);
+  Slot& s = slots_[level][slot];
+  timer->level = level;
+  timer->slot = slot;
+  timer->prev = s.tail;
+  timer->next = nullptr;
+  if (s.tail) {
+    s.tail->next = timer;
+  } else {
+    s.head = timer;
+  }
+  s.tail = timer;
+  level_count_[level]++;
+}
+
+void TimerWheel::Unlink(Timer* timer) {
+  if (timer->level < 0) {
+    return;
+  }
+  Slot& s = slots_[timer->level][timer->slot];
+  if (timer->prev) {
+    timer->prev->next = timer->next;
+  } else {
+    s.head = timer->next;
+  }
+  if (timer->next) {
+    timer->next->prev = timer->prev;
+  } else {
+    s.tail = timer->prev;
+  }
+  level_count_[timer->level]--;
+  timer->prev = nullptr;
+  timer->next = nullptr;
+  timer->level = -1;
+  timer->slot = -1;
+}
+
+void TimerWheel::Cascade(int level) {
+  Slot& s = slots_[level][(current_tick_ >> (kSlotBits * level)) &
+                          (kSlots - 1)];
+  Timer* timer = s.head;
+  s.head = nullptr;
+  s.tail = nullptr;
+  while (timer) {
+    Timer* next = timer->next;
+    level_count_[level]--;
+    Insert(timer);
+    timer = next;
+  }
+}
+
+void TimerWheel::Expire(std::vector<TimerId>* expired) {
+  Slot& s = slots_[0][current_tick_ & (kSlots - 1)];
+  if (!s.head) {
+    return;
+  }
+
+  // Timers that expire in the same tick are reported in the order that they
+  // were started.
+  size_t begin = expired->size();
+  Timer* timer = s.head;
+  while (timer) {
+    Timer* next = timer->next;
+    Unlink(timer);
+    if (!timer->queued) {
+      timer->queued = true;
+      expired->push_back(timer->id);
+    }
+    if (timer->interval > 0) {
+      timer->expires = current_tick_ + timer->interval;
+      Insert(timer);
+    }
+    timer = next;
+  }
+  std::sort(expired->begin() + begin, expired->end());
+}
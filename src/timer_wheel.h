@@ -0,0 +1,97 @@
+#ifndef WINDOWJS_TIMER_WHEEL_H
+#define WINDOWJS_TIMER_WHEEL_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using Task = std::function<void()>;
+
+// A hierarchical timing wheel, with millisecond resolution.
+//
+// Starting and cancelling a timer takes constant time, and cancelled timers
+// are removed immediately. Timers are kept in 4 levels of 64 slots each; a
+// slot in level N covers 64^N ticks, and its timers cascade down into the
+// lower levels as time advances.
+//
+// This class is not thread-safe.
+class TimerWheel {
+ public:
+  using TimerId = uint64_t;
+
+  TimerWheel();
+  ~TimerWheel();
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+  TimerWheel(TimerWheel&&) = default;
+  TimerWheel& operator=(TimerWheel&&) = default;
+
+  // Starts a timer that expires after "delay" seconds. If "interval" is
+  // positive then the timer expires again after every "interval" seconds,
+  // until it is cancelled.
+  TimerId Start(double now, double delay, double interval, Task task);
+
+  // Removes the timer "id". Returns false if "id" isn't a current timer.
+  bool Cancel(TimerId id);
+
+  // Advances the wheel to "now", and appends the timers that expired to
+  // "expired", in the order that they expire. Repeating timers are re-armed
+  // for their next interval.
+  //
+  // Expired timers keep their task until BeginRun() is called. A timer that
+  // expires again before its previous expiration was run is only reported
+  // once.
+  void Advance(double now, std::vector<TimerId>* expired);
+
+  // Moves the task of the expired timer "id" into "task". Returns false if the
+  // timer was cancelled. One-shot timers are removed; repeating timers must
+  // get their task back via EndRun().
+  bool BeginRun(TimerId id, Task* task);
+  void EndRun(TimerId id, Task task);
+
+  // Returns the earliest time when a timer expires, across all the levels, or
+  // infinity if there are no pending timers.
+  double GetNextExpiration() const;
+
+ private:
+  static constexpr int kLevels = 4;
+  static constexpr int kSlotBits = 6;
+  static constexpr int kSlots = 1 << kSlotBits;
+
+  struct Timer {
+    TimerId id;
+    uint64_t expires;
+    uint64_t interval;
+    Task task;
+    Timer* prev = nullptr;
+    Timer* next = nullptr;
+    int level = -1;
+    int slot = -1;
+    bool queued = false;
+  };
+
+  struct Slot {
+    Timer* head = nullptr;
+    Timer* tail = nullptr;
+  };
+
+  // Returns true if there are no timers waiting to expire.
+  bool IsEmpty() const;
+
+  void Insert(Timer* timer);
+  void Unlink(Timer* timer);
+  void Cascade(int level);
+  void Expire(std::vector<TimerId>* expired);
+
+  std::unordered_map<TimerId, std::unique_ptr<Timer>> timers_;
+  std::array<std::array<Slot, kSlots>, kLevels> slots_;
+  std::array<int, kLevels> level_count_;
+  uint64_t current_tick_;
+  TimerId next_id_;
+};
+
+#endif  // WINDOWJS_TIMER_WHEEL_H
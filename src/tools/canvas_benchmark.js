@@ -0,0 +1,181 @@
+// Canvas benchmark for Window.js.
+//
+// Reports the calls per second of the hot CanvasRenderingContext2D methods
+// that have v8 Fast API versions, and of the style setters. Each method is
+// called in a loop that gets optimized first, so that the fast versions are
+// used.
+//
+// Then compares drawing a static layer with one call per tile from Javascript
+// against replaying the same calls recorded in a CanvasPicture, and drawing
+// many particles and sprites with one call each against the bulk fillRects,
+// fillCircles and drawAtlas methods. For example:
+//
+//   ./windowjs src/tools/canvas_benchmark.js -- 1000000
+//
+// Usage: windowjs canvas_benchmark.js [-- calls]
+
+const kWarmUpCalls = 100000;
+
+// Path methods start a new path after this many calls, so that the path
+// doesn't grow for the whole run.
+const kCallsPerPath = 1000;
+
+function makeBenchmarks(canvas, bitmap) {
+  return {
+    fillRect : (i) => canvas.fillRect(i % 200, 10, 16, 16),
+    clearRect : (i) => canvas.clearRect(i % 200, 10, 16, 16),
+    moveTo : (i) => canvas.moveTo(i % 200, 10),
+    lineTo : (i) => canvas.lineTo(i % 200, i % 100),
+    arc : (i) => canvas.arc(i % 200, 50, 10, 0, Math.PI),
+    translate : (i) => canvas.translate(i % 2 ? 1 : -1, 0),
+    'save/restore' : (i) => {
+      canvas.save();
+      canvas.restore();
+    },
+    fillStyle : (i) => canvas.fillStyle = i % 2 ? 'red' : '#336699',
+    font : (i) => canvas.font = i % 2 ? '16px monospace' : 'bold 12px serif',
+    drawImage : (i) => canvas.drawImage(bitmap, i % 200, 10),
+    'drawImage (9 arguments)' : (i) =>
+        canvas.drawImage(bitmap, 0, 0, 8, 8, i % 200, 10, 16, 16),
+  };
+}
+
+// Tiles of the static layer, e.g. the background of a tile map.
+const kTilesPerLayer = 256;
+
+function drawLayer(canvas) {
+  for (let i = 0; i < kTilesPerLayer; i++) {
+    canvas.fillStyle = i % 3 ? 'darkgreen' : 'olive';
+    canvas.fillRect((i % 16) * 16, Math.floor(i / 16) * 16, 15, 15);
+  }
+}
+
+// Calls "draw" "runs" times, and reports how many runs per second were done.
+// "unit" names what each run draws.
+function timeRuns(name, runs, unit, draw) {
+  const begin = performance.now();
+  for (let i = 0; i < runs; i++) {
+    draw();
+  }
+  const seconds = (performance.now() - begin) / 1000;
+  const perSecond = Math.round(runs / seconds).toLocaleString();
+  console.log(`${name}: ${perSecond} ${unit}/sec`);
+}
+
+// Particles drawn by each frame of the bulk benchmarks.
+const kParticles = 1000;
+
+function makeParticles() {
+  const xywh = new Float32Array(kParticles * 4);
+  const xyr = new Float32Array(kParticles * 3);
+  const colors = new Uint32Array(kParticles);
+  const styles = [];
+  for (let i = 0; i < kParticles; i++) {
+    // On whole pixels, so that fillRects draws a single mesh.
+    const x = Math.floor(Math.random() * 240);
+    const y = Math.floor(Math.random() * 240);
+    xywh.set([ x, y, 4, 4 ], i * 4);
+    xyr.set([ x, y, 2 ], i * 3);
+    colors[i] = (Math.random() * 0xffffff << 8 | 0xff) >>> 0;
+    styles.push('#' + colors[i].toString(16).padStart(8, '0'));
+  }
+  return {xywh, xyr, colors, styles};
+}
+
+function fillParticleRects(canvas, particles) {
+  for (let i = 0; i < kParticles; i++) {
+    canvas.fillStyle = particles.styles[i];
+    canvas.fillRect(particles.xywh[i * 4], particles.xywh[i * 4 + 1], 4, 4);
+  }
+}
+
+function fillParticleCircles(canvas, particles) {
+  for (let i = 0; i < kParticles; i++) {
+    canvas.fillStyle = particles.styles[i];
+    canvas.beginPath();
+    canvas.arc(particles.xyr[i * 3], particles.xyr[i * 3 + 1], 2, 0,
+               2 * Math.PI);
+    canvas.fill();
+  }
+}
+
+function drawParticleSprites(canvas, bitmap, particles) {
+  for (let i = 0; i < kParticles; i++) {
+    canvas.drawImage(bitmap, 0, 0, 8, 8, particles.xywh[i * 4],
+                     particles.xywh[i * 4 + 1], 8, 8);
+  }
+}
+
+function run(canvas, benchmark, calls) {
+  for (let i = 0; i < calls; i++) {
+    benchmark(i);
+    if (i % kCallsPerPath == 0) {
+      canvas.beginPath();
+    }
+  }
+  canvas.beginPath();
+}
+
+function main() {
+  const calls = Process.args.length > 0 ? parseInt(Process.args[0]) : 1000000;
+  window.visible = false;
+
+  const canvas = new CanvasRenderingContext2D(256, 256);
+  const source = new CanvasRenderingContext2D(16, 16);
+  source.fillStyle = 'red';
+  source.fillRect(0, 0, 16, 16);
+  const bitmap = new ImageBitmap(source.getImageData(0, 0, 16, 16));
+
+  const benchmarks = makeBenchmarks(canvas, bitmap);
+  for (const name in benchmarks) {
+    const benchmark = benchmarks[name];
+    run(canvas, benchmark, kWarmUpCalls);
+    const begin = performance.now();
+    run(canvas, benchmark, calls);
+    const seconds = (performance.now() - begin) / 1000;
+    const perSecond = Math.round(calls / seconds).toLocaleString();
+    console.log(`${name}: ${perSecond} calls/sec`);
+  }
+
+  canvas.beginRecording();
+  drawLayer(canvas);
+  const picture = canvas.endRecording();
+  const layers = Math.max(1, Math.round(calls / kTilesPerLayer));
+  // Warm up both versions.
+  for (let i = 0; i < 100; i++) {
+    drawLayer(canvas);
+    canvas.drawPicture(picture);
+  }
+  timeRuns('layer from Javascript', layers, 'frames', () => drawLayer(canvas));
+  timeRuns('layer from CanvasPicture', layers, 'frames',
+           () => canvas.drawPicture(picture));
+
+  const particles = makeParticles();
+  const xforms = new Float32Array(kParticles * 4);
+  const sprites = new Float32Array(kParticles * 4);
+  for (let i = 0; i < kParticles; i++) {
+    xforms.set([ 1, 0, particles.xywh[i * 4], particles.xywh[i * 4 + 1] ],
+               i * 4);
+    sprites.set([ 0, 0, 8, 8 ], i * 4);
+  }
+  const frames = Math.max(1, Math.round(calls / kParticles));
+  const bulk = {
+    'rects from Javascript' : () => fillParticleRects(canvas, particles),
+    'fillRects' : () => canvas.fillRects(particles.xywh, particles.colors),
+    'circles from Javascript' : () => fillParticleCircles(canvas, particles),
+    'fillCircles' : () => canvas.fillCircles(particles.xyr, particles.colors),
+    'sprites from Javascript' : () =>
+        drawParticleSprites(canvas, bitmap, particles),
+    'drawAtlas' : () => canvas.drawAtlas(bitmap, xforms, sprites),
+  };
+  for (const name in bulk) {
+    for (let i = 0; i < 100; i++) {
+      bulk[name]();
+    }
+    timeRuns(`${kParticles} ${name}`, frames, 'frames', bulk[name]);
+  }
+
+  window.close();
+}
+
+main();
@@ -11,8 +11,16 @@ static unsigned char ToHex(unsigned char x) {
 }
 
 int main(int argc, const char* argv[]) {
+  // With --raw, the inputs are embedded uncompressed and aligned to 8 bytes,
+  // so that they can be used in place. This is used for the startup snapshot.
+  bool raw = argc > 1 && std::string(argv[1]) == "--raw";
+  if (raw) {
+    argc--;
+    argv++;
+  }
+
   if (argc < 4 || argc % 2 != 0) {
-    std::cerr << "Usage: embed <output> [<symbol> <input>]+\n";
+    std::cerr << "Usage: embed [--raw] <output> [<symbol> <input>]+\n";
     std::exit(1);
   }
 
@@ -37,13 +45,20 @@ int main(int argc, const char* argv[]) {
     std::string content((std::istreambuf_iterator<char>(in)),
                         std::istreambuf_iterator<char>());
 
-    std::string compressed = GzipCompress(content, Z_BEST_COMPRESSION);
+    std::string data =
+        raw ? content : GzipCompress(content, Z_BEST_COMPRESSION);
 
-    out << "\n// Gzip-compressed contents of " << file << "\n";
-    out << "extern const std::string_view " << symbol << "{\n";
-    out << "    \"";
+    if (raw) {
+      out << "\n// Contents of " << file << "\n";
+      out << "alignas(8) static const char " << symbol << "Data[] = {\n";
+      out << "    \"";
+    } else {
+      out << "\n// Gzip-compressed contents of " << file << "\n";
+      out << "extern const std::string_view " << symbol << "{\n";
+      out << "    \"";
+    }
     int count = 0;
-    for (unsigned char c : compressed) {
+    for (unsigned char c : data) {
       if (count == 16) {
         out << "\"\n    \"";
         count = 0;
@@ -51,7 +66,13 @@ int main(int argc, const char* argv[]) {
       out << "\\x" << ToHex(c >> 4) << ToHex(c & 0xf);
       count++;
     }
-    out << "\",\n    " << compressed.size() << "\n};\n";
+    if (raw) {
+      out << "\"\n};\n";
+      out << "extern const std::string_view " << symbol << "{" << symbol
+          << "Data, " << data.size() << "};\n";
+    } else {
+      out << "\",\n    " << data.size() << "\n};\n";
+    }
   }
 
   out.close();
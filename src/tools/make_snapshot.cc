@@ -0,0 +1,66 @@
+// Creates the startup snapshot of Window.js: a v8 heap with a context where
+// the Javascript APIs are already installed, and with the constant strings of
+// JsStrings.
+//
+// Isolates created from the snapshot skip JsApi::InstallGlobals(), which
+// creates hundreds of functions and templates on every load and reload.
+//
+// ES modules can't be serialized in v8 snapshots, so the embedded sources
+// aren't included; their compiled code is reused from the CodeCache instead.
+//
+// Usage: make-snapshot <output>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "../config.h"
+#include "../fail.h"
+#include "../file.h"
+#include "../js.h"
+#include "../js_api.h"
+#include "../js_scope.h"
+#include "../thread.h"
+
+// These are defined by each executable, and aren't used to create the
+// snapshot. kEmbeddedSnapshot is the output of this tool, so it's empty here.
+bool windowjs_config_pass_args_to_loader = false;
+extern const std::string_view kEmbeddedDefaultSource{};
+extern const std::string_view kEmbeddedSnapshot{};
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "Usage: make-snapshot <output>\n";
+    std::exit(1);
+  }
+
+  InitFail();
+  InitMainThread();
+  Js::Init(argv[0]);
+
+  std::string snapshot;
+  {
+    Js js(JsApi::GetExternalReferences());
+    {
+      JsScope scope(&js);
+      JsApi::InstallGlobals(scope);
+      // Build the lazy APIs now, so that contexts created from the snapshot
+      // don't have to.
+      JsApi::MaterializeGlobals(scope);
+    }
+    v8::StartupData blob = js.CreateSnapshot();
+    snapshot.assign(blob.data, blob.raw_size);
+    delete[] blob.data;
+  }
+
+  Js::Shutdown();
+
+  std::string error;
+  if (!WriteFile(argv[1], snapshot, &error)) {
+    std::cerr << "Failed to write " << argv[1] << ": " << error << "\n";
+    std::exit(1);
+  }
+
+  return 0;
+}
@@ -0,0 +1,208 @@
+// Startup benchmark for Window.js.
+//
+// Launches a Window.js executable with --profile-startup several times and
+// reports the median time spent creating the Javascript context and APIs, and
+// until the first frame is visible. Each run is killed once its first frame
+// is shown.
+//
+// The same module is measured with the startup snapshot, without it, and
+// without it and without lazy APIs, to show the savings of each. For example:
+//
+//   startup-benchmark ./windowjs examples/hello.js
+//   startup-benchmark ./windowjs-p5 examples/p5/hello.js
+//
+// Usage: startup-benchmark <windowjs> <module> [runs]
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <uv.h>
+
+struct Run {
+  std::string output;
+  // Times logged by --profile-startup, in seconds since glfwInit().
+  std::map<std::string, double> events;
+  bool finished = false;
+  uv_process_t process;
+  uv_pipe_t pipe;
+  uv_timer_t timeout;
+};
+
+// Logged by the window when the first frame is shown.
+static const char kLastEvent[] = "set visible and finish";
+
+static const char kTag[] = "[profile-startup] ";
+
+static void KillRun(Run* run) {
+  uv_process_kill(&run->process, SIGTERM);
+}
+
+static void ParseOutput(Run* run) {
+  size_t end;
+  while ((end = run->output.find('\n')) != std::string::npos) {
+    std::string line = run->output.substr(0, end);
+    run->output.erase(0, end + 1);
+    size_t begin = line.find(kTag);
+    size_t colon = line.rfind(": ");
+    if (begin == std::string::npos || colon == std::string::npos ||
+        colon < begin) {
+      continue;
+    }
+    begin += sizeof(kTag) - 1;
+    std::string event = line.substr(begin, colon - begin);
+    run->events[event] = std::atof(line.c_str() + colon + 2);
+    if (event == kLastEvent && !run->finished) {
+      run->finished = true;
+      KillRun(run);
+    }
+  }
+}
+
+static void OnAlloc(uv_handle_t* handle, size_t suggested_size,
+                    uv_buf_t* buf) {
+  buf->base = new char[suggested_size];
+  buf->len = static_cast<decltype(buf->len)>(suggested_size);
+}
+
+static void OnRead(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+  Run* run = static_cast<Run*>(stream->data);
+  if (nread > 0) {
+    run->output.append(buf->base, nread);
+    ParseOutput(run);
+  } else if (nread < 0) {
+    uv_close(reinterpret_cast<uv_handle_t*>(stream), nullptr);
+  }
+  delete[] buf->base;
+}
+
+static void OnExit(uv_process_t* process, int64_t exit_status,
+                   int term_signal) {
+  Run* run = static_cast<Run*>(process->data);
+  uv_timer_stop(&run->timeout);
+  uv_close(reinterpret_cast<uv_handle_t*>(&run->timeout), nullptr);
+  uv_close(reinterpret_cast<uv_handle_t*>(process), nullptr);
+}
+
+static void OnTimeout(uv_timer_t* timer) {
+  KillRun(static_cast<Run*>(timer->data));
+}
+
+// Returns false if the executable failed to start or to show a frame.
+static bool StartupOnce(const std::string& exe, const std::string& module,
+                        const std::vector<std::string>& flags, Run* run) {
+  uv_loop_t loop;
+  uv_loop_init(&loop);
+
+  std::vector<std::string> args = {exe, "--profile-startup"};
+  args.insert(args.end(), flags.begin(), flags.end());
+  args.push_back(module);
+  std::vector<char*> argv;
+  for (std::string& arg : args) {
+    argv.push_back(arg.data());
+  }
+  argv.push_back(nullptr);
+
+  uv_pipe_init(&loop, &run->pipe, 0);
+  run->pipe.data = run;
+
+  // The startup times are logged to stderr.
+  uv_stdio_container_t stdio[3];
+  stdio[0].flags = UV_IGNORE;
+  stdio[1].flags = UV_IGNORE;
+  stdio[2].flags =
+      static_cast<uv_stdio_flags>(UV_CREATE_PIPE | UV_WRITABLE_PIPE);
+  stdio[2].data.stream = reinterpret_cast<uv_stream_t*>(&run->pipe);
+
+  uv_process_options_t options = {};
+  options.exit_cb = OnExit;
+  options.file = exe.c_str();
+  options.args = argv.data();
+  options.stdio_count = 3;
+  options.stdio = stdio;
+
+  run->process.data = run;
+  int error = uv_spawn(&loop, &run->process, &options);
+  if (error != 0) {
+    std::cerr << "Failed to run " << exe << ": " << uv_strerror(error) << "\n";
+    uv_close(reinterpret_cast<uv_handle_t*>(&run->pipe), nullptr);
+    uv_run(&loop, UV_RUN_DEFAULT);
+    uv_loop_close(&loop);
+    return false;
+  }
+
+  uv_read_start(reinterpret_cast<uv_stream_t*>(&run->pipe), OnAlloc, OnRead);
+
+  uv_timer_init(&loop, &run->timeout);
+  run->timeout.data = run;
+  uv_timer_start(&run->timeout, OnTimeout, 30000, 0);
+
+  uv_run(&loop, UV_RUN_DEFAULT);
+  uv_loop_close(&loop);
+
+  return run->finished;
+}
+
+static double Median(std::vector<double> values) {
+  if (values.empty()) {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+int main(int argc, const char* argv[]) {
+  int runs = argc > 3 ? std::atoi(argv[3]) : 10;
+  if (argc < 3 || runs <= 0) {
+    std::cerr << "Usage: startup-benchmark <windowjs> <module> [runs]\n";
+    std::exit(1);
+  }
+
+  std::string exe = argv[1];
+  std::string module = argv[2];
+
+  struct Config {
+    const char* name;
+    std::vector<std::string> flags;
+  };
+
+  const Config configs[] = {
+      {"snapshot", {}},
+      {"lazy APIs", {"--no-snapshot"}},
+      {"eager APIs", {"--no-snapshot", "--no-lazy-api"}},
+  };
+
+  std::cout << "Startup of " << module << ", median of " << runs
+            << " runs, in milliseconds\n";
+  std::cout << std::setw(12) << "" << std::setw(16) << "JS context+APIs"
+            << std::setw(16) << "module loaded" << std::setw(16)
+            << "first frame\n";
+
+  for (const Config& config : configs) {
+    std::vector<double> context;
+    std::vector<double> loaded;
+    std::vector<double> frame;
+    for (int i = 0; i < runs; i++) {
+      Run run;
+      if (!StartupOnce(exe, module, config.flags, &run)) {
+        std::cerr << "Run " << i << " with " << config.name
+                  << " didn't show a frame\n";
+        std::exit(1);
+      }
+      context.push_back(run.events["create JS APIs end"] -
+                        run.events["create JS context start"]);
+      loaded.push_back(run.events["load initial module end"]);
+      frame.push_back(run.events[kLastEvent]);
+    }
+    std::cout << std::fixed << std::setprecision(2) << std::setw(12)
+              << config.name << std::setw(16) << Median(context) * 1000
+              << std::setw(16) << Median(loaded) * 1000 << std::setw(15)
+              << Median(frame) * 1000 << "\n";
+  }
+
+  return 0;
+}
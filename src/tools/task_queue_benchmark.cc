@@ -0,0 +1,327 @@
+// Stress benchmark for ThreadPoolTaskQueue and TaskQueue.
+//
+// Compares the throughput of the work-stealing ThreadPoolTaskQueue with a
+// pool that shares a single mutex and queue between all threads, which is how
+// ThreadPoolTaskQueue used to be implemented.
+//
+// Also compares the producer throughput and the number of main loop wake ups
+// of TaskQueue::Post() with a queue that takes a lock and posts a wake up on
+// every call, which is how TaskQueue used to be implemented.
+//
+// Usage: task-queue-benchmark [num_threads] [tasks_per_producer]
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../signal.h"
+#include "../task_queue.h"
+
+// The single-lock pool, for comparison. Only supports immediate tasks.
+class MutexThreadPool {
+ public:
+  explicit MutexThreadPool(int num_threads) : quit_(false) {
+    for (int i = 0; i < num_threads; i++) {
+      threads_.emplace_back(&MutexThreadPool::Run, this);
+    }
+  }
+
+  ~MutexThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      quit_ = true;
+    }
+    cond_var_.notify_all();
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Post(Task task) {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      tasks_.emplace(std::move(task));
+    }
+    cond_var_.notify_one();
+  }
+
+ private:
+  void Run() {
+    for (;;) {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(lock_);
+        while (!quit_ && tasks_.empty()) {
+          cond_var_.wait(lock);
+        }
+        if (quit_) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+      task();
+    }
+  }
+
+  std::mutex lock_;
+  std::condition_variable cond_var_;
+  std::queue<Task> tasks_;
+  std::vector<std::thread> threads_;
+  bool quit_;
+};
+
+// The single-lock main thread queue, for comparison. Wakes up the consumer on
+// every Post(), like the previous calls to glfwPostEmptyEvent().
+class MutexTaskQueue {
+ public:
+  MutexTaskQueue() : wake_ups_(0), wake_up_signal_(nullptr) {}
+
+  void SetWakeUpSignal(Signal* signal) { wake_up_signal_ = signal; }
+
+  void Post(Task task) {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      tasks_.emplace(std::move(task));
+    }
+    wake_ups_++;
+    wake_up_signal_->SetAndNotify();
+  }
+
+  void RunTasks() {
+    for (;;) {
+      Task task;
+      {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+      task();
+    }
+  }
+
+  uint64_t wake_ups() const { return wake_ups_; }
+
+ private:
+  std::mutex lock_;
+  std::queue<Task> tasks_;
+  std::atomic<uint64_t> wake_ups_;
+  Signal* wake_up_signal_;
+};
+
+static double Seconds() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Burns a little bit of CPU, so that tasks aren't completely empty.
+static void Work(int iterations) {
+  volatile int x = 0;
+  for (int i = 0; i < iterations; i++) {
+    x = x + i;
+  }
+}
+
+// Completion state shared with the tasks, so that it outlives the last task
+// even after the benchmark function returns.
+struct Completion {
+  explicit Completion(int total) : total(total), done(0) {}
+
+  void Done() {
+    if (++done == total) {
+      finished.SetAndNotify();
+    }
+  }
+
+  const int total;
+  std::atomic<int> done;
+  Signal finished;
+};
+
+// "num_producers" threads post "tasks_per_producer" tasks each.
+template <typename Pool>
+static double PostFromProducers(Pool* pool, int num_producers,
+                                int tasks_per_producer, int work) {
+  int total = num_producers * tasks_per_producer;
+  auto completion = std::make_shared<Completion>(total);
+
+  double start = Seconds();
+  std::vector<std::thread> producers;
+  for (int p = 0; p < num_producers; p++) {
+    producers.emplace_back([=]() {
+      for (int i = 0; i < tasks_per_producer; i++) {
+        pool->Post([=]() {
+          Work(work);
+          completion->Done();
+        });
+      }
+    });
+  }
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+  completion->finished.Wait();
+  return total / (Seconds() - start);
+}
+
+template <typename Pool>
+static void FanOutNode(Pool* pool, std::shared_ptr<Completion> completion,
+                       int level, int depth, int work) {
+  if (level < depth) {
+    for (int i = 0; i < 2; i++) {
+      pool->Post([=]() {
+        FanOutNode(pool, completion, level + 1, depth, work);
+      });
+    }
+  }
+  Work(work);
+  completion->Done();
+}
+
+// Each task posts more tasks from the pool's threads, as a tree.
+template <typename Pool>
+static double FanOut(Pool* pool, int depth, int work) {
+  auto completion = std::make_shared<Completion>((1 << (depth + 1)) - 1);
+
+  double start = Seconds();
+  pool->Post([=]() { FanOutNode(pool, completion, 0, depth, work); });
+  completion->finished.Wait();
+  return completion->total / (Seconds() - start);
+}
+
+struct MainQueueResult {
+  double posts_per_second;
+  uint64_t wake_ups;
+};
+
+static uint64_t GetWakeUps(const MutexTaskQueue& queue) {
+  return queue.wake_ups();
+}
+
+static uint64_t GetWakeUps(const TaskQueue& queue) {
+  return queue.counters().wake_ups;
+}
+
+// "num_producers" threads post "tasks_per_producer" tasks each, while the
+// consumer thread runs the tasks once per millisecond, like a main loop.
+//
+// Wake ups notify a Signal instead of posting GLFW empty events, so that the
+// benchmark runs without a display. The consumer doesn't wait on it; only the
+// number of wake ups is compared.
+template <typename Queue>
+static MainQueueResult PostToMainQueue(int num_producers,
+                                       int tasks_per_producer) {
+  Signal wake_up;
+  Queue queue;
+  queue.SetWakeUpSignal(&wake_up);
+  int total = num_producers * tasks_per_producer;
+  int done = 0;
+
+  std::atomic<bool> quit(false);
+  std::thread consumer([&]() {
+    while (!quit) {
+      queue.RunTasks();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    queue.RunTasks();
+  });
+
+  double start = Seconds();
+  std::vector<std::thread> producers;
+  for (int p = 0; p < num_producers; p++) {
+    producers.emplace_back([&]() {
+      for (int i = 0; i < tasks_per_producer; i++) {
+        queue.Post([&]() { done++; });
+      }
+    });
+  }
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+  double elapsed = Seconds() - start;
+
+  quit = true;
+  consumer.join();
+  if (done != total) {
+    std::cerr << "Lost tasks: " << done << " of " << total << "\n";
+    std::exit(1);
+  }
+
+  return MainQueueResult{total / elapsed, GetWakeUps(queue)};
+}
+
+static void Report(const std::string& name, double mutex_tasks_per_second,
+                   double stealing_tasks_per_second) {
+  std::cout << name << "\n";
+  std::cout << "  single mutex:  " << static_cast<long>(mutex_tasks_per_second)
+            << " tasks/s\n";
+  std::cout << "  work stealing: "
+            << static_cast<long>(stealing_tasks_per_second) << " tasks/s ("
+            << stealing_tasks_per_second / mutex_tasks_per_second << "x)\n";
+}
+
+int main(int argc, const char* argv[]) {
+  int num_threads = argc > 1 ? std::atoi(argv[1])
+                             : ThreadPoolTaskQueue::DefaultNumThreads();
+  int tasks_per_producer = argc > 2 ? std::atoi(argv[2]) : 200000;
+  if (num_threads <= 0 || tasks_per_producer <= 0) {
+    std::cerr << "Usage: task-queue-benchmark [num_threads] "
+                 "[tasks_per_producer]\n";
+    std::exit(1);
+  }
+
+  // GLFW isn't initialized, so that this runs without a display. The clock of
+  // the task queues, glfwGetTime(), then reads 0. That doesn't matter here,
+  // since only immediate tasks are posted and there's no time budget.
+
+  std::cout << "Threads: " << num_threads << "\n";
+
+  MutexThreadPool mutex_pool(num_threads);
+  ThreadPoolTaskQueue stealing_pool(num_threads);
+
+  for (int producers : {1, 4}) {
+    for (int work : {0, 1000}) {
+      std::string name = std::to_string(producers) + " producer(s), work " +
+                         std::to_string(work);
+      double a =
+          PostFromProducers(&mutex_pool, producers, tasks_per_producer, work);
+      double b = PostFromProducers(&stealing_pool, producers,
+                                   tasks_per_producer, work);
+      Report(name, a, b);
+    }
+  }
+
+  for (int work : {0, 1000}) {
+    std::string name = "Fan-out from pool threads, work " +
+                       std::to_string(work);
+    double a = FanOut(&mutex_pool, 18, work);
+    double b = FanOut(&stealing_pool, 18, work);
+    Report(name, a, b);
+  }
+
+  for (int producers : {1, 4}) {
+    MainQueueResult a =
+        PostToMainQueue<MutexTaskQueue>(producers, tasks_per_producer);
+    MainQueueResult b =
+        PostToMainQueue<TaskQueue>(producers, tasks_per_producer);
+    std::cout << "Main queue, " << producers << " producer(s)\n";
+    std::cout << "  mutex:     " << static_cast<long>(a.posts_per_second)
+              << " posts/s, " << a.wake_ups << " wake ups\n";
+    std::cout << "  lock-free: " << static_cast<long>(b.posts_per_second)
+              << " posts/s, " << b.wake_ups << " wake ups ("
+              << b.posts_per_second / a.posts_per_second << "x)\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,72 @@
+// Worker benchmark for Window.js.
+//
+// Compares starting a Worker with spawning a subprocess that loads the same
+// module. Reports the median time from the start until the first message from
+// the child, and the memory used by each child. For example:
+//
+//   ./windowjs src/tools/worker_benchmark.js -- 20
+//
+// Workers share the process, so their memory is the growth of the resident set
+// size of this process while they are all running. Subprocesses report their
+// own resident set size.
+//
+// Usage: windowjs worker_benchmark.js [-- runs]
+
+const kChildModule = __dirname + '/worker_benchmark_child.js';
+
+function median(values) {
+  const sorted = values.slice().sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+function firstMessage(child) {
+  return new Promise(function(resolve) {
+    child.addEventListener('message', resolve);
+  });
+}
+
+async function startAll(runs, start) {
+  const children = [];
+  const latencies = [];
+  const messages = [];
+  for (let i = 0; i < runs; i++) {
+    const begin = performance.now();
+    const child = start();
+    const message = await firstMessage(child);
+    latencies.push(performance.now() - begin);
+    children.push(child);
+    messages.push(message);
+  }
+  return {children, latencies, messages};
+}
+
+function report(name, latencies, bytesPerChild) {
+  const mb = (bytesPerChild / (1024 * 1024)).toFixed(1);
+  console.log(`${name}: median start latency ${
+      median(latencies).toFixed(2)} ms, ${mb} MB per child`);
+}
+
+async function main() {
+  const runs = Process.args.length > 0 ? parseInt(Process.args[0]) : 10;
+  window.visible = false;
+
+  const rssBefore = performance.memory.residentSetSize;
+  const workers = await startAll(runs, () => new Worker(kChildModule));
+  const rssAfter = performance.memory.residentSetSize;
+  for (const worker of workers.children) {
+    worker.close();
+  }
+  report('Worker', workers.latencies, (rssAfter - rssBefore) / runs);
+
+  const processes = await startAll(
+      runs, () => Process.spawn(kChildModule, [], {log : false}));
+  for (const child of processes.children) {
+    child.close();
+  }
+  report('Process.spawn', processes.latencies,
+         median(processes.messages.map((m) => m.residentSetSize)));
+
+  window.close();
+}
+
+main();
@@ -0,0 +1,10 @@
+// The child module of worker_benchmark.js. It runs both as a Worker and as a
+// subprocess, and reports its resident set size to the parent once loaded.
+
+const parent = typeof Process == 'undefined' ? Worker.parent : Process.parent;
+
+if (typeof window != 'undefined') {
+  window.visible = false;
+}
+
+parent.postMessage({residentSetSize : performance.memory.residentSetSize});
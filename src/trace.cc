@@ -0,0 +1,226 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+std::atomic<bool> Trace::enabled_(false);
+
+namespace {
+
+// Number of events kept per thread.
+constexpr uint64_t kBufferSize = 1 << 15;
+
+struct ThreadBuffer {
+  int thread_id = 0;
+  // Protected by Buffers::lock.
+  const char* name = nullptr;
+  bool in_use = true;
+
+  std::unique_ptr<Trace::Event[]> events{new Trace::Event[kBufferSize]};
+  // Number of events ever recorded. Only the owner thread writes to "events"
+  // and "count".
+  std::atomic<uint64_t> count{0};
+  // Set by the owner thread while it records an event. Stop() waits until
+  // it's cleared before copying "events".
+  std::atomic<bool> writing{false};
+};
+
+struct Buffers {
+  std::mutex lock;
+  // Buffers outlive their threads, so that the events of threads that have
+  // exited are still exported. Buffers of exited threads are reused by new
+  // threads.
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Buffers* GetBuffers() {
+  static Buffers* buffers = new Buffers;
+  return buffers;
+}
+
+// Not glfwGetTime(), which is reset when the main module is reloaded.
+double Now() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+std::atomic<double> g_start_time(0);
+std::atomic<uint64_t> g_next_flow_id(1);
+
+// Releases the thread's buffer when the thread exits. Buffers are only
+// allocated once a thread records its first event.
+struct ThreadBufferHolder {
+  ~ThreadBufferHolder() {
+    if (buffer) {
+      Buffers* buffers = GetBuffers();
+      std::lock_guard<std::mutex> lock(buffers->lock);
+      buffer->in_use = false;
+    }
+  }
+
+  ThreadBuffer* buffer = nullptr;
+  const char* name = nullptr;
+};
+
+thread_local ThreadBufferHolder t_holder;
+
+ThreadBuffer* GetThreadBuffer() {
+  if (t_holder.buffer) {
+    return t_holder.buffer;
+  }
+
+  Buffers* buffers = GetBuffers();
+  std::lock_guard<std::mutex> lock(buffers->lock);
+  for (const std::unique_ptr<ThreadBuffer>& buffer : buffers->buffers) {
+    if (!buffer->in_use) {
+      buffer->in_use = true;
+      buffer->name = t_holder.name;
+      t_holder.buffer = buffer.get();
+      return t_holder.buffer;
+    }
+  }
+  buffers->buffers.emplace_back(std::make_unique<ThreadBuffer>());
+  t_holder.buffer = buffers->buffers.back().get();
+  t_holder.buffer->thread_id = static_cast<int>(buffers->buffers.size());
+  t_holder.buffer->name = t_holder.name;
+  return t_holder.buffer;
+}
+
+}  // namespace
+
+// static
+void Trace::Start() {
+  g_start_time = Now();
+  enabled_ = true;
+}
+
+// static
+Trace::Snapshot Trace::Stop() {
+  enabled_ = false;
+  double start_time = g_start_time;
+
+  Snapshot snapshot;
+  Buffers* buffers = GetBuffers();
+  std::lock_guard<std::mutex> lock(buffers->lock);
+  for (const std::unique_ptr<ThreadBuffer>& buffer : buffers->buffers) {
+    // An event that was being recorded when tracing stopped is finished
+    // first. Later events see that tracing is disabled, and aren't recorded.
+    while (buffer->writing.load()) {
+      std::this_thread::yield();
+    }
+    uint64_t end = buffer->count.load(std::memory_order_relaxed);
+    uint64_t begin = end > kBufferSize ? end - kBufferSize : 0;
+    for (uint64_t i = begin; i < end; i++) {
+      const Event& event = buffer->events[i % kBufferSize];
+      if (event.timestamp >= start_time) {
+        snapshot.events.push_back(event);
+        snapshot.events.back().thread_id = buffer->thread_id;
+      }
+    }
+    if (buffer->name) {
+      snapshot.thread_names.emplace_back(buffer->thread_id, buffer->name);
+    }
+  }
+  return snapshot;
+}
+
+// static
+void Trace::SetThreadName(const char* name) {
+  t_holder.name = name;
+  if (t_holder.buffer) {
+    Buffers* buffers = GetBuffers();
+    std::lock_guard<std::mutex> lock(buffers->lock);
+    t_holder.buffer->name = name;
+  }
+}
+
+// static
+void Trace::Begin(const char* category, const char* name) {
+  if (IsEnabled()) {
+    Event event{};
+    event.phase = 'B';
+    event.category = category;
+    event.name = name;
+    event.timestamp = Now();
+    Add(event);
+  }
+}
+
+// static
+void Trace::End(const char* category, const char* name) {
+  if (IsEnabled()) {
+    Event event{};
+    event.phase = 'E';
+    event.category = category;
+    event.name = name;
+    event.timestamp = Now();
+    Add(event);
+  }
+}
+
+// static
+std::function<void()> Trace::WrapTask(const char* category,
+                                      const TraceLocation& from, double delay,
+                                      std::function<void()> task) {
+  if (!IsEnabled()) {
+    return task;
+  }
+
+  Event posted{};
+  posted.phase = 's';
+  posted.category = category;
+  posted.name = from.function;
+  posted.timestamp = Now();
+  posted.file = from.file;
+  posted.line = from.line;
+
+  // Repeating tasks run many times for a single post, so they don't get a
+  // flow or a queueing time.
+  bool repeating = delay < 0;
+  if (!repeating) {
+    posted.id = g_next_flow_id.fetch_add(1, std::memory_order_relaxed);
+    Add(posted);
+  }
+  double ready = posted.timestamp + delay;
+
+  return [posted, ready, repeating, task = std::move(task)] {
+    double start = Now();
+    task();
+    if (!IsEnabled()) {
+      return;
+    }
+    double end = Now();
+
+    if (!repeating) {
+      Event flow = posted;
+      flow.phase = 'f';
+      flow.timestamp = start;
+      Add(flow);
+    }
+
+    Event run = posted;
+    run.phase = 'X';
+    run.timestamp = start;
+    run.duration = end - start;
+    run.queued = repeating ? -1 : std::max(0.0, start - ready);
+    Add(run);
+  };
+}
+
+// static
+void Trace::Add(const Event& event) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  // "writing" and enabled_ are sequentially consistent, so that either this
+  // sees that Stop() disabled tracing, or Stop() sees "writing" and waits for
+  // the event. The release store publishes the event to Stop().
+  buffer->writing.store(true);
+  if (enabled_.load()) {
+    uint64_t count = buffer->count.load(std::memory_order_relaxed);
+    buffer->events[count % kBufferSize] = event;
+    buffer->count.store(count + 1, std::memory_order_relaxed);
+  }
+  buffer->writing.store(false, std::memory_order_release);
+}
@@ -0,0 +1,103 @@
+#ifndef WINDOWJS_TRACE_H
+#define WINDOWJS_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Where a task was posted from. The default arguments of Current() capture
+// the caller of the function that has a TraceLocation as a default argument.
+struct TraceLocation {
+  static TraceLocation Current(const char* function = __builtin_FUNCTION(),
+                               const char* file = __builtin_FILE(),
+                               int line = __builtin_LINE()) {
+    return TraceLocation{function, file, line};
+  }
+
+  const char* function;
+  const char* file;
+  int line;
+};
+
+// Records timestamped events from any thread, and exports them in the Chrome
+// trace event format. The exported JSON can be loaded in chrome://tracing or
+// in https://ui.perfetto.dev.
+//
+// Each thread records into its own ring buffer without taking locks, and the
+// oldest events get overwritten when a buffer is full. All names and
+// categories must be string literals, since only the pointers are recorded.
+//
+// Recording is a single relaxed atomic load while tracing is disabled.
+class Trace {
+ public:
+  struct Event {
+    // One of the Chrome trace event phases: 'B' and 'E' for the beginning and
+    // end of a phase, 'X' for a complete task, and 's' and 'f' for the flow
+    // from where a task was posted to where it ran.
+    char phase;
+    const char* category;
+    const char* name;
+    // In seconds, from a monotonic clock.
+    double timestamp;
+    // For 'X' events.
+    double duration;
+    // For 'X' events: how long the task waited to run after it was ready, or
+    // a negative value if unknown.
+    double queued;
+    // For flow events.
+    uint64_t id;
+    // For 'X' and 's' events: where the task was posted from.
+    const char* file;
+    int line;
+    // Set when the events are copied by Stop().
+    int thread_id;
+  };
+
+  struct Snapshot {
+    std::vector<Event> events;
+    std::vector<std::pair<int, std::string>> thread_names;
+  };
+
+  static bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  // Starts recording. Events recorded before the most recent call to Start()
+  // are not exported.
+  static void Start();
+
+  // Stops recording, and returns a copy of the recorded events. Events that
+  // other threads are recording meanwhile are either finished before the copy
+  // or dropped. ToJson() converts them to Chrome trace event JSON, and can be
+  // called from any thread; it's defined in trace_json.cc.
+  static Snapshot Stop();
+  static std::string ToJson(const Snapshot& snapshot);
+
+  // Names the current thread in the exported traces. "name" must be a string
+  // literal.
+  static void SetThreadName(const char* name);
+
+  // Marks the beginning and end of a phase in the current thread.
+  static void Begin(const char* category, const char* name);
+  static void End(const char* category, const char* name);
+
+  // Returns "task" wrapped so that posting it, and its execution, get
+  // recorded. "delay" is the number of seconds after posting when the task
+  // becomes ready to run, or negative for repeating tasks.
+  //
+  // Returns "task" unmodified if tracing is disabled.
+  static std::function<void()> WrapTask(const char* category,
+                                        const TraceLocation& from,
+                                        double delay,
+                                        std::function<void()> task);
+
+ private:
+  static void Add(const Event& event);
+
+  static std::atomic<bool> enabled_;
+};
+
+#endif  // WINDOWJS_TRACE_H
@@ -0,0 +1,78 @@
+#include "trace.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include "json.h"
+
+// Trace::ToJson() is separate from the recording in trace.cc, so that tools
+// that only record traces don't depend on Json.
+
+namespace {
+
+void WriteCommon(std::ostream& out, const Trace::Event& event) {
+  out << "{\"name\":" << Json::EscapeString(event.name)
+      << ",\"cat\":" << Json::EscapeString(event.category) << ",\"ph\":\""
+      << event.phase << "\",\"ts\":" << event.timestamp * 1e6
+      << ",\"pid\":1,\"tid\":" << event.thread_id;
+}
+
+void WriteSource(std::ostream& out, const Trace::Event& event) {
+  std::string source = event.file;
+  source.append(":").append(std::to_string(event.line));
+  out << "\"src\":" << Json::EscapeString(source);
+}
+
+}  // namespace
+
+// static
+std::string Trace::ToJson(const Snapshot& snapshot) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  auto separator = [&] {
+    if (!first) {
+      out << ",\n";
+    }
+    first = false;
+  };
+
+  for (const auto& [thread_id, name] : snapshot.thread_names) {
+    separator();
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << thread_id << ",\"args\":{\"name\":" << Json::EscapeString(name)
+        << "}}";
+  }
+
+  for (const Event& event : snapshot.events) {
+    separator();
+    WriteCommon(out, event);
+    switch (event.phase) {
+      case 'X':
+        out << ",\"dur\":" << event.duration * 1e6 << ",\"args\":{";
+        WriteSource(out, event);
+        if (event.queued >= 0) {
+          out << ",\"queued_ms\":" << event.queued * 1e3;
+        }
+        out << "}";
+        break;
+      case 's':
+        out << ",\"id\":" << event.id << ",\"args\":{";
+        WriteSource(out, event);
+        out << "}";
+        break;
+      case 'f':
+        // Binds to the enclosing 'X' event.
+        out << ",\"id\":" << event.id << ",\"bp\":\"e\"";
+        break;
+      default:
+        break;
+    }
+    out << "}";
+  }
+
+  out << "]}\n";
+  return out.str();
+}
@@ -4,23 +4,23 @@
 #include "thread.h"
 
 void* WeakPtrBase::Get() const {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   return *flag_;
 }
 
 WeakPtrFactoryBase::WeakPtrFactoryBase(void* ptr) : ptr_(ptr) {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
 }
 
 void WeakPtrFactoryBase::EnsureFlag() {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   if (!flag_) {
     flag_.reset(new void*(ptr_));
   }
 }
 
 void WeakPtrFactoryBase::Invalidate() {
-  ASSERT(IsMainThread());
+  ASSERT(IsJsThread());
   if (flag_) {
     *flag_ = nullptr;
     flag_ = nullptr;
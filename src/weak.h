@@ -3,12 +3,13 @@
 
 #include <memory>
 
-// WeakPtrs hold a weak reference to an object that lives in the main thread.
+// WeakPtrs hold a weak reference to an object that lives in the main thread,
+// or in a Worker thread.
 //
 // WeakPtrs can be copied across threads, but can only be dereferenced in the
-// main thread. This enables running tasks in background threads and getting
-// their results back in the main thread, and proceed only if the wrapped object
-// is still alive.
+// thread of their object. This enables running tasks in background threads and
+// getting their results back in that thread, and proceed only if the wrapped
+// object is still alive.
 //
 // WeakPtrs are created by WeakPtrFactory objects. At destruction time, the
 // WeakPtrFactory automatically invalidates all outstanding WeakPtrs.
@@ -50,7 +51,7 @@ class WeakPtr : public WeakPtrBase {
   WeakPtr& operator=(WeakPtr&& other) = default;
 
   // Returns the object pointer if the object is still alive, otherwise
-  // returns nullptr. Can be called only in the main thread.
+  // returns nullptr. Can be called only in the thread of the object.
   T* Get() const { return static_cast<T*>(WeakPtrBase::Get()); }
 
  private:
@@ -86,6 +87,9 @@ class WeakPtrFactory : public WeakPtrFactoryBase {
     EnsureFlag();
     return WeakPtr<T>(flag_);
   }
+
+  // Invalidates all the WeakPtrs made so far. New ones can still be made.
+  void InvalidateWeakPtrs() { Invalidate(); }
 };
 
 #endif  // WINDOWJS_WEAK_H
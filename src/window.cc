@@ -199,6 +199,7 @@ void Window::RenderAndSwapBuffers() {
 
   // Make sure that all Skia operations are sent to the GPU before swapping.
   shared_context_->Flush();
+  stats_->OnRenderFinished();
 
   glfwSwapBuffers(window_);
 
@@ -3,10 +3,12 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <GLES3/gl3.h>
 #include <GLFW/glfw3.h>
+#include <skia/include/core/SkTypeface.h>
 
 #include "canvas.h"
 #include "console.h"
@@ -51,6 +53,12 @@ class Window final {
   ConsoleOverlay* console_overlay() { return console_overlay_.get(); }
   Stats* stats() { return stats_.get(); }
 
+  // Typefaces of the system fonts, by their CSS font. These are kept across
+  // reloads, since looking them up is slow.
+  std::unordered_map<std::string, sk_sp<SkTypeface>>* fonts_cache() {
+    return &fonts_cache_;
+  }
+
   static Window* Get(GLFWwindow* window);
 
   void SetDelegate(Delegate* delegate) { delegate_ = delegate; }
@@ -172,6 +180,8 @@ class Window final {
 
   std::unique_ptr<ConsoleOverlay> console_overlay_;
   std::unique_ptr<Stats> stats_;
+
+  std::unordered_map<std::string, sk_sp<SkTypeface>> fonts_cache_;
 };
 
 #endif  // WINDOWJS_WINDOW_H
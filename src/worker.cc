@@ -0,0 +1,162 @@
+#include "worker.h"
+
+#include <utility>
+
+#include "console.h"
+#include "js_api.h"
+#include "js_api_worker.h"
+#include "js_events.h"
+#include "js_scope.h"
+#include "thread.h"
+#include "trace.h"
+
+namespace {
+
+// Threads of the pool for the background work of a worker's APIs. Workers are
+// a unit of parallelism themselves, so their I/O and CPU-bound work share a
+// small pool.
+constexpr int kNumBackgroundThreads = 2;
+
+}  // namespace
+
+WorkerThread::WorkerThread(std::filesystem::path module,
+                           MessageHandler on_message,
+                           ExceptionHandler on_exception, ExitHandler on_exit)
+    : module_(std::move(module)),
+      on_message_(std::move(on_message)),
+      on_exception_(std::move(on_exception)),
+      on_exit_(std::move(on_exit)),
+      quit_(false),
+      isolate_(nullptr),
+      parent_(nullptr),
+      loaded_(false) {
+  task_queue_.SetWakeUpSignal(&wake_up_);
+  thread_ = std::thread([this] {
+    Run();
+  });
+}
+
+WorkerThread::~WorkerThread() {
+  Terminate();
+  thread_.join();
+}
+
+void WorkerThread::PostMessage(WorkerMessage message) {
+  task_queue_.Post([this, message = std::move(message)]() mutable {
+    if (!loaded_) {
+      pending_messages_.push_back(std::move(message));
+    } else if (parent_) {
+      parent_->HandleMessage(std::move(message));
+    }
+  });
+}
+
+void WorkerThread::PostMessageToParent(WorkerMessage message) {
+  on_message_(std::move(message));
+}
+
+void WorkerThread::Close() {
+  // The loop checks quit_ once RunTasks() returns.
+  quit_ = true;
+  task_queue_.StopRunningTasks();
+}
+
+void WorkerThread::Terminate() {
+  quit_ = true;
+  {
+    // Stops long running scripts too.
+    std::lock_guard<std::mutex> lock(lock_);
+    if (isolate_) {
+      isolate_->TerminateExecution();
+    }
+  }
+  wake_up_.SetAndNotify();
+}
+
+void WorkerThread::OnMainModuleLoaded() {
+  loaded_ = true;
+  std::vector<WorkerMessage> messages;
+  messages.swap(pending_messages_);
+  for (WorkerMessage& message : messages) {
+    if (parent_) {
+      parent_->HandleMessage(std::move(message));
+    }
+  }
+}
+
+void WorkerThread::OnJavascriptException(std::string message,
+                                         std::vector<std::string> stack_trace) {
+  {
+    ConsoleLogHelper log(ConsoleLogLevel::CONSOLE_ERROR);
+    log.ss() << "Uncaught exception in Worker " << module_.string() << ": "
+             << message;
+    for (const std::string& frame : stack_trace) {
+      log.ss() << "\n  " << frame;
+    }
+  }
+  on_exception_(std::move(message), std::move(stack_trace));
+}
+
+void WorkerThread::Run() {
+  InitWorkerThread();
+  Trace::SetThreadName("Worker");
+
+  {
+    // Declared before the Js and JsApi, so that they are deleted before the
+    // pool joins its threads. Tasks of the pool post to task_queue_, which
+    // outlives it.
+    ThreadPoolTaskQueue background(kNumBackgroundThreads, "Worker background");
+    JsEvents events;
+
+    // The CodeCache can only be used by one isolate at a time, so workers
+    // always compile from source.
+    Js js(this, std::filesystem::current_path(), &task_queue_, &background,
+          nullptr);
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      isolate_ = js.isolate();
+    }
+
+    if (!quit_) {
+      v8::Locker locker(js.isolate());
+      JsApi api(nullptr, &js, &events, &task_queue_, &background,
+                &background);
+      {
+        JsScope scope(&js);
+        parent_ = WorkerApi::AttachToParent(&api, scope, this);
+      }
+
+      js.LoadMainModule(module_.string());
+
+      while (!quit_) {
+        // Tasks posted after this wake up the loop again.
+        wake_up_.Clear();
+        {
+          JsScope scope(&js);
+          // Each task is responsible for try/catching uncaught exceptions.
+          task_queue_.RunTasks();
+        }
+        if (quit_) {
+          break;
+        }
+        double wait = task_queue_.GetSecondsToNextTask();
+        if (wait < 0) {
+          wake_up_.Wait();
+        } else if (wait > 0) {
+          wake_up_.WaitFor(wait);
+        }
+      }
+
+      parent_ = nullptr;
+      pending_messages_.clear();
+      events.RemoveAll();
+      background.ResetDropAllTasks();
+      task_queue_.ResetDropAllTasks();
+    }
+
+    std::lock_guard<std::mutex> lock(lock_);
+    isolate_ = nullptr;
+  }
+
+  on_exit_();
+}
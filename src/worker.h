@@ -0,0 +1,105 @@
+#ifndef WINDOWJS_WORKER_H
+#define WINDOWJS_WORKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <v8/include/v8.h>
+
+#include "js.h"
+#include "signal.h"
+#include "task_queue.h"
+
+class WorkerApi;
+
+// A message between a Worker and its parent, serialized with a
+// v8::ValueSerializer. The backing stores of the transferred ArrayBuffers are
+// moved along with the message, without copying their contents.
+struct WorkerMessage {
+  std::vector<uint8_t> data;
+  std::vector<std::shared_ptr<v8::BackingStore>> array_buffers;
+};
+
+// WorkerThread runs a Javascript module in a new isolate, in a thread of its
+// own within the current process.
+//
+// The worker thread has its own TaskQueue, and a small thread pool for the
+// background work of its APIs. Workers get timers, AbortControllers and the
+// File and Codec APIs, but no window.
+//
+// WorkerThreads must be created and deleted in the thread of their parent.
+// Deleting a WorkerThread terminates the Javascript running in the worker and
+// joins its thread.
+//
+// The handlers are called in the worker thread.
+class WorkerThread final : public Js::Delegate {
+ public:
+  using MessageHandler = std::function<void(WorkerMessage message)>;
+  using ExceptionHandler = std::function<void(
+      std::string message, std::vector<std::string> stack_trace)>;
+  using ExitHandler = std::function<void()>;
+
+  // "module" is relative to the current directory, like the initial module.
+  WorkerThread(std::filesystem::path module, MessageHandler on_message,
+               ExceptionHandler on_exception, ExitHandler on_exit);
+  ~WorkerThread() override;
+
+  WorkerThread(const WorkerThread&) = delete;
+  WorkerThread& operator=(const WorkerThread&) = delete;
+
+  // Posts a message to the Worker.parent handle of the worker. Messages
+  // posted before the worker loaded its module are received after that.
+  // Can be called from any thread.
+  void PostMessage(WorkerMessage message);
+
+  // Sends a message to the parent, via the "on_message" handler. Called by
+  // the Worker.parent handle, in the worker thread.
+  void PostMessageToParent(WorkerMessage message);
+
+  // Makes the worker exit once its current task returns, without running the
+  // tasks that are still pending. Must be called in the worker thread.
+  void Close();
+
+  // Makes the worker exit right away, interrupting the Javascript that it's
+  // running. Can be called from any thread.
+  void Terminate();
+
+  void OnMainModuleLoaded() override;
+  void OnJavascriptException(std::string message,
+                             std::vector<std::string> stack_trace) override;
+
+ private:
+  void Run();
+
+  std::filesystem::path module_;
+  MessageHandler on_message_;
+  ExceptionHandler on_exception_;
+  ExitHandler on_exit_;
+
+  // Wakes up the worker thread when tasks are posted to it. Declared before
+  // task_queue_, which notifies it.
+  Signal wake_up_;
+  TaskQueue task_queue_;
+  std::atomic<bool> quit_;
+
+  // Protects isolate_, which is only set while the worker's Js exists.
+  std::mutex lock_;
+  v8::Isolate* isolate_;
+
+  // The Worker.parent handle, and the messages received before the main
+  // module loaded. Only used in the worker thread.
+  WorkerApi* parent_;
+  bool loaded_;
+  std::vector<WorkerMessage> pending_messages_;
+
+  std::thread thread_;
+};
+
+#endif  // WINDOWJS_WORKER_H
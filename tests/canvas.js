@@ -9,6 +9,8 @@
 // that test.
 
 import {
+  assert,
+  assertEquals,
   createCanvas,
   diffCanvasToFile,
   unwrapCanvas,
@@ -135,6 +137,215 @@ export async function drawImageBitmapWithSmoothing() {
   await diffCanvasToFile('data/draw_image_bitmap_smooth.png', 4400);
 }
 
+export async function drawImageInOptimizedCode() {
+  // Optimized code calls the fast version of drawImage(), which falls back to
+  // the slow version to throw for invalid images.
+  const canvas = createCanvas(16, 16);
+  const image = await File.readImageBitmap(__dirname + '/data/image.png');
+  const draw = (source) => canvas.drawImage(source, 0, 0);
+  for (let i = 0; i < 100000; i++) {
+    draw(image);
+  }
+  let threw = false;
+  try {
+    draw({});
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function drawPicture() {
+  if (!globalThis.CanvasPicture) {
+    // Browsers can't record pictures, so canvas.html skips this.
+    return;
+  }
+  const canvas = createCanvas(16, 16);
+  canvas.fillStyle = 'red';
+  canvas.translate(8, 0);
+  canvas.beginRecording(8, 8);
+  // The recording starts without the transform of the canvas.
+  canvas.fillRect(0, 0, 8, 8);
+  const picture = canvas.endRecording();
+  assertEquals(picture.width, 8);
+  assertEquals(picture.height, 8);
+  // Nothing was drawn to the canvas while recording.
+  assertEquals(canvas.getImageData(0, 0, 16, 16).data.indexOf(255), -1);
+
+  canvas.resetTransform();
+  canvas.drawPicture(picture, 8, 8);
+  const data = canvas.getImageData(0, 0, 16, 16).data;
+  for (let y = 0; y < 16; y++) {
+    for (let x = 0; x < 16; x++) {
+      const red = x >= 8 && y >= 8 ? 255 : 0;
+      assertEquals(data[(y * 16 + x) * 4], red);
+    }
+  }
+}
+
+export async function recordingRestoresSavedStates() {
+  if (!globalThis.CanvasPicture) {
+    return;
+  }
+  const canvas = createCanvas(16, 16);
+  canvas.save();
+  canvas.lineWidth = 2;
+  canvas.beginRecording();
+  // Doesn't restore the state saved before the recording.
+  canvas.restore();
+  assertEquals(canvas.lineWidth, 2);
+  canvas.save();
+  canvas.lineWidth = 3;
+  canvas.endRecording();
+  assertEquals(canvas.lineWidth, 2);
+  canvas.restore();
+  assertEquals(canvas.lineWidth, 1);
+
+  let threw = false;
+  try {
+    canvas.endRecording();
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function fillRects() {
+  const canvas = createCanvas(16, 16);
+  if (!canvas.fillRects) {
+    // Browsers don't have the bulk methods, so canvas.html skips this.
+    return;
+  }
+  canvas.fillStyle = 'red';
+  canvas.fillRects(new Float32Array([0, 0, 8, 8, 8, 8, 8, 8]));
+  canvas.fillRects(new Float32Array([8, 0, 8, 8, 0, 8, 8, 8]),
+                   new Uint32Array([0x00ff00ff, 0x0000ff80]));
+  const data = canvas.getImageData(0, 0, 16, 16).data;
+  const pixel = (x, y) => data.slice((y * 16 + x) * 4, (y * 16 + x) * 4 + 4);
+  assertEquals(pixel(2, 2).join(), '255,0,0,255');
+  assertEquals(pixel(12, 12).join(), '255,0,0,255');
+  assertEquals(pixel(12, 2).join(), '0,255,0,255');
+  assertEquals(pixel(2, 12)[2], 255);
+  assertEquals(pixel(2, 12)[3], 128);
+
+  let threw = false;
+  try {
+    canvas.fillRects(new Float32Array(8), new Uint32Array(1));
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function strokeRectsAndFillCircles() {
+  const canvas = createCanvas(32, 32);
+  if (!canvas.fillCircles) {
+    return;
+  }
+  canvas.globalAlpha = 0.5;
+  canvas.fillCircles(new Float32Array([8, 8, 6, 24, 24, 6]),
+                     new Uint32Array([0xff0000ff, 0x0000ffff]));
+  canvas.globalAlpha = 1;
+  canvas.lineWidth = 2;
+  canvas.strokeStyle = 'lime';
+  canvas.strokeRects(new Float32Array([17, 1, 14, 14]));
+  const data = canvas.getImageData(0, 0, 32, 32).data;
+  const pixel = (x, y) => data.slice((y * 32 + x) * 4, (y * 32 + x) * 4 + 4);
+  // The globalAlpha applies to the colors of the circles.
+  assertEquals(pixel(8, 8)[0], 255);
+  assertEquals(pixel(8, 8)[3], 128);
+  assertEquals(pixel(24, 24)[2], 255);
+  assertEquals(pixel(24, 24)[3], 128);
+  assertEquals(pixel(1, 1)[3], 0);
+  assertEquals(pixel(17, 8).join(), '0,255,0,255');
+  assertEquals(pixel(24, 8)[3], 0);
+}
+
+export async function fillRectsMatchesFillRect() {
+  const a = createCanvas(16, 16);
+  if (!a.fillRects) {
+    return;
+  }
+  const b = createCanvas(16, 16);
+  // Edges that aren't on pixel boundaries are antialiased like in fillRect().
+  a.fillRects(new Float32Array([0.5, 0.5, 4, 4, 8.25, 8, 4.5, 4]));
+  b.fillRect(0.5, 0.5, 4, 4);
+  b.fillRect(8.25, 8, 4.5, 4);
+  assertEquals(a.getImageData(0, 0, 16, 16).data.join(),
+               b.getImageData(0, 0, 16, 16).data.join());
+}
+
+export async function fillCirclesLargerThanTheSprite() {
+  const a = createCanvas(400, 400);
+  if (!a.fillCircles) {
+    return;
+  }
+  const b = createCanvas(400, 400);
+  a.fillCircles(new Float32Array([200, 200, 190]));
+  b.beginPath();
+  b.arc(200, 200, 190, 0, 2 * Math.PI);
+  b.fill();
+  // The edge is as sharp as the edge of the path.
+  const edge = (canvas) => canvas.getImageData(0, 200, 400, 1).data;
+  const da = edge(a);
+  const db = edge(b);
+  for (let i = 0; i < da.length; i++) {
+    assert(Math.abs(da[i] - db[i]) <= 16);
+  }
+}
+
+export async function drawAtlas() {
+  const canvas = createCanvas(32, 16);
+  if (!canvas.drawAtlas) {
+    return;
+  }
+  const sheet = createCanvas(16, 8);
+  sheet.fillStyle = 'red';
+  sheet.fillRect(0, 0, 8, 8);
+  sheet.fillStyle = 'white';
+  sheet.fillRect(8, 0, 8, 8);
+
+  // scos, ssin, tx, ty per sprite.
+  const xforms = new Float32Array([1, 0, 0, 0, 2, 0, 16, 0]);
+  const rects = new Float32Array([0, 0, 8, 8, 8, 0, 8, 8]);
+  const colors = new Uint32Array([0xffffffff, 0x0000ffff]);
+  canvas.drawAtlas(sheet, xforms, rects, colors);
+  const data = canvas.getImageData(0, 0, 32, 16).data;
+  const pixel = (x, y) => data.slice((y * 32 + x) * 4, (y * 32 + x) * 4 + 4);
+  assertEquals(pixel(4, 4).join(), '255,0,0,255');
+  assertEquals(pixel(4, 12)[3], 0);
+  // The second sprite is scaled by 2, and tinted blue.
+  assertEquals(pixel(24, 8).join(), '0,0,255,255');
+
+  let threw = false;
+  try {
+    canvas.drawAtlas(sheet, xforms, new Float32Array(4));
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function repeatedStyleAssignments() {
+  const canvas = createCanvas(4, 4);
+  for (let i = 0; i < 3; i++) {
+    canvas.fillStyle = 'red';
+    assertEquals(canvas.fillStyle, '#ff0000');
+    // Invalid colors are ignored, also when they were seen before.
+    canvas.fillStyle = 'not a color';
+    assertEquals(canvas.fillStyle, '#ff0000');
+    // A different string with the same content.
+    canvas.fillStyle = ['#', '00ff00'].join('');
+    assertEquals(canvas.fillStyle, '#00ff00');
+    canvas.shadowColor = 'blue';
+    assertEquals(canvas.shadowColor, '#0000ff');
+    canvas.strokeStyle = i % 2 ? 'white' : 'black';
+    assertEquals(canvas.strokeStyle, i % 2 ? '#ffffff' : '#000000');
+  }
+  canvas.fillRect(0, 0, 4, 4);
+  assertEquals(canvas.getImageData(0, 0, 1, 1).data.join(), '0,255,0,255');
+}
+
 export async function ellipses() {
   const canvas = window.canvas;
 
@@ -176,6 +387,25 @@ export async function fillText() {
   await diffCanvasToFile('data/fill_text.png', 2350);
 }
 
+export async function fillTextWithChangingFonts() {
+  const canvas = createCanvas(32, 32);
+  const draw = (size) => {
+    canvas.clearRect(0, 0, 32, 32);
+    canvas.font = `${size}px monospace`;
+    canvas.fillText('12', 16, 16);
+    return canvas.getImageData(0, 0, 32, 32).data.join();
+  };
+  canvas.fillStyle = 'white';
+  canvas.textAlign = 'center';
+  canvas.textBaseline = 'middle';
+  const large = draw(20);
+  const small = draw(10);
+  assert(large != small);
+  // Drawing the same text and font again gives the same pixels.
+  assertEquals(draw(20), large);
+  assertEquals(draw(10), small);
+}
+
 export async function createPatternRepeat() {
   const canvas = window.canvas;
   const image = await File.readImageBitmap(__dirname + '/data/pattern.png');
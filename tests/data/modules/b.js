@@ -0,0 +1,3 @@
+import {c} from './c/c.js';
+
+export const bc = 'b' + c;
@@ -0,0 +1,4 @@
+import {a} from './a.js';
+import {bc} from './b.js';
+
+export const value = a + bc;
@@ -0,0 +1,28 @@
+function handleParentCommand(event) {
+  switch (event.command) {
+
+  case 'echo':
+    Worker.parent.postMessage({'type' : 'echo', 'payload' : event.payload});
+    break;
+
+  case 'fill-buffer':
+    // Fills the transferred buffer and sends it back without copying it.
+    new Uint8Array(event.buffer).fill(event.value);
+    Worker.parent.postMessage({'buffer' : event.buffer}, [ event.buffer ]);
+    break;
+
+  case 'close':
+    Worker.parent.close();
+    break;
+
+  case 'throw-exception':
+    throw new Error('oh no');
+
+  default:
+    Worker.parent.postMessage({'type' : 'unknown-command'});
+  }
+}
+
+Worker.parent.addEventListener('message', handleParentCommand);
+Worker.parent.postMessage(
+    {'type' : 'ready', 'hasWindow' : typeof window != 'undefined'});
@@ -210,3 +210,45 @@ export async function writeBuffer() {
   assert(view[8] == 0);
   assert(view[9] == 0xff);
 }
+
+export async function manyConcurrentReads() {
+  // More reads than a single batch of background completions.
+  const original = await File.readText(__filename);
+  const reads = [];
+  for (let i = 0; i < 200; i++) {
+    reads.push(File.readText(__filename));
+  }
+  const contents = await Promise.all(reads);
+  assertEquals(contents.length, 200);
+  for (const content of contents) {
+    assertEquals(content, original);
+  }
+}
+
+export async function readTextAborted() {
+  const controller = new AbortController();
+  const promise = File.readText(__filename, {signal: controller.signal});
+  controller.abort();
+  let error = null;
+  try {
+    await promise;
+  } catch (e) {
+    error = e;
+  }
+  assertEquals(error.name, 'AbortError');
+
+  // Signals that were already aborted reject right away.
+  error = null;
+  try {
+    await File.readText(__filename, {signal: controller.signal});
+  } catch (e) {
+    error = e;
+  }
+  assertEquals(error.name, 'AbortError');
+
+  // Completed reads aren't affected by later aborts.
+  const other = new AbortController();
+  const text = await File.readText(__filename, {signal: other.signal});
+  other.abort();
+  assert(text.length > 0);
+}
@@ -29,3 +29,160 @@ export async function clearTimeoutCancels() {
     clearTimeout(id);
   });
 }
+
+export async function setIntervalRepeats() {
+  return new Promise((resolve) => {
+    let count = 0;
+    const id = setInterval(() => {
+      count++;
+      if (count == 3) {
+        clearInterval(id);
+        resolve();
+      }
+    }, 1);
+  });
+}
+
+export async function clearIntervalCancels() {
+  return new Promise((resolve, reject) => {
+    const id = setInterval(reject, 1);
+    setTimeout(resolve, 100);
+    clearInterval(id);
+  });
+}
+
+export async function setTimeoutWakesUpForUpperLevelTimers() {
+  // The first timer is in an upper level of the timing wheel until it's about
+  // to expire, and is due before the second one. The loop must not sleep
+  // until the second one is due.
+  const start = performance.now();
+  const first = new Promise((resolve) => setTimeout(resolve, 128));
+  await new Promise((resolve) => setTimeout(resolve, 100));
+  let secondRan = false;
+  setTimeout(() => secondRan = true, 60);
+  await first;
+  assert(!secondRan);
+  assert(performance.now() - start < 150);
+}
+
+export async function requestIdleCallbackRuns() {
+  const deadline = await new Promise((resolve) => requestIdleCallback(resolve));
+  assertEquals(deadline.didTimeout, false);
+  assert(deadline.timeRemaining() >= 0);
+  assert(deadline.timeRemaining() <= 50);
+}
+
+export async function requestIdleCallbackTimeout() {
+  // Each frame spins past the timeout, so the callback can only run once its
+  // timeout has expired.
+  let busy = true;
+  const spin = () => {
+    const end = performance.now() + 60;
+    while (performance.now() < end) {
+    }
+    if (busy) {
+      requestAnimationFrame(spin);
+    }
+  };
+  const start = performance.now();
+  const deadline = await new Promise((resolve) => {
+    requestAnimationFrame(() => {
+      requestIdleCallback(resolve, {timeout: 50});
+      spin();
+    });
+  });
+  busy = false;
+  assertEquals(deadline.didTimeout, true);
+  assert(deadline.timeRemaining() >= 0);
+  assert(performance.now() - start < 1000);
+}
+
+export async function cancelIdleCallbackCancels() {
+  return new Promise((resolve, reject) => {
+    const id = requestIdleCallback(reject);
+    setTimeout(resolve, 100);
+    cancelIdleCallback(id);
+  });
+}
+
+export async function performanceTasksCountsExecutedTasks() {
+  const before = performance.tasks.executed;
+  await new Promise((resolve) => setTimeout(resolve));
+  assert(performance.tasks.executed > before);
+  assertEquals(typeof(performance.tasks.deferred), 'number');
+  assertEquals(typeof(performance.tasks.framesOverBudget), 'number');
+}
+
+export function performanceCodeCacheCountsLoadedModules() {
+  const codeCache = performance.codeCache;
+  // At least the test runner and this module have been loaded.
+  assert(codeCache.hits + codeCache.misses + codeCache.rejected >= 2);
+}
+
+// Keeps the garbage of performanceGcCountsScavenges reachable for a while, so
+// that the optimizing compiler can't elide its allocations.
+let gcGarbage = null;
+
+export function performanceGcCountsScavenges() {
+  const before = performance.gc.minor.count;
+  // Enough short-lived garbage to fill the young generation a few times.
+  for (let i = 0; i < 200; i++) {
+    gcGarbage = [];
+    for (let j = 0; j < 1000; j++) {
+      gcGarbage.push(new Array(64));
+    }
+  }
+  gcGarbage = null;
+  const minor = performance.gc.minor;
+  assert(minor.count > before);
+  assert(minor.totalPause > 0);
+  assert(minor.maxPause > 0);
+  assert(minor.maxPause <= minor.totalPause);
+  assertEquals(typeof(minor.lastFramePause), 'number');
+  assertEquals(typeof(performance.gc.major.count), 'number');
+}
+
+export async function abortControllerAbortsSignal() {
+  const controller = new AbortController();
+  const signal = controller.signal;
+  assert(!signal.aborted);
+  assertEquals(signal.reason, undefined);
+  let events = 0;
+  signal.addEventListener('abort', () => events++);
+  controller.abort();
+  assert(signal.aborted);
+  assertEquals(signal.reason.name, 'AbortError');
+  controller.abort('again');
+  assertEquals(signal.reason.name, 'AbortError');
+  assertEquals(events, 1);
+  let threw = false;
+  try {
+    signal.throwIfAborted();
+  } catch (e) {
+    threw = e === signal.reason;
+  }
+  assert(threw);
+}
+
+export async function abortSignalAbortWithReason() {
+  const signal = AbortSignal.abort('reason');
+  assert(signal.aborted);
+  assertEquals(signal.reason, 'reason');
+}
+
+export async function importLoadsModuleGraph() {
+  const module = await import('./data/modules/main.js');
+  assertEquals(module.value, 'abc');
+}
+
+export async function lazyGlobalsAreStable() {
+  assert(window === window);
+  assert(window.debug === window.debug);
+  assert(performance === performance);
+  assert(File === File);
+  assert(ImageData === ImageData);
+  const data = new ImageData(1, 1);
+  assert(data instanceof ImageData);
+  const canvas = window.canvas;
+  assert(canvas instanceof CanvasRenderingContext2D);
+}
@@ -48,3 +48,39 @@ export async function minimize() {
   await restoreNotification;
   assert(!window.minimized);
 }
+
+export async function tracingRecordsTasks() {
+  window.debug.startTracing();
+  await new Promise((resolve) => setTimeout(resolve, 1));
+  await File.readText(__filename);
+  const trace = JSON.parse(await window.debug.stopTracing());
+  assert(Array.isArray(trace.traceEvents));
+  const phases = new Set(trace.traceEvents.map((event) => event.ph));
+  assert(phases.has('X'));
+  assert(phases.has('B'));
+  assert(phases.has('E'));
+  const threads = trace.traceEvents.filter((event) => event.ph == 'M')
+                      .map((event) => event.args.name);
+  assert(threads.includes('Main'));
+}
+
+export async function cpuProfileIsWritten() {
+  const path = (await getTmpDir()) + '/window.cpuprofile';
+  window.debug.startProfiling();
+  let sum = 0;
+  for (let i = 0; i < 1000000; i++) {
+    sum += Math.sqrt(i);
+  }
+  assert(sum > 0);
+  await window.debug.stopProfiling(path);
+  const profile = JSON.parse(await File.readText(path));
+  assertEquals(profile.nodes[0].callFrame.functionName, '(root)');
+  assertEquals(profile.samples.length, profile.timeDeltas.length);
+}
+
+export async function heapSnapshotIsWritten() {
+  const path = (await getTmpDir()) + '/window.heapsnapshot';
+  await window.debug.writeHeapSnapshot(path);
+  const snapshot = JSON.parse(await File.readText(path));
+  assert(snapshot.snapshot.node_count > 0);
+}
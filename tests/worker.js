@@ -0,0 +1,128 @@
+// Tests for the Worker API: https://windowjs.org/doc/worker
+
+import {assert, assertEquals} from './lib/lib.js';
+
+function startWorker() {
+  return new Worker(__dirname + '/data/worker.js');
+}
+
+function nextMessage(worker) {
+  return new Promise(function(resolve) {
+    function onMessage(message) {
+      worker.removeEventListener('message', onMessage);
+      resolve(message);
+    }
+    worker.addEventListener('message', onMessage);
+  });
+}
+
+function waitUntilWorkerExit(worker) {
+  return new Promise(function(resolve) {
+    worker.addEventListener('exit', resolve);
+  });
+}
+
+export async function workerReady() {
+  const worker = startWorker();
+  const ready = await nextMessage(worker);
+  assertEquals(ready.type, 'ready');
+  assertEquals(ready.hasWindow, false);
+  worker.close();
+}
+
+export async function workerMessaging() {
+  const worker = startWorker();
+  await nextMessage(worker);
+  const payload = {
+    string : 'hello world',
+    number : 123.456,
+    'null' : null,
+    array : [ 'hello world', 123.456, true ],
+    bytes : new Uint8Array([ 1, 2, 3 ]),
+    map : new Map([ [ 'key', 'value' ] ]),
+  };
+  worker.postMessage({'command' : 'echo', 'payload' : payload});
+  const reply = await nextMessage(worker);
+  assertEquals(reply.type, 'echo');
+  assertEquals(reply.payload.string, 'hello world');
+  assertEquals(reply.payload.number, 123.456);
+  assertEquals(reply.payload['null'], null);
+  assertEquals(reply.payload.array.length, 3);
+  assertEquals(reply.payload.array[2], true);
+  assert(reply.payload.bytes instanceof Uint8Array);
+  assertEquals(reply.payload.bytes[2], 3);
+  assertEquals(reply.payload.map.get('key'), 'value');
+  worker.close();
+}
+
+export async function workerTransfersArrayBuffers() {
+  const worker = startWorker();
+  await nextMessage(worker);
+  const buffer = new ArrayBuffer(1024);
+  worker.postMessage({'command' : 'fill-buffer', 'buffer' : buffer, value : 7},
+                     [ buffer ]);
+  // Transferred buffers are detached in the sender.
+  assertEquals(buffer.byteLength, 0);
+  const reply = await nextMessage(worker);
+  assertEquals(reply.buffer.byteLength, 1024);
+  const bytes = new Uint8Array(reply.buffer);
+  assertEquals(bytes[0], 7);
+  assertEquals(bytes[1023], 7);
+  worker.close();
+}
+
+export async function workerTransferListErrors() {
+  const worker = startWorker();
+  const buffer = new ArrayBuffer(16);
+  let threw = false;
+  try {
+    worker.postMessage({buffer}, [ buffer, buffer ]);
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+  // Failed transfers don't detach the buffers.
+  assertEquals(buffer.byteLength, 16);
+  threw = false;
+  try {
+    worker.postMessage({f : function() {}});
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+  worker.close();
+}
+
+export async function workerClosesItself() {
+  const worker = startWorker();
+  await nextMessage(worker);
+  worker.postMessage({'command' : 'close'});
+  const exit = await waitUntilWorkerExit(worker);
+  assertEquals(exit.type, 'exit');
+  let threw = false;
+  try {
+    worker.postMessage({});
+  } catch (e) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+export async function workerException() {
+  const worker = startWorker();
+  await nextMessage(worker);
+  return new Promise(function(resolve, reject) {
+    worker.addEventListener('exception', function(event) {
+      const expected = 'Uncaught Error: oh no';
+      if (event.message != expected) {
+        reject(`Unexpected exception message: "${event.message}" != "${
+            expected}"`);
+      } else {
+        assert(Array.isArray(event.stacktrace));
+        worker.close();
+        resolve();
+      }
+    });
+    worker.postMessage({'command' : 'throw-exception'});
+  });
+}
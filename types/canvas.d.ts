@@ -293,6 +293,28 @@ declare var CanvasPattern: {
     prototype: CanvasPattern;
 };
 
+/**
+ * A `CanvasPicture` holds a list of drawing operations, recorded with
+ * {@link CanvasRenderingContext2D.beginRecording beginRecording} and
+ * {@link CanvasRenderingContext2D.endRecording endRecording}.
+ *
+ * Pictures are drawn with
+ * {@link CanvasRenderingContext2D.drawPicture drawPicture}, which replays the
+ * recorded operations without calling into Javascript for each of them.
+ * @extension
+ */
+interface CanvasPicture {
+    /** The height of the picture's bounds, in pixels. */
+    readonly height: number;
+
+    /** The width of the picture's bounds, in pixels. */
+    readonly width: number;
+}
+
+declare var CanvasPicture: {
+    prototype: CanvasPicture;
+};
+
 interface CanvasImageData {
     /**
      * Creates a new, blank {@link ImageData} object with the specified
@@ -712,8 +734,79 @@ interface CanvasRenderingContext2D extends CanvasCompositing, CanvasDrawImage, C
      * @extension
      * @param format  The image format to encode in. Valid values: `"png"` (default), `"jpeg"` and `"webp"`.
      * @param quality  The encoding quality for the `"jpeg"` codec.
+     * @param options  An optional `signal` to abort the encoding.
+     */
+    encode(format?: ImageFormat, quality?: number, options?: AbortOptions): Promise<ArrayBuffer>;
+
+    /**
+     * Starts recording the drawing operations of this canvas into a
+     * {@link CanvasPicture}, instead of drawing them. The recording ends with
+     * {@link endRecording}.
+     *
+     * The recording starts with an identity transform and no clip. The other
+     * state, like the {@link CanvasFillStrokeStyles.fillStyle fillStyle}, is
+     * kept.
+     * @extension
+     * @param width  The width of the picture's bounds. Defaults to the width of the canvas.
+     * @param height  The height of the picture's bounds. Defaults to the height of the canvas.
+     */
+    beginRecording(width?: number, height?: number): void;
+
+    /**
+     * Ends the recording started by {@link beginRecording}, and returns the
+     * recorded {@link CanvasPicture}. States saved during the recording without
+     * a matching {@link CanvasState.restore restore} are restored.
+     * @extension
+     */
+    endRecording(): CanvasPicture;
+
+    /**
+     * Draws a {@link CanvasPicture}, with its origin at the given coordinates.
+     * @extension
+     * @param picture  The picture to draw.
+     * @param x  The horizontal coordinate of the picture's origin. Defaults to 0.
+     * @param y  The vertical coordinate of the picture's origin. Defaults to 0.
+     */
+    drawPicture(picture: CanvasPicture, x?: number, y?: number): void;
+
+    /**
+     * Fills many rectangles with a single call. They're drawn as a single
+     * mesh when all their edges fall on pixel boundaries.
+     * @extension
+     * @param xywh  4 numbers per rectangle: the starting point, width and height.
+     * @param colors  The `0xRRGGBBAA` color of each rectangle. Defaults to the {@link CanvasFillStrokeStyles.fillStyle fillStyle}.
+     */
+    fillRects(xywh: Float32Array, colors?: Uint32Array): void;
+
+    /**
+     * Strokes many rectangles with a single call.
+     * @extension
+     * @param xywh  4 numbers per rectangle: the starting point, width and height.
+     * @param colors  The `0xRRGGBBAA` color of each rectangle. Defaults to the {@link CanvasFillStrokeStyles.strokeStyle strokeStyle}.
+     */
+    strokeRects(xywh: Float32Array, colors?: Uint32Array): void;
+
+    /**
+     * Fills many circles with a single draw call.
+     * @extension
+     * @param xyr  3 numbers per circle: the center and the radius.
+     * @param colors  The `0xRRGGBBAA` color of each circle. Defaults to the color of the {@link CanvasFillStrokeStyles.fillStyle fillStyle}.
+     */
+    fillCircles(xyr: Float32Array, colors?: Uint32Array): void;
+
+    /**
+     * Draws many sprites from the same image with a single draw call, e.g.
+     * the tiles of a sprite sheet.
+     *
+     * Uses the current transform, globalAlpha, globalCompositeOperation and
+     * image smoothing, but not the shadow.
+     * @extension
+     * @param image  The image with the sprites.
+     * @param xforms  4 numbers per sprite: the scaled cosine and sine of its rotation, and its position.
+     * @param rects  4 numbers per sprite: the starting point, width and height of the sprite in the image.
+     * @param colors  The `0xRRGGBBAA` color that multiplies each sprite.
      */
-    encode(format?: ImageFormat, quality?: number): Promise<ArrayBuffer>;
+    drawAtlas(image: CanvasImageSource, xforms: Float32Array, rects: Float32Array, colors?: Uint32Array): void;
 }
 
 declare var CanvasRenderingContext2D: {
@@ -1053,9 +1146,10 @@ interface ImageBitmap {
      * representing that encoding.
      * @param codec  The image codec to use for the encoding. Valid values are `"jpeg"`, `"png"` and `"webp"`.
      * @param quality  For the `"jpeg"` codec, the `quality` parameter is a number from 0 to 100 indicating the quality of the output image. 0 is smaller but lower quality, 100 is the highest quality but also a larger encoding.
+     * @param options  An optional `signal` to abort the encoding.
      * @extension
      */
-    encode(codec?: ImageFormat, quality?: number): Promise<ArrayBuffer>;
+    encode(codec?: ImageFormat, quality?: number, options?: AbortOptions): Promise<ArrayBuffer>;
 }
 
 declare var ImageBitmap: {
@@ -1078,9 +1172,10 @@ declare var ImageBitmap: {
      * 
      * The valid input formats are `JPEG`, `PNG` and `WEBP`.
      * @param data 
+     * @param options  An optional `signal` to abort the decoding.
      * @extension
      */
-     decode(data: Uint8Array | Uint8ClampedArray | ArrayBuffer): Promise<ImageBitmap>;
+     decode(data: Uint8Array | Uint8ClampedArray | ArrayBuffer, options?: AbortOptions): Promise<ImageBitmap>;
 };
 
 /**
@@ -1130,9 +1225,10 @@ interface ImageData {
      * representing that encoding.
      * @param codec  The image codec to use for the encoding. Valid values are `"jpeg"`, `"png"` and `"webp"`.
      * @param quality  For the `"jpeg"` codec, the `quality` parameter is a number from 0 to 100 indicating the quality of the output image. 0 is smaller but lower quality, 100 is the highest quality but also a larger encoding.
+     * @param options  An optional `signal` to abort the encoding.
      * @extension
      */
-    encode(codec?: ImageFormat, quality?: number): Promise<ArrayBuffer>;
+    encode(codec?: ImageFormat, quality?: number, options?: AbortOptions): Promise<ArrayBuffer>;
 }
 
 declare var ImageData: {
@@ -1178,9 +1274,10 @@ declare var ImageData: {
      * 
      * The valid input formats are `JPEG`, `PNG` and `WEBP`.
      * @param data 
+     * @param options  An optional `signal` to abort the decoding.
      * @extension
      */
-    decode(data: Uint8Array | Uint8ClampedArray | ArrayBuffer): Promise<ImageData>;
+    decode(data: Uint8Array | Uint8ClampedArray | ArrayBuffer, options?: AbortOptions): Promise<ImageData>;
 };
 
 /** The dimensions of a piece of text in the canvas, as created by the CanvasRenderingContext2D.measureText() method. */
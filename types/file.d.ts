@@ -76,27 +76,27 @@ interface File {
     /**
      * Returns the contents of the given file as an `ArrayBuffer`.
      */
-    readArrayBuffer(path: string): Promise<ArrayBuffer>;
+    readArrayBuffer(path: string, options?: AbortOptions): Promise<ArrayBuffer>;
 
     /**
      * Returns the contents of the given file as an {@link ImageBitmap}.
      */
-    readImageBitmap(path: string): Promise<ImageBitmap>;
+    readImageBitmap(path: string, options?: AbortOptions): Promise<ImageBitmap>;
 
     /**
      * Returns the contents of the given file as an {@link ImageData}.
      */
-    readImageData(path: string): Promise<ImageData>;
+    readImageData(path: string, options?: AbortOptions): Promise<ImageData>;
 
     /**
      * Returns the contents of the given file as a `JSON` object.
      */
-    readJSON(path: string): Promise<Json>;
+    readJSON(path: string, options?: AbortOptions): Promise<Json>;
 
     /**
      * Returns the contents of the given file as a string.
      */
-    readText(path: string): Promise<string>;
+    readText(path: string, options?: AbortOptions): Promise<string>;
 
     /**
      * Removes the given file. See {@link removeTree} for a similar method
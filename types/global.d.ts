@@ -56,6 +56,26 @@ declare const __filename: string;
  */
 declare function cancelAnimationFrame(callback: number): void;
 
+/**
+ * Cancels an idle callback that has been previously scheduled by
+ * {@link requestIdleCallback}.
+ * 
+ * Invalid numbers and numbers assigned to idle callbacks that have already
+ * executed are ignored.
+ * @param handle  A previously assigned callback ID
+ */
+declare function cancelIdleCallback(handle: number): void;
+
+/**
+ * Cancels a repeating callback that has been previously scheduled by
+ * {@link setInterval}.
+ * 
+ * Invalid numbers and numbers assigned to callbacks that have already been
+ * cancelled are ignored.
+ * @param callback  A previously assigned callback ID
+ */
+declare function clearInterval(callback: number): void;
+
 /**
  * Cancels a timeout callbacks that has been previously scheduled by
  * {@link setTimeout}.
@@ -102,6 +122,56 @@ declare function clearTimeout(callback: number): void;
  */
 declare function requestAnimationFrame(callback: Function): number;
 
+/**
+ * The argument passed to {@link requestIdleCallback} callbacks.
+ */
+interface IdleDeadline {
+  /**
+   * `true` if the callback is running because its `timeout` has expired,
+   * rather than during an idle period.
+   */
+  readonly didTimeout: boolean;
+
+  /**
+   * Returns the number of milliseconds left in the current idle period.
+   */
+  timeRemaining(): number;
+}
+
+/**
+ * Options for {@link requestIdleCallback}.
+ */
+interface IdleRequestOptions {
+  /**
+   * If the callback hasn't run after this many milliseconds then it is
+   * executed anyway.
+   */
+  timeout?: number;
+}
+
+/**
+ * Requests a callback to do low priority work when the main thread is idle.
+ * Returns a handle that can be passed to {@link cancelIdleCallback} to cancel
+ * that request.
+ * 
+ * Idle callbacks run after the {@link requestAnimationFrame} callbacks, but
+ * only if there is time left before the next frame has to be rendered. When
+ * the application isn't animating, idle periods last up to 50 milliseconds.
+ * 
+ * Callbacks requested from inside an idle callback run in the next idle
+ * period.
+ */
+declare function requestIdleCallback(
+    callback: (deadline: IdleDeadline) => void,
+    options?: IdleRequestOptions): number;
+
+/**
+ * Registers a callback function to be executed repeatedly, every time the given
+ * number of milliseconds elapses. Returns a handle that can be passed to
+ * {@link clearInterval} to cancel that registration.
+ */
+declare function setInterval(callback: Function, delay: number): number;
+
 /**
  * Registers a callback function to be executed after the given number of
  * milliseconds. Returns a handle that can be passed to
@@ -109,6 +179,62 @@ declare function requestAnimationFrame(callback: Function): number;
  */
 declare function setTimeout(callback: Function, delay: number): number;
 
+/**
+ * A signal that can be passed to APIs that run in the background, like
+ * {@link File.readText} and {@link ImageData.decode}, to abort them. Signals
+ * are created by an {@link AbortController}.
+ *
+ * Aborted background work that hasn't started yet is dropped, and its
+ * `Promise` is rejected immediately with the signal's {@link reason}.
+ */
+interface AbortSignal {
+    /** Whether {@link AbortController.abort} has been called. */
+    readonly aborted: boolean;
+    /**
+     * The reason passed to {@link AbortController.abort}, or an `Error` named
+     * `"AbortError"` if no reason was given.
+     */
+    readonly reason: any;
+    /** Throws the {@link reason} if this signal has been aborted. */
+    throwIfAborted(): void;
+    /** Registers a listener for the `"abort"` event. */
+    addEventListener(type: "abort", listener: () => void): void;
+    /** Removes a listener registered via {@link addEventListener}. */
+    removeEventListener(type: "abort", listener: () => void): void;
+}
+
+declare var AbortSignal: {
+    prototype: AbortSignal;
+    /** Returns a signal that is already aborted with the given reason. */
+    abort(reason?: any): AbortSignal;
+};
+
+/**
+ * Creates an {@link AbortSignal} and aborts it on demand.
+ *
+ * ```js
+ * const controller = new AbortController();
+ * const promise = File.readImageBitmap(path, { signal: controller.signal });
+ * controller.abort();
+ * ```
+ */
+interface AbortController {
+    /** The signal that gets aborted by {@link abort}. */
+    readonly signal: AbortSignal;
+    /** Aborts the {@link signal}. */
+    abort(reason?: any): void;
+}
+
+declare var AbortController: {
+    prototype: AbortController;
+    new(): AbortController;
+};
+
+/** Options for APIs that can be aborted via an {@link AbortSignal}. */
+interface AbortOptions {
+    signal?: AbortSignal;
+}
+
 type Json = string | number | boolean | null | Json[] | { [key: string]: Json } | { toJSON(key: string): Json };
 
 type TypedArray = Int8Array | Uint8Array | Uint8ClampedArray | Int16Array | Uint16Array | Int32Array | Uint32Array | Float32Array | Float64Array | BigInt64Array | BigUint64Array;
@@ -1,9 +1,39 @@
 interface Performance {
 
+    readonly codeCache: {
+        /** The number of Javascript modules that were compiled from the code cache. */
+        readonly hits: number;
+
+        /**
+         * The number of Javascript modules that didn't have a valid entry in the
+         * code cache, and were compiled from source.
+         */
+        readonly misses: number;
+
+        /** The number of code cache entries that failed validation. */
+        readonly rejected: number;
+    };
+
+    /**
+     * Counters of the pauses of the garbage collector, for scavenges of the
+     * young generation (`minor`) and for collections of the old generation
+     * (`major`).
+     */
+    readonly gc: {
+        readonly minor: GcCounters;
+        readonly major: GcCounters;
+    };
+
     readonly memory: {
         /** The maximum size of the heap, in bytes, that is available to the Javascript VM. */
         readonly jsHeapSizeLimit: number;
 
+        /**
+         * The amount of memory, in bytes, that the whole process currently holds
+         * in RAM, including the heaps of its Workers.
+         */
+        readonly residentSetSize: number;
+
         /** The total heap size, in bytes, allocated by the Javascript VM. */
         readonly totalJSHeapSize: number;
 
@@ -11,6 +41,20 @@ interface Performance {
         readonly usedJSHeapSize: number;
     };
 
+    readonly tasks: {
+        /**
+         * The number of tasks that were postponed to a later frame because the
+         * per-frame task budget ran out, summed over all frames.
+         */
+        readonly deferred: number;
+
+        /** The total number of tasks executed by the main thread. */
+        readonly executed: number;
+
+        /** The number of frames that ran out of task budget. */
+        readonly framesOverBudget: number;
+    };
+
     /**
      * Returns the number of milliseconds since the current process started.
      * 
@@ -20,3 +64,17 @@ interface Performance {
      */
     now(): number;
 }
+
+interface GcCounters {
+    /** The number of GC pauses. */
+    readonly count: number;
+
+    /** The sum of all the GC pauses, in milliseconds. */
+    readonly totalPause: number;
+
+    /** The longest GC pause, in milliseconds. */
+    readonly maxPause: number;
+
+    /** The sum of the GC pauses during the last frame, in milliseconds. */
+    readonly lastFramePause: number;
+}
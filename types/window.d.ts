@@ -194,6 +194,46 @@ interface Window {
          * Whether the overlay console is shown automatically whenever an error is logged.
          */
         showOverlayConsoleOnErrors: boolean;
+
+        /**
+         * Starts recording a CPU profile of the Javascript of the main window.
+         * Throws if a profile is already being recorded.
+         * 
+         * Profiling can also be started from startup with the `--cpu-profile`
+         * command line flag.
+         */
+        startProfiling(): void;
+
+        /**
+         * Starts recording a trace of the tasks and frames of the application.
+         * 
+         * Tracing can also be enabled from startup with the `--trace` command
+         * line flag.
+         */
+        startTracing(): void;
+
+        /**
+         * Stops recording the CPU profile started by `startProfiling`, and
+         * writes it to `path` in the `.cpuprofile` format of the Chrome
+         * DevTools. The Promise resolves once the file is written.
+         */
+        stopProfiling(path: string): Promise<void>;
+
+        /**
+         * Stops recording the trace started by `startTracing`, and returns a
+         * Promise that resolves to the trace in the Chrome trace event format.
+         * 
+         * The trace can be opened in `chrome://tracing` or in
+         * [Perfetto](https://ui.perfetto.dev).
+         */
+        stopTracing(): Promise<string>;
+
+        /**
+         * Takes a snapshot of the Javascript heap, and writes it to `path` in
+         * the `.heapsnapshot` format of the Chrome DevTools. The Promise
+         * resolves once the file is written.
+         */
+        writeHeapSnapshot(path: string): Promise<void>;
     };
 
     readonly screen: {
@@ -324,6 +364,11 @@ interface MoveEvent extends MouseEvent {
     readonly offsetX: number;
     /** The y location in the window where the event occurred. */
     readonly offsetY: number;
+    /**
+     * Returns one "mousemove" event for each cursor position that was merged
+     * into this event. The last one has the position of this event.
+     */
+    getCoalescedEvents(): MoveEvent[];
 }
 
 interface DropEvent {
@@ -363,6 +408,11 @@ interface WheelEvent {
     readonly deltaX: number;
     /** The amount that was scrolled in the vertical axis. */
     readonly deltaY: number;
+    /**
+     * Returns one "wheel" event for each wheel event that was merged into this
+     * event. The deltas of this event are the sum of their deltas.
+     */
+    getCoalescedEvents(): WheelEvent[];
 }
 
 interface WindowEventHandlersMap {
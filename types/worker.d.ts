@@ -0,0 +1,94 @@
+/**
+ * The `Worker` API runs a Javascript module in a separate thread of the
+ * current process, with its own Javascript VM.
+ *
+ * Workers start much faster and use less memory than subprocesses created via
+ * {@link Process.spawn}, but have no window: they get timers,
+ * {@link AbortController}, {@link ImageData}, {@link Codec}, {@link File} and
+ * {@link Performance}. Workers can't create other Workers.
+ *
+ * Workers have a handle to their parent in {@link Worker.parent}.
+ *
+ * Messages are sent via {@link Worker.postMessage}, and received as
+ * {@link WorkerEventHandlersMap.message message} events on the worker handle.
+ * Messages can contain any value supported by the structured clone algorithm,
+ * and `ArrayBuffers` in the transfer list are moved to the other thread
+ * without copying their contents.
+ */
+interface Worker {
+
+    /**
+     * `addEventListener` registers a listener callback to receive events in a
+     * given worker handle.
+     *
+     * Workers receive only the {@link WorkerEventHandlersMap.message message}
+     * event in {@link Worker.parent}.
+     *
+     * Parents receive {@link WorkerEventHandlersMap.message message},
+     * {@link WorkerEventHandlersMap.exit exit} and
+     * {@link WorkerEventHandlersMap.exception exception} events from their
+     * workers.
+     *
+     * @param type
+     * @param listener
+     */
+    addEventListener<K extends keyof WorkerEventHandlersMap>(type: K, listener: (event: WorkerEventHandlersMap[K]) => void): void;
+    addEventListener(type: string, listener: () => void): void;
+
+    /**
+     * Terminates the worker. Workers can call `Worker.parent.close()` to exit,
+     * and then their parent receives an
+     * {@link WorkerEventHandlersMap.exit exit} event.
+     */
+    close(): void;
+
+    /**
+     * Sends a message to the other side of this handle.
+     *
+     * @param value  The message to send. It's copied with the structured clone
+     *               algorithm.
+     * @param transfer  Optional list of `ArrayBuffers` in `value` to move to
+     *                  the other thread instead of copying them. They are
+     *                  detached in the current thread.
+     */
+    postMessage(value: any, transfer?: ArrayBuffer[]): void;
+
+    /**
+     * Removes an event listener that has previously been registered via
+     * {@link Worker.addEventListener}.
+     *
+     * @param type
+     * @param listener
+     */
+    removeEventListener(type: string, listener: Function): void;
+}
+
+declare var Worker: {
+
+    /**
+     * Starts a new Worker that loads the given Javascript module.
+     *
+     * @param module  The Javascript module to load in the worker.
+     */
+    new(module: string): Worker;
+
+    /**
+     * A handle to the parent of the current Worker. This is only present in
+     * Workers.
+     */
+    readonly parent?: Worker;
+};
+
+interface WorkerEventHandlersMap {
+    /** Sent to parents when a worker throws an uncaught exception. */
+    "exception": ExceptionEvent;
+
+    /** Sent to parents when a worker closes itself. */
+    "exit": ExitEvent;
+
+    /**
+     * Sent to a worker handle when the other side posts a message via
+     * {@link Worker.postMessage}.
+     */
+    "message": any;
+}